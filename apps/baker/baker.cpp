@@ -28,7 +28,7 @@ int main(int argc, char** argv){
     
 #define SORT_MESH_VERTICES
 #ifdef SORT_MESH_VERTICES
-    mesh = sort(mesh, 1/*Y dimension*/);
+    sort(mesh, 1/*Y dimension*/);
 #endif
     
     /// File open for writing
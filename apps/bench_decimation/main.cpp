@@ -0,0 +1,48 @@
+#include <OpenGP/SurfaceMesh/SurfaceMesh.h>
+#include <OpenGP/SurfaceMesh/decimate.h>
+#include <OpenGP/SurfaceMesh/Subdivision/Loop.h>
+#include <OpenGP/MLogger.h>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+using namespace std;
+using namespace OpenGP;
+
+double seconds_since(chrono::steady_clock::time_point t0){
+    return chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+}
+
+// usage: bench_decimation [mesh.obj] [#loop subdivisions] [kept fraction of the faces]
+int main(int argc, char** argv){
+    string in_file = (argc>1) ? argv[1] : "bunny.obj";
+    int n_subdivisions = (argc>2) ? atoi(argv[2]) : 4;
+    double kept = (argc>3) ? atof(argv[3]) : 0.01;
+
+    SurfaceMesh mesh;
+    bool success = mesh.read(in_file);
+    CHECK(success);
+    mesh.triangulate();
+    for(int i=0; i<n_subdivisions; ++i)
+        SurfaceMeshSubdivideLoop::exec(mesh);
+    const Size n_faces = mesh.n_faces();
+    cout << "#vertices: " << mesh.n_vertices() << " #faces: " << n_faces
+         << " #threads: " << default_n_threads() << endl;
+
+    auto t0 = chrono::steady_clock::now();
+    SurfaceMeshDecimator decimator(mesh);
+    Size n_collapses = decimator.exec(Size(kept * n_faces));
+    double t_decimate = seconds_since(t0);
+
+    t0 = chrono::steady_clock::now();
+    mesh.garbage_collection();
+    double t_gc = seconds_since(t0);
+
+    cout << "#faces: " << n_faces << " -> " << mesh.n_faces() << endl;
+    cout << "collapses: " << n_collapses << " in " << t_decimate << "s ("
+         << n_collapses / t_decimate << " collapses/s, init included)" << endl;
+    cout << "garbage collection: " << t_gc << "s" << endl;
+    cout << "max quadric error: " << decimator.error() << endl;
+
+    return EXIT_SUCCESS;
+}
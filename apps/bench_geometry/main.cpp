@@ -0,0 +1,148 @@
+#include <OpenGP/SurfaceMesh/SurfaceMesh.h>
+#include <OpenGP/SurfaceMesh/geometry.h>
+#include <OpenGP/SurfaceMesh/Subdivision/Loop.h>
+#include <OpenGP/MLogger.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+using namespace std;
+using namespace OpenGP;
+
+typedef SurfaceMesh::Vertex Vertex;
+typedef SurfaceMesh::Halfedge Halfedge;
+typedef SurfaceMesh::Edge Edge;
+typedef SurfaceMesh::Face Face;
+
+/// best of a few runs, in milliseconds
+template <class Function>
+double time_ms(Function fn, int runs=5){
+    double best = numeric_limits<double>::max();
+    for(int r=0; r<runs; ++r){
+        auto t0 = chrono::steady_clock::now();
+        fn();
+        auto t1 = chrono::steady_clock::now();
+        best = min(best, chrono::duration<double, milli>(t1-t0).count());
+    }
+    return best;
+}
+
+/// largest absolute difference between a property and per-handle reference values
+template <class Property, class Range, class Reference>
+Scalar max_error(Property prop, Range range, Reference ref){
+    Scalar err = 0;
+    for(auto x: range)
+        err = max(err, abs(prop[x] - ref[x.idx()]));
+    return err;
+}
+
+void report(const string& name, double per_handle, double batch, double batch_1, Scalar err){
+    cout << name << "\t" << per_handle << "\t" << batch_1 << "\t" << batch << "\t"
+         << per_handle/batch << "x\t(max error " << err << ")" << endl;
+}
+
+//-----------------------------------------------------------------------------
+
+/// mixed Voronoi area of the corner of face(h) at from_vertex(h), one handle at a time
+Scalar corner_area(const SurfaceMesh& mesh, Halfedge h){
+    const Vec3& p = mesh.position(mesh.from_vertex(h));
+    const Vec3& q = mesh.position(mesh.to_vertex(h));
+    const Vec3& r = mesh.position(mesh.to_vertex(mesh.next_halfedge(h)));
+    Scalar area = Scalar(0.5) * (q-p).cross(r-p).norm();
+    if(area <= numeric_limits<Scalar>::min()) return 0;
+    if((q-p).dot(r-p) < 0) return area/2;
+    if((p-q).dot(r-q) < 0 || (p-r).dot(q-r) < 0) return area/4;
+    Scalar cot_q = (p-q).dot(r-q) / (2*area);
+    Scalar cot_r = (p-r).dot(q-r) / (2*area);
+    return ((r-p).squaredNorm()*cot_q + (q-p).squaredNorm()*cot_r) / 8;
+}
+
+// usage: bench_geometry [mesh.obj] [#loop subdivisions]
+int main(int argc, char** argv){
+    string in_file = (argc>1) ? argv[1] : "bunny.obj";
+    int n_subdivisions = (argc>2) ? atoi(argv[2]) : 4;
+
+    SurfaceMesh mesh;
+    bool success = mesh.read(in_file);
+    CHECK(success);
+    mesh.triangulate();
+    for(int i=0; i<n_subdivisions; ++i)
+        SurfaceMeshSubdivideLoop::exec(mesh);
+    cout << "#vertices: " << mesh.n_vertices() << " #faces: " << mesh.n_faces()
+         << " #threads: " << default_n_threads() << endl;
+    cout << "kernel\t\tper-handle\tbatch(1)\tbatch\tspeedup (times in ms)" << endl;
+
+    vector<Scalar> ref;
+    const SurfaceMesh& cmesh = mesh;
+
+    ///--- edge lengths
+    ref.assign(mesh.edges_size(), 0);
+    double t0 = time_ms([&]{ for(Edge e: cmesh.edges()) ref[e.idx()] = cmesh.edge_length(e); });
+    double t1 = time_ms([&]{ SurfaceMeshGeometry::update_edge_lengths(mesh, 1); });
+    double tn = time_ms([&]{ SurfaceMeshGeometry::update_edge_lengths(mesh); });
+    report("e:length", t0, tn, t1, max_error(mesh.edge_property<Scalar>("e:length"), mesh.edges(), ref));
+
+    ///--- face areas
+    ref.assign(mesh.faces_size(), 0);
+    t0 = time_ms([&]{
+        for(Face f: cmesh.faces()){
+            auto vit = cmesh.vertices(f);
+            const Vec3& p0 = cmesh.position(*vit);
+            const Vec3& p1 = cmesh.position(*(++vit));
+            const Vec3& p2 = cmesh.position(*(++vit));
+            ref[f.idx()] = Scalar(0.5) * (p1-p0).cross(p2-p0).norm();
+        }
+    });
+    t1 = time_ms([&]{ SurfaceMeshGeometry::update_face_areas(mesh, 1); });
+    tn = time_ms([&]{ SurfaceMeshGeometry::update_face_areas(mesh); });
+    report("f:area\t", t0, tn, t1, max_error(mesh.face_property<Scalar>("f:area"), mesh.faces(), ref));
+
+    ///--- vertex areas
+    ref.assign(mesh.vertices_size(), 0);
+    t0 = time_ms([&]{
+        for(Vertex v: cmesh.vertices()){
+            Scalar a = 0;
+            for(Halfedge h: cmesh.halfedges(v))
+                if(!cmesh.is_boundary(h)) a += corner_area(cmesh, h);
+            ref[v.idx()] = a;
+        }
+    });
+    t1 = time_ms([&]{ SurfaceMeshGeometry::update_vertex_areas(mesh, 1); });
+    tn = time_ms([&]{ SurfaceMeshGeometry::update_vertex_areas(mesh); });
+    report("v:area\t", t0, tn, t1, max_error(mesh.vertex_property<Scalar>("v:area"), mesh.vertices(), ref));
+
+    ///--- dihedral angles (both include the face normals)
+    ref.assign(mesh.edges_size(), 0);
+    t0 = time_ms([&]{
+        for(Face f: cmesh.faces())
+            mesh.face_property<Vec3>("f:normal")[f] = cmesh.compute_face_normal(f);
+        auto normal = mesh.face_property<Vec3>("f:normal");
+        for(Edge e: cmesh.edges()){
+            if(cmesh.is_boundary(e)) continue;
+            Halfedge h = cmesh.halfedge(e, 0);
+            const Vec3& n0 = normal[cmesh.face(h)];
+            const Vec3& n1 = normal[cmesh.face(cmesh.opposite_halfedge(h))];
+            Vec3 d = cmesh.position(cmesh.to_vertex(h)) - cmesh.position(cmesh.from_vertex(h));
+            Scalar a = acos(min(Scalar(1), max(Scalar(-1), n0.dot(n1))));
+            ref[e.idx()] = (n0.cross(n1).dot(d) >= 0) ? a : -a;
+        }
+    });
+    t1 = time_ms([&]{ SurfaceMeshGeometry::update_dihedral_angles(mesh, 1); });
+    tn = time_ms([&]{ SurfaceMeshGeometry::update_dihedral_angles(mesh); });
+    report("e:dihedral", t0, tn, t1, max_error(mesh.edge_property<Scalar>("e:dihedral"), mesh.edges(), ref));
+
+    ///--- bounding box
+    Box3 box_ref, box;
+    t0 = time_ms([&]{
+        box_ref.setNull();
+        for(Vertex v: cmesh.vertices()) box_ref.extend(cmesh.position(v));
+    });
+    t1 = time_ms([&]{ box = SurfaceMeshGeometry::bounding_box(mesh, 1); });
+    tn = time_ms([&]{ box = SurfaceMeshGeometry::bounding_box(mesh); });
+    report("bbox\t", t0, tn, t1, (box.min()-box_ref.min()).cwiseAbs().maxCoeff()
+                               + (box.max()-box_ref.max()).cwiseAbs().maxCoeff());
+
+    return EXIT_SUCCESS;
+}
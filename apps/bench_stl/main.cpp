@@ -0,0 +1,111 @@
+#include <OpenGP/SurfaceMesh/SurfaceMesh.h>
+#include <OpenGP/SurfaceMesh/IO/IO.h>
+#include <OpenGP/SurfaceMesh/Subdivision/Loop.h>
+#include <OpenGP/MLogger.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <string>
+
+using namespace std;
+using namespace OpenGP;
+
+double seconds_since(chrono::steady_clock::time_point t0){
+    return chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+}
+
+/// writes the triangles of \c mesh as binary STL
+bool write_binary_stl(const SurfaceMesh& mesh, const string& filename){
+    FILE* out = fopen(filename.c_str(), "wb");
+    if(!out) return false;
+    char header[80] = "solid bench_stl"; // binary files starting with "solid" exist, too
+    fwrite(header, 1, 80, out);
+    uint32_t nT = (uint32_t) mesh.n_faces();
+    fwrite(&nT, 4, 1, out);
+    char record[50] = {0};
+    for(SurfaceMesh::Face f: mesh.faces()){
+        float* p = reinterpret_cast<float*>(record + 12);
+        for(SurfaceMesh::Vertex v: mesh.vertices(f)){
+            const Vec3& x = mesh.position(v);
+            *p++ = float(x[0]); *p++ = float(x[1]); *p++ = float(x[2]);
+        }
+        fwrite(record, 1, 50, out);
+    }
+    fclose(out);
+    return true;
+}
+
+/// the previous importer's welding: a tree of the corners (exact comparison)
+size_t weld_with_map(const string& filename){
+    FILE* in = fopen(filename.c_str(), "rb");
+    if(!in) return 0;
+    char header[84];
+    if(fread(header, 1, 84, in) != 84){ fclose(in); return 0; }
+    uint32_t nT;
+    memcpy(&nT, header + 80, 4);
+    auto less = [](const Vec3& a, const Vec3& b){ return lexicographical_compare(a.data(), a.data()+3, b.data(), b.data()+3); };
+    map<Vec3, Index, decltype(less)> vmap(less);
+    char record[50];
+    for(uint32_t t=0; t<nT && fread(record, 1, 50, in) == 50; ++t)
+        for(int k=0; k<3; ++k){
+            float p[3];
+            memcpy(p, record + 12 + 12*k, 12);
+            vmap.insert(make_pair(Vec3(p[0], p[1], p[2]), Index(vmap.size())));
+        }
+    fclose(in);
+    return vmap.size();
+}
+
+// usage: bench_stl [mesh.stl | mesh.obj] [#loop subdivisions of an obj] [weld tolerance]
+// An obj is subdivided (8 subdivisions of the bunny give 10M triangles) and saved as binary STL first.
+int main(int argc, char** argv){
+    string in_file = (argc>1) ? argv[1] : "bunny.obj";
+    int n_subdivisions = (argc>2) ? atoi(argv[2]) : 8;
+    Scalar tolerance = (argc>3) ? Scalar(atof(argv[3])) : Scalar(1e-6);
+
+    string stl_file = in_file;
+    if(in_file.size() < 4 || in_file.substr(in_file.size()-4) != ".stl"){
+        SurfaceMesh mesh;
+        bool success = mesh.read(in_file);
+        CHECK(success);
+        mesh.triangulate();
+        for(int i=0; i<n_subdivisions; ++i)
+            SurfaceMeshSubdivideLoop::exec(mesh);
+        stl_file = "bench_stl.stl";
+        success = write_binary_stl(mesh, stl_file);
+        CHECK(success);
+    }
+
+    FILE* f = fopen(stl_file.c_str(), "rb");
+    CHECK(f != NULL);
+    fseek(f, 0, SEEK_END);
+    const double megabytes = ftell(f) / 1e6;
+    fclose(f);
+    cout << stl_file << ": " << megabytes << " MB, #threads: " << default_n_threads() << endl;
+
+    SurfaceMesh mesh;
+    auto t0 = chrono::steady_clock::now();
+    bool success = read_stl(mesh, stl_file);
+    double t_exact = seconds_since(t0);
+    CHECK(success);
+    cout << "exact welding: " << mesh.n_vertices() << " vertices, " << mesh.n_faces() << " faces in "
+         << t_exact << "s (" << megabytes / t_exact << " MB/s, " << mesh.n_faces() / t_exact << " triangles/s)" << endl;
+
+    t0 = chrono::steady_clock::now();
+    success = read_stl(mesh, stl_file, tolerance);
+    double t_tolerance = seconds_since(t0);
+    CHECK(success);
+    cout << "welding within " << tolerance << ": " << mesh.n_vertices() << " vertices in " << t_tolerance << "s" << endl;
+
+    t0 = chrono::steady_clock::now();
+    size_t n_map = weld_with_map(stl_file);
+    double t_map = seconds_since(t0);
+    cout << "std::map welding (reference, no mesh build): " << n_map << " vertices in " << t_map << "s" << endl;
+
+    return EXIT_SUCCESS;
+}
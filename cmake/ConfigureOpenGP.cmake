@@ -20,3 +20,13 @@ else()
     list(APPEND LIBRARIES OpenGP)    
 endif()
 
+#--- parallel algorithms (e.g. SurfaceMeshNormals) use std::thread
+find_package(Threads REQUIRED)
+list(APPEND LIBRARIES ${CMAKE_THREAD_LIBS_INIT})
+
+#--- 64 bit element indices for meshes with more than 2^31 halfedges
+#    "cmake -DOPENGP_64BIT_INDEX=True" (the whole project must agree on it)
+SET(OPENGP_64BIT_INDEX False CACHE BOOL "Use 64 bit mesh indices?")
+if(OPENGP_64BIT_INDEX)
+    add_definitions(-DOPENGP_INDEX_TYPE=int64_t)
+endif()
@@ -6,6 +6,7 @@
 #include <OpenGP/GL/gl.h>
 #include <OpenGP/GL/gl_types.h>
 #include <OpenGP/util/math_types.h>
+#include <cassert>
 #include <vector>
 
 //=============================================================================
@@ -90,6 +91,13 @@ public:
         glBufferData(TARGET, this->num_elems * sizeof(T), raw_data_ptr, usage);
     }
 
+    /// overwrites elements [first, first+count) of the uploaded data in place
+    void upload_sub_raw(const GLvoid* raw_data_ptr, GLintptr first, GLsizeiptr count){
+        assert(first + count <= this->num_elems);
+        glBindBuffer(TARGET, this->buffer);
+        glBufferSubData(TARGET, first * sizeof(T), count * sizeof(T), raw_data_ptr);
+    }
+
     GLsizeiptr elem_size() const { return sizeof(T); }
     GLenum get_data_type() const { return GLType<Scalar>(); }
     GLuint get_components() const { return ScalarComponents<T>(); }
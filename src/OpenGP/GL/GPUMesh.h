@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <cassert>
 #include <string>
 #include <vector>
 #include <memory>
@@ -72,20 +73,55 @@ public:
             free(uninitialized_data);
         }
 
-        element_count = 0;
-        std::vector<unsigned int> triangles;
-        for(auto f: mesh.faces()) {
-            for(auto v: mesh.vertices(f)) {
-                element_count++;
-                triangles.push_back(v.idx());
+        if (mesh.has_triangle_buffer()) {
+            // the maintained buffer is uploaded as it is
+            const std::vector<unsigned int> &triangles = mesh.triangle_buffer();
+            vao.bind();
+            this->triangles.upload(triangles);
+            vao.unbind();
+            element_count = triangles.size();
+            mesh.clear_triangle_buffer_dirty();
+        } else {
+            element_count = 0;
+            std::vector<unsigned int> triangles;
+            for(auto f: mesh.faces()) {
+                for(auto v: mesh.vertices(f)) {
+                    element_count++;
+                    triangles.push_back(v.idx());
+                }
             }
+
+            vao.bind();
+            this->triangles.upload(triangles);
+            vao.unbind();
         }
 
+        mode = GL_TRIANGLES;
+
+    }
+
+    /// Brings the uploaded triangles up to date with the triangle buffer of
+    /// \c mesh (see SurfaceMesh::enable_triangle_buffer): only the face ranges
+    /// that changed since the last upload are sent, unless the number of faces
+    /// changed. The vertex attributes are not touched.
+    void update_triangles(const SurfaceMesh &mesh) {
+
+        assert(mesh.has_triangle_buffer());
+        const std::vector<unsigned int> &triangles = mesh.triangle_buffer();
+
         vao.bind();
-        this->triangles.upload(triangles);
+        if ((GLsizeiptr)triangles.size() != this->triangles.size()) {
+            this->triangles.upload(triangles);
+        } else {
+            for (auto range : mesh.triangle_buffer_dirty_ranges()) {
+                this->triangles.upload_sub_raw(&triangles[3 * range.first], 3 * range.first,
+                                               3 * (range.second - range.first));
+            }
+        }
         vao.unbind();
 
-        mode = GL_TRIANGLES;
+        element_count = triangles.size();
+        mesh.clear_triangle_buffer_dirty();
 
     }
 
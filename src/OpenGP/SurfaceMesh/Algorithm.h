@@ -12,6 +12,7 @@
 
 #pragma once
 #include <OpenGP/SurfaceMesh/SurfaceMesh.h>
+#include <OpenGP/SurfaceMesh/parallel.h>
 
 //=============================================================================
 namespace OpenGP {
@@ -25,7 +25,19 @@ typedef Eigen::Map<VerticesMatrix> VerticesMatrixMap;
 typedef Eigen::Matrix<Scalar, 3, Eigen::Dynamic> NormalsMatrix;
 typedef Eigen::Map<NormalsMatrix> NormalsMatrixMap;
 
-typedef Eigen::Matrix<int, 3, Eigen::Dynamic> TrianglesMatrix;
+typedef Eigen::Matrix<Index, 3, Eigen::Dynamic> TrianglesMatrix;
+typedef Eigen::Map<const Eigen::Matrix<uint32_t, 3, Eigen::Dynamic>> TrianglesMatrixMap;
+
+/// zero-copy view of the triangle buffer of the mesh (enabled on first use),
+/// e.g. to build an AABBSearcher
+inline TrianglesMatrixMap triangles_matrix(SurfaceMesh& mesh){
+    /// deleted faces would show up as (0,0,0) triangles
+    assert(mesh.n_faces() == mesh.faces_size());
+    if(!mesh.has_triangle_buffer())
+        mesh.enable_triangle_buffer();
+    const std::vector<uint32_t>& triangles = mesh.triangle_buffer();
+    return TrianglesMatrixMap(triangles.empty() ? NULL : triangles.data(), 3, mesh.faces_size());
+}
 
 inline TrianglesMatrix faces_matrix(SurfaceMesh& mesh){
     /// TODO check there is no garbage
@@ -34,6 +46,10 @@ inline TrianglesMatrix faces_matrix(SurfaceMesh& mesh){
     /// mesh must be a triangulation
     assert(mesh.is_triangle_mesh());
 
+    /// the maintained buffer is already laid out column by column
+    if(mesh.has_triangle_buffer() && mesh.n_faces() == mesh.faces_size())
+        return triangles_matrix(mesh).cast<Index>();
+
     TrianglesMatrix faces;
     faces.resize(3,mesh.n_faces());
     for(SurfaceMesh::Face f: mesh.faces()){
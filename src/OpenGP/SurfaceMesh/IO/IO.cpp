@@ -54,6 +54,14 @@ bool read_mesh(SurfaceMesh& mesh, const std::string& filename)
     {
         return read_stl(mesh, filename);
     }
+    else if (ext == "ply")
+    {
+        return read_ply(mesh, filename);
+    }
+    else if (ext == "ogp")
+    {
+        return read_ogp(mesh, filename);
+    }
 
     // we didn't find a reader module
     return false;
@@ -81,6 +89,14 @@ bool write_mesh(const SurfaceMesh& mesh, const std::string& filename)
     {
         return write_obj(mesh, filename);
     }
+    else if (ext == "ply")
+    {
+        return write_ply(mesh, filename);
+    }
+    else if (ext == "ogp")
+    {
+        return write_ogp(mesh, filename);
+    }
 
     // we didn't find a writer module
     return false;
@@ -21,10 +21,14 @@ namespace OpenGP {
 HEADERONLY_INLINE bool read_mesh(SurfaceMesh& mesh, const std::string& filename);
 HEADERONLY_INLINE bool read_off(SurfaceMesh& mesh, const std::string& filename);
 HEADERONLY_INLINE bool read_obj(SurfaceMesh& mesh, const std::string& filename);
-HEADERONLY_INLINE bool read_stl(SurfaceMesh& mesh, const std::string& filename);
+HEADERONLY_INLINE bool read_stl(SurfaceMesh& mesh, const std::string& filename, Scalar weld_tolerance=0);
+HEADERONLY_INLINE bool read_ply(SurfaceMesh& mesh, const std::string& filename);
+HEADERONLY_INLINE bool read_ogp(SurfaceMesh& mesh, const std::string& filename, Mapped_image_resource* resource=NULL);
 HEADERONLY_INLINE bool write_mesh(const SurfaceMesh& mesh, const std::string& filename);
 HEADERONLY_INLINE bool write_off(const SurfaceMesh& mesh, const std::string& filename);
 HEADERONLY_INLINE bool write_obj(const SurfaceMesh& mesh, const std::string& filename);
+HEADERONLY_INLINE bool write_ply(const SurfaceMesh& mesh, const std::string& filename, bool binary=true);
+HEADERONLY_INLINE bool write_ogp(const SurfaceMesh& mesh, const std::string& filename);
 
 /// Private helper function
 template <typename T> void read(FILE* in, T& t)
@@ -42,6 +46,8 @@ template <typename T> void read(FILE* in, T& t)
     #include "IO.cpp"
     #include "IO_obj.cpp"
     #include "IO_off.cpp"
+    #include "IO_ogp.cpp"
+    #include "IO_ply.cpp"
     #include "IO_poly.cpp"
     #include "IO_stl.cpp"
 #endif
@@ -14,171 +14,206 @@
 
 #include <OpenGP/SurfaceMesh/SurfaceMesh.h>
 #include <OpenGP/SurfaceMesh/IO/IO.h>
+#include <OpenGP/util/mapped_file.h>
+#include <OpenGP/util/number_parser.h>
+#include <OpenGP/util/parallel.h>
 #include <cstdio>
+#include <iostream>
 
 //=============================================================================
 namespace OpenGP {
 //=============================================================================
 
-bool read_obj(SurfaceMesh& mesh, const std::string& filename) {
-    char s[200];
-    float  x, y, z;
-    std::vector<SurfaceMesh::Vertex>  vertices;
-    std::vector<Vec3> all_tex_coords;   //individual texture coordinates
-    std::vector<int> halfedge_tex_idx; //texture coordinates sorted for halfedges
-    SurfaceMesh::Halfedge_property <Vec3> tex_coords = mesh.halfedge_property<Vec3>("h:texcoord");
-    bool with_tex_coord=false;
-
-    // clear mesh
-    mesh.clear();
-
-    // open file (in ASCII mode)
-    FILE* in = fopen(filename.c_str(), "r");
-    if (!in) return false;
-
-    // clear line once
-    memset(&s, 0, 200);
-
-    // pre-parse to find out the number of vertices
-    {
-        uint vnormal_counter = 0; // number of vertex normals parsed
-        while (in && !feof(in) && fgets(s, 200, in)) {
-            if (s[0] == '#' || isspace(s[0])) continue; // comment
-            else if (strncmp(s, "v ", 2) == 0) { if (sscanf(s, "v %f %f %f", &x, &y, &z)) mesh.add_vertex(Vec3(0,0,0)); }
-            else if (strncmp(s, "vn ", 3) == 0) { if (sscanf(s, "vn %f %f %f", &x, &y, &z)) vnormal_counter++; }
-            else continue;
-        }
-
-        // If we have read any vertex normals, it must match the number of vertices
-        // and in this case allocate memory for normals
-        if (vnormal_counter!=0){
-            assert(vnormal_counter==mesh.n_vertices());
-            mesh.add_vertex_property<Vec3>("v:normal");
-        }
-
-        // Start from the beginning again
-        in = freopen(filename.c_str(),"r",in);
-    }
+namespace internal {
+
+/// what a worker thread parsed from its part of an OBJ file
+struct Obj_chunk{
+    std::vector<Vec3> points, normals, texcoords;
+    std::vector<unsigned int> face_sizes;
+    std::vector<long long> vindices; ///< 0-based, see vrelative
+    std::vector<long long> tindices; ///< -1 for corners without texture coordinate
+    /// indices given relative to the current count ("f -1 -2 -3"): they are
+    /// stored relative to the start of the chunk, the offset is added later
+    std::vector<size_t> vrelative, trelative;
+    bool zero_index = false;   ///< a face used the invalid vertex index 0
+    bool short_vertex = false; ///< a "v" line had less than 3 coordinates
+};
+
+inline bool obj_is_blank(const char* p, const char* end){
+    return p == end || *p == ' ' || *p == '\t';
+}
 
-    // parse line by line (currently only supports vertex positions & faces
-    uint vpoint_counter = 0;  //< number of vertex positions parsed
-    uint vnormal_counter = 0; //< number of vertex normals parsed
-    auto vpoints = mesh.get_vertex_property<Vec3>("v:point");
-    auto vnormals = mesh.get_vertex_property<Vec3>("v:normal");
-    while (in && !feof(in) && fgets(s, 200, in)) {
-        // comment
-        if (s[0] == '#' || isspace(s[0])) continue;
-
-        // vertex
-        else if (strncmp(s, "v ", 2) == 0) {
-            if (sscanf(s, "v %f %f %f", &x, &y, &z)) {
-                vpoints[ SurfaceMesh::Vertex(vpoint_counter++) ] = Vec3(x,y,z);
-                // mesh.add_vertex(Vec3(x,y,z));
-            }
+/// parses the lines of [begin,end), which starts at a line start
+inline void read_obj_chunk(const char* begin, const char* end, Obj_chunk& chunk){
+    for(const char* p = begin; p < end; p = next_line(p, end)){
+        const char* q = p;
+        skip_blanks(q, end);
+        if(q == end) break;
+
+        if(q[0] == 'v'){
+            std::vector<Vec3>* target = NULL;
+            if(obj_is_blank(q+1, end)){ target = &chunk.points; q += 1; }
+            else if(q[1] == 'n' && obj_is_blank(q+2, end)){ target = &chunk.normals; q += 2; }
+            else if(q[1] == 't' && obj_is_blank(q+2, end)){ target = &chunk.texcoords; q += 2; }
+            if(!target) continue;
+
+            Vec3 x(0, 0, 1); // texture coordinates may have two
+            int n = 0;
+            while(n < 3 && parse_float(q, end, x[n])) ++n;
+            if(n == 3 || (n == 2 && target == &chunk.texcoords)) target->push_back(x);
+            else if(target == &chunk.points) chunk.short_vertex = true; // dropping it would renumber the rest
         }
-        // normal
-        else if (strncmp(s, "vn ", 3) == 0) {
-            int n_read = sscanf(s, "vn %f %f %f", &x, &y, &z);
-            assert((n_read==0) || (n_read==3));
-            if (n_read) {
-                // note: problematic as it can be either a vertex property when interpolated or a halfedge property for hard edges
-                assert(vnormal_counter<mesh.n_vertices());
-                vnormals[ SurfaceMesh::Vertex(vnormal_counter) ] = Vec3(x,y,z);
-                vnormal_counter++;
+        else if(q[0] == 'f' && obj_is_blank(q+1, end)){
+            ++q;
+            unsigned int n = 0;
+            long long i, t;
+            while(parse_integer(q, end, i)){
+                // v, v/vt, v//vn or v/vt/vn
+                t = 0;
+                if(q < end && *q == '/'){
+                    ++q;
+                    if(q < end && *q != '/') parse_integer(q, end, t);
+                    if(q < end && *q == '/'){ ++q; long long vn; parse_integer(q, end, vn); }
+                }
+                if(i == 0) chunk.zero_index = true;
+                if(i < 0) chunk.vrelative.push_back(chunk.vindices.size());
+                chunk.vindices.push_back(i > 0 ? i-1 : (long long) chunk.points.size() + i);
+                if(t < 0) chunk.trelative.push_back(chunk.tindices.size());
+                chunk.tindices.push_back(t > 0 ? t-1 : (t < 0 ? (long long) chunk.texcoords.size() + t : -1));
+                ++n;
             }
-        }
-
-        // texture coordinate
-        else if (strncmp(s, "vt ", 3) == 0) {
-            if (sscanf(s, "vt %f %f", &x, &y)) {
-                z=1;
-                all_tex_coords.push_back(Vec3(x,y,z));
+            if(n >= 3){
+                chunk.face_sizes.push_back(n);
+            } else { // not a face, drop its corners
+                chunk.vindices.resize(chunk.vindices.size() - n);
+                chunk.tindices.resize(chunk.tindices.size() - n);
+                while(!chunk.vrelative.empty() && chunk.vrelative.back() >= chunk.vindices.size()) chunk.vrelative.pop_back();
+                while(!chunk.trelative.empty() && chunk.trelative.back() >= chunk.tindices.size()) chunk.trelative.pop_back();
             }
         }
+    }
+}
 
-        // face
-        else if (strncmp(s, "f ", 2) == 0) {
-            int component(0), nV(0);
-            bool endOfVertex(false);
-            char* p0, *p1(s+1);
-
-            vertices.clear();
-            halfedge_tex_idx.clear();
-
-            // skip white-spaces
-            while (*p1==' ') ++p1;
+} // namespace internal
 
-            while (p1) {
-                p0 = p1;
+/// The file is memory mapped and cut into line aligned chunks that the
+/// threads of the pool parse concurrently (parse_float, no sscanf, no line
+/// length limit). The chunks are then stitched into one index buffer for
+/// SurfaceMesh::build_from_indices(). Supports v, vn (one per vertex, as
+/// "v:normal"), vt (as "h:texcoord" of the halfedges pointing to the corner)
+/// and f with positive or relative indices; other statements are skipped.
+/// v needs 3 coordinates (the read fails otherwise), vn lines with less are
+/// skipped, vt may have 2.
+bool read_obj(SurfaceMesh& mesh, const std::string& filename) {
+    typedef SurfaceMesh::Face Face;
+    typedef SurfaceMesh::Halfedge Halfedge;
 
-                // overwrite next separator
+    // clear mesh
+    mesh.clear();
 
-                // skip '/', '\n', ' ', '\0', '\r' <-- don't forget Windows
-                while (*p1!='/' && *p1!='\r' && *p1!='\n' && *p1!=' ' && *p1!='\0') ++p1;
+    Mapped_file file;
+    if (!file.open(filename)) return false;
+
+    ///--- parse the chunks concurrently
+    const size_t min_chunk = size_t(1) << 20;
+    const size_t n_chunks = std::max<size_t>(1, std::min<size_t>(4 * default_n_threads(), file.size() / min_chunk));
+    std::vector<const char*> bounds(n_chunks+1, file.end());
+    bounds[0] = file.data();
+    for (size_t c=1; c<n_chunks; ++c)
+        bounds[c] = std::max(bounds[c-1], next_line(file.data() + c * (file.size() / n_chunks) - 1, file.end()));
+
+    std::vector<internal::Obj_chunk> chunks(n_chunks);
+    parallel_for_tasks(int(n_chunks), [&](int c) {
+        internal::read_obj_chunk(bounds[c], bounds[c+1], chunks[c]);
+    });
+    for (size_t c=0; c<n_chunks; ++c) {
+        if (chunks[c].zero_index) {
+            std::cerr << "[read_obj] " << filename << " has a face with vertex index 0 (indices start at 1)\n";
+            return false;
+        }
+        if (chunks[c].short_vertex) {
+            std::cerr << "[read_obj] " << filename << " has a vertex with less than 3 coordinates\n";
+            return false;
+        }
+    }
 
-                // detect end of vertex
-                if (*p1 != '/') {
-                    endOfVertex = true;
-                }
+    ///--- where each chunk goes in the stitched arrays
+    std::vector<size_t> voffset(n_chunks+1, 0), noffset(n_chunks+1, 0), toffset(n_chunks+1, 0);
+    std::vector<size_t> foffset(n_chunks+1, 0), coffset(n_chunks+1, 0);
+    for (size_t c=0; c<n_chunks; ++c) {
+        voffset[c+1] = voffset[c] + chunks[c].points.size();
+        noffset[c+1] = noffset[c] + chunks[c].normals.size();
+        toffset[c+1] = toffset[c] + chunks[c].texcoords.size();
+        foffset[c+1] = foffset[c] + chunks[c].face_sizes.size();
+        coffset[c+1] = coffset[c] + chunks[c].vindices.size();
+    }
+    const size_t nV = voffset[n_chunks], nT = toffset[n_chunks], nC = coffset[n_chunks];
 
-                // replace separator by '\0'
-                if (*p1 != '\0') {
-                    *p1 = '\0';
-                    p1++; // point to next token
-                }
+    std::vector<Vec3> points(nV), normals(noffset[n_chunks]), texcoords(nT);
+    std::vector<unsigned int> face_sizes(foffset[n_chunks]);
+    std::vector<Size> indices(nC);
+    std::vector<long long> tindices(nC);
+    bool with_tex_coord = false;
+    parallel_for_tasks(int(n_chunks), [&](int c) {
+        internal::Obj_chunk& chunk = chunks[c];
+        std::copy(chunk.points.begin(), chunk.points.end(), points.begin() + voffset[c]);
+        std::copy(chunk.normals.begin(), chunk.normals.end(), normals.begin() + noffset[c]);
+        std::copy(chunk.texcoords.begin(), chunk.texcoords.end(), texcoords.begin() + toffset[c]);
+        std::copy(chunk.face_sizes.begin(), chunk.face_sizes.end(), face_sizes.begin() + foffset[c]);
+        for (size_t k : chunk.vrelative) chunk.vindices[k] += voffset[c];
+        for (size_t k : chunk.trelative) chunk.tindices[k] += toffset[c];
+        for (size_t k=0; k<chunk.vindices.size(); ++k) {
+            // out of range (or negative) indices make build_from_indices fail
+            indices[coffset[c]+k] = (Size) chunk.vindices[k];
+            tindices[coffset[c]+k] = chunk.tindices[k];
+        }
+        std::vector<Vec3>().swap(chunk.points);
+        std::vector<long long>().swap(chunk.vindices);
+    });
+    for (size_t c=0; c<n_chunks && !with_tex_coord; ++c)
+        for (long long t : chunks[c].tindices)
+            if (t >= 0) { with_tex_coord = true; break; }
+    chunks.clear();
+
+    ///--- build the mesh at once
+    std::vector<Index> rejected;
+    if (!mesh.build_from_indices(points, face_sizes, indices, &rejected))
+        return false;
 
-                // detect end of line and break
-                if (*p1 == '\0' || *p1 == '\n') {
-                    p1 = 0;
-                }
+    // vertex normals, if there is one per vertex
+    if (!normals.empty()) {
+        if (normals.size() == nV)
+            mesh.vertex_property<Vec3>("v:normal").vector().assign(normals.begin(), normals.end());
+        else
+            std::cerr << "[read_obj] " << normals.size() << " normals for " << nV << " vertices, ignored\n";
+    }
 
-                // read next vertex component
-                if (*p0 != '\0') {
-                    switch (component) {
-                        case 0: { // vertex
-                            vertices.push_back( SurfaceMesh::Vertex(atoi(p0) - 1) );
-                            break;
-                        }
-                        case 1: { // texture coord
-                            int idx = atoi(p0)-1;
-                            halfedge_tex_idx.push_back(idx);
-                            with_tex_coord=true;
+    // texture coordinates: corner k of input face f goes to the halfedge of mesh face f' pointing to it
+    if (with_tex_coord) {
+        SurfaceMesh::Halfedge_property<Vec3> tex_coords = mesh.halfedge_property<Vec3>("h:texcoord");
+        const Index nF = face_sizes.size();
+        std::vector<Index> face(nF), corner(nF+1, 0);
+        for (Index f=0, r=0, k=0; f<nF; ++f) {
+            corner[f+1] = corner[f] + face_sizes[f];
+            if (r < (Index) rejected.size() && rejected[r] == f) { face[f] = -1; ++r; }
+            else face[f] = k++;
+        }
+        const SurfaceMesh& cmesh = mesh;
+        parallel_for_chunks(0, nF, [&](Index begin, Index end) {
+            for (Index f=begin; f<end; ++f) {
+                if (face[f] < 0) continue;
+                for (Halfedge h : cmesh.halfedges(Face(face[f]))) {
+                    const Size v = cmesh.to_vertex(h).idx();
+                    for (Index c=corner[f]; c<corner[f+1]; ++c)
+                        if (indices[c] == v) {
+                            if (tindices[c] >= 0 && tindices[c] < (long long) nT) tex_coords[h] = texcoords[tindices[c]];
                             break;
                         }
-                        case 2: // normal
-                            break;
-                    }
-                }
-
-                ++component;
-
-                if (endOfVertex) {
-                    component = 0;
-                    nV++;
-                    endOfVertex = false;
                 }
             }
-
-            SurfaceMesh::Face f=mesh.add_face(vertices);
-
-
-            // add texture coordinates
-            if (with_tex_coord) {
-                SurfaceMesh::Halfedge_around_face_circulator h_fit = mesh.halfedges(f);
-                SurfaceMesh::Halfedge_around_face_circulator h_end = h_fit;
-                unsigned v_idx =0;
-                do {
-                    tex_coords[*h_fit]=all_tex_coords.at(halfedge_tex_idx.at(v_idx));
-                    ++v_idx;
-                    ++h_fit;
-                } while (h_fit!=h_end);
-            }
-        }
-        // clear line
-        memset(&s, 0, 200);
+        });
     }
 
-    fclose(in);
     return true;
 }
 
@@ -197,14 +232,14 @@ bool write_obj(const SurfaceMesh& mesh, const std::string& filename) {
     fprintf(out, "# OBJ export from SurfaceMesh\n");
 
     //vertices
-    SurfaceMesh::Vertex_property<Vec3> points = mesh.get_vertex_property<Vec3>("v:point");
+    const SurfaceMesh::Vertex_property<Vec3> points = mesh.get_vertex_property<Vec3>("v:point");
     for (SurfaceMesh::Vertex_iterator vit=mesh.vertices_begin(); vit!=mesh.vertices_end(); ++vit) {
         const Vec3& p = points[*vit];
         fprintf(out, "v %.10f %.10f %.10f\n", p[0], p[1], p[2]);
     }
 
     //normals
-    SurfaceMesh::Vertex_property<Vec3> normals = mesh.get_vertex_property<Vec3>("v:normal");
+    const SurfaceMesh::Vertex_property<Vec3> normals = mesh.get_vertex_property<Vec3>("v:normal");
     if (normals) {
         for (SurfaceMesh::Vertex_iterator vit=mesh.vertices_begin(); vit!=mesh.vertices_end(); ++vit) {
             const Vec3& p = normals[*vit];
@@ -227,7 +262,7 @@ bool write_obj(const SurfaceMesh& mesh, const std::string& filename) {
 
     //if so then add
     if (with_tex_coord) {
-        SurfaceMesh::Halfedge_property<TextureCoordinate> tex_coord = mesh.get_halfedge_property<TextureCoordinate>("h:texcoord");
+        const SurfaceMesh::Halfedge_property<TextureCoordinate> tex_coord = mesh.get_halfedge_property<TextureCoordinate>("h:texcoord");
         for (SurfaceMesh::Halfedge_iterator hit=mesh.halfedges_begin(); hit!=mesh.halfedges_end(); ++hit) {
             const TextureCoordinate& pt = tex_coord[*hit];
             fprintf(out, "vt %.10f %.10f %.10f\n", pt[0], pt[1], pt[2]);
@@ -242,11 +277,11 @@ bool write_obj(const SurfaceMesh& mesh, const std::string& filename) {
         do {
             if (with_tex_coord) {
                 // write vertex index, tex_coord index and normal index
-                fprintf(out, " %d/%d/%d", (*fvit).idx()+1, (*fhit).idx()+1, (*fvit).idx()+1);
+                fprintf(out, " %lld/%lld/%lld", (long long) (*fvit).idx()+1, (long long) (*fhit).idx()+1, (long long) (*fvit).idx()+1);
                 ++fhit;
             } else {
                 // write vertex index and normal index
-                fprintf(out, " %d//%d", (*fvit).idx()+1, (*fvit).idx()+1);
+                fprintf(out, " %lld//%lld", (long long) (*fvit).idx()+1, (long long) (*fvit).idx()+1);
             }
         } while (++fvit != fvend);
         fprintf(out, "\n");
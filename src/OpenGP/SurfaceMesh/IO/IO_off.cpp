@@ -30,24 +30,23 @@ inline bool read_off_ascii(SurfaceMesh& mesh,
 
     char                 line[200], *lp;
     int                  nc;
-    unsigned int         i, j, items, idx;
-    unsigned int         nV, nF, nE;
+    unsigned int         j, items, valence;
+    long long            nv(0), nf(0), ne(0), idx;
+    Size                 i, nV, nF;
     Vec3                 p, n, c;
     Vec2                 t;
-    SurfaceMesh::Vertex v;
 
-    // properties
-    SurfaceMesh::Vertex_property<Normal>              normals;
-    SurfaceMesh::Vertex_property<TextureCoordinate>  texcoords;
-    SurfaceMesh::Vertex_property<Color>               colors;
-    if (has_normals)   normals   = mesh.vertex_property<Normal>("v:normal");
-    if (has_texcoords) texcoords = mesh.vertex_property<TextureCoordinate>("v:texcoord");
-    if (has_colors)    colors    = mesh.vertex_property<Color>("v:color");
+    // #Vertice, #Faces, #Edges (64 bit, the counts are only narrowed to Size)
+    items = fscanf(in, "%lld %lld %lld\n", &nv, &nf, &ne);
+    nV = (Size) nv;
+    nF = (Size) nf;
 
-    // #Vertice, #Faces, #Edges
-    items = fscanf(in, "%d %d %d\n", (int*)&nV, (int*)&nF, (int*)&nE);
-    mesh.clear();
-    mesh.reserve(nV, std::max(3*nV, nE), nF);
+    // vertex data is gathered first, the mesh is built at once at the end
+    std::vector<Vec3> points, normals, colors, texcoords;
+    points.reserve(nV);
+    if (has_normals)   normals.resize(nV, Vec3(0,0,0));
+    if (has_colors)    colors.resize(nV, Vec3(0,0,0));
+    if (has_texcoords) texcoords.resize(nV, Vec3(0,0,0));
 
 
     // read vertices: pos [normal] [color] [texcoord]
@@ -60,7 +59,7 @@ inline bool read_off_ascii(SurfaceMesh& mesh,
         // position
         items = sscanf(lp, "%f %f %f%n", &p[0], &p[1], &p[2], &nc);
         assert(items==3);
-        v = mesh.add_vertex((Vec3)p);
+        points.push_back(p);
         lp += nc;
 
         // normal
@@ -68,7 +67,7 @@ inline bool read_off_ascii(SurfaceMesh& mesh,
         {
             if (sscanf(lp, "%f %f %f%n", &n[0], &n[1], &n[2], &nc) == 3)
             {
-                normals[v] = n;
+                normals[i] = n;
             }
             lp += nc;
         }
@@ -79,7 +78,7 @@ inline bool read_off_ascii(SurfaceMesh& mesh,
             if (sscanf(lp, "%f %f %f%n", &c[0], &c[1], &c[2], &nc) == 3)
             {
                 if (c[0]>1.0f || c[1]>1.0f || c[2]>1.0f) c *= (1.0/255.0);
-                colors[v] = c;
+                colors[i] = c;
             }
             lp += nc;
         }
@@ -89,8 +88,8 @@ inline bool read_off_ascii(SurfaceMesh& mesh,
         {
             items = sscanf(lp, "%f %f%n", &t[0], &t[1], &nc);
             assert(items == 2);
-            texcoords[v][0] = t[0];
-            texcoords[v][1] = t[1];
+            texcoords[i][0] = t[0];
+            texcoords[i][1] = t[1];
             lp += nc;
         }
     }
@@ -98,7 +97,10 @@ inline bool read_off_ascii(SurfaceMesh& mesh,
 
 
     // read faces: #N v[1] v[2] ... v[n-1]
-    std::vector<SurfaceMesh::Vertex> vertices;
+    std::vector<unsigned int> face_sizes;
+    std::vector<Size> indices;
+    face_sizes.reserve(nF);
+    indices.reserve(3*nF);
     for (i=0; i<nF; ++i)
     {
         // read line
@@ -106,23 +108,30 @@ inline bool read_off_ascii(SurfaceMesh& mesh,
         lp = line;
 
         // #vertices
-        items = sscanf(lp, "%d%n", (int*)&nV, &nc);
+        items = sscanf(lp, "%u%n", &valence, &nc);
         assert(items == 1);
-        vertices.resize(nV);
+        face_sizes.push_back(valence);
         lp += nc;
 
         // indices
-        for (j=0; j<nV; ++j)
+        for (j=0; j<valence; ++j)
         {
-            items = sscanf(lp, "%d%n", (int*)&idx, &nc);
+            items = sscanf(lp, "%lld%n", &idx, &nc);
             assert(items == 1);
-            vertices[j] = SurfaceMesh::Vertex(idx);
+            indices.push_back((Size) idx);
             lp += nc;
         }
-        mesh.add_face(vertices);
     }
 
 
+    if (!mesh.build_from_indices(points, face_sizes, indices))
+        return false;
+
+    // properties
+    if (has_normals)   mesh.vertex_property<Normal>("v:normal").vector().assign(normals.begin(), normals.end());
+    if (has_texcoords) mesh.vertex_property<TextureCoordinate>("v:texcoord").vector().assign(texcoords.begin(), texcoords.end());
+    if (has_colors)    mesh.vertex_property<Color>("v:color").vector().assign(colors.begin(), colors.end());
+
     return true;
 }
 
@@ -143,26 +152,22 @@ inline bool read_off_binary(SurfaceMesh& mesh,
     unsigned int       nV, nF, nE;
     Vec3               p, n, c;
     Vec2               t;
-    SurfaceMesh::Vertex  v;
 
 
     // binary cannot (yet) read colors
     if (has_colors) return false;
 
 
-    // properties
-    SurfaceMesh::Vertex_property<Normal>              normals;
-    SurfaceMesh::Vertex_property<TextureCoordinate>  texcoords;
-    if (has_normals)   normals   = mesh.vertex_property<Normal>("v:normal");
-    if (has_texcoords) texcoords = mesh.vertex_property<TextureCoordinate>("v:texcoord");
-
-
     // #Vertice, #Faces, #Edges
     read(in, nV);
     read(in, nF);
     read(in, nE);
-    mesh.clear();
-    mesh.reserve(nV, std::max(3*nV, nE), nF);
+
+    // vertex data is gathered first, the mesh is built at once at the end
+    std::vector<Vec3> points, normals, texcoords;
+    points.reserve(nV);
+    if (has_normals)   normals.resize(nV, Vec3(0,0,0));
+    if (has_texcoords) texcoords.resize(nV, Vec3(0,0,0));
 
 
     // read vertices: pos [normal] [color] [texcoord]
@@ -170,40 +175,49 @@ inline bool read_off_binary(SurfaceMesh& mesh,
     {
         // position
         read(in, p);
-        v = mesh.add_vertex((Vec3)p);
+        points.push_back(p);
 
         // normal
         if (has_normals)
         {
             read(in, n);
-            normals[v] = n;
+            normals[i] = n;
         }
 
         // tex coord
         if (has_texcoords)
         {
             read(in, t);
-            texcoords[v][0] = t[0];
-            texcoords[v][1] = t[1];
+            texcoords[i][0] = t[0];
+            texcoords[i][1] = t[1];
         }
     }
 
 
-    // read faces: #N v[1] v[2] ... v[n-1]
-    std::vector<SurfaceMesh::Vertex> vertices;
+    // read faces: #N v[1] v[2] ... v[n-1] (32 bit in the file)
+    std::vector<unsigned int> face_sizes;
+    std::vector<Size> indices;
+    face_sizes.reserve(nF);
+    indices.reserve(3*nF);
     for (i=0; i<nF; ++i)
     {
         read(in, nV);
-        vertices.resize(nV);
+        face_sizes.push_back(nV);
         for (j=0; j<nV; ++j)
         {
             read(in, idx);
-            vertices[j] = SurfaceMesh::Vertex(idx);
+            indices.push_back(idx);
         }
-        mesh.add_face(vertices);
     }
 
 
+    if (!mesh.build_from_indices(points, face_sizes, indices))
+        return false;
+
+    // properties
+    if (has_normals)   mesh.vertex_property<Normal>("v:normal").vector().assign(normals.begin(), normals.end());
+    if (has_texcoords) mesh.vertex_property<TextureCoordinate>("v:texcoord").vector().assign(texcoords.begin(), texcoords.end());
+
     return true;
 }
 
@@ -293,10 +307,10 @@ bool write_off(const SurfaceMesh& mesh, const std::string& filename)
     bool  has_normals   = false;
     bool  has_texcoords = false;
 
-    SurfaceMesh::Vertex_property<Normal> normals = mesh.get_vertex_property<Normal>("v:normal");
-    SurfaceMesh::Vertex_property<TextureCoordinate> texcoords = mesh.get_vertex_property<TextureCoordinate>("v:texcoord");
-    SurfaceMesh::Vertex_property<Color> vcolor = mesh.get_vertex_property<Color>("v:color");
-    SurfaceMesh::Face_property<Color> fcolor = mesh.get_face_property<Color>("f:color");
+    const SurfaceMesh::Vertex_property<Normal> normals = mesh.get_vertex_property<Normal>("v:normal");
+    const SurfaceMesh::Vertex_property<TextureCoordinate> texcoords = mesh.get_vertex_property<TextureCoordinate>("v:texcoord");
+    const SurfaceMesh::Vertex_property<Color> vcolor = mesh.get_vertex_property<Color>("v:color");
+    const SurfaceMesh::Face_property<Color> fcolor = mesh.get_face_property<Color>("f:color");
 
     if (normals)   has_normals = true;
     if (texcoords) has_texcoords = true;
@@ -309,10 +323,10 @@ bool write_off(const SurfaceMesh& mesh, const std::string& filename)
         fprintf(out, "N");
     if(vcolor)
         fprintf(out, "C");
-    fprintf(out, "OFF\n%d %d 0\n", mesh.n_vertices(), mesh.n_faces());
+    fprintf(out, "OFF\n%lld %lld 0\n", (long long) mesh.n_vertices(), (long long) mesh.n_faces());
 
     // vertices, and optionally normals and texture coordinates
-    SurfaceMesh::Vertex_property<Vec3> points = mesh.get_vertex_property<Vec3>("v:point");
+    const SurfaceMesh::Vertex_property<Vec3> points = mesh.get_vertex_property<Vec3>("v:point");
     for (SurfaceMesh::Vertex_iterator vit=mesh.vertices_begin(); vit!=mesh.vertices_end(); ++vit)
     {
         const Point& p = points[*vit];
@@ -348,7 +362,7 @@ bool write_off(const SurfaceMesh& mesh, const std::string& filename)
         SurfaceMesh::Vertex_around_face_circulator fvit=mesh.vertices(*fit), fvend=fvit;
         do
         {
-            fprintf(out, " %d", (*fvit).idx());
+            fprintf(out, " %lld", (long long) (*fvit).idx());
         }
         while (++fvit != fvend);
 
@@ -0,0 +1,386 @@
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Library General Public License Version 2
+// as published by the Free Software Foundation.
+//
+// This file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with OpenGP.  If not, see <http://www.gnu.org/licenses/>.
+
+//== INCLUDES =================================================================
+
+#include <OpenGP/SurfaceMesh/SurfaceMesh.h>
+#include <OpenGP/SurfaceMesh/IO/IO.h>
+#include <OpenGP/SurfaceMesh/internal/raw_types.h>
+#include <OpenGP/util/mapped_file.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+//=============================================================================
+namespace OpenGP {
+//=============================================================================
+
+/// The OGP format: the property arrays of a SurfaceMesh as they are in memory.
+///
+///     header      64 bytes, Ogp_header
+///     directory   one Ogp_entry per array (naming its container), followed
+///                 by the name and the type tag of the array (not
+///                 terminated), padded to 8 bytes
+///     arrays      at the offsets given by the directory, 64-byte aligned
+///                 (page aligned when they are large, so they can be mapped)
+///
+/// Numbers are in the byte order of the machine that wrote the file (the
+/// reader rejects the other one), bool arrays are stored as Bitset words.
+namespace internal {
+
+struct Ogp_header{
+    char     magic[8];    ///< "OGPMESH"
+    uint32_t version;     ///< 2
+    uint32_t byte_order;  ///< 0x01020304 as written
+    uint32_t index_size;  ///< sizeof(Index)
+    uint32_t n_arrays;
+    uint64_t sizes[4];    ///< vertices, halfedges, edges, faces (deleted ones included)
+    uint64_t directory_size;
+};
+
+struct Ogp_entry{
+    uint64_t offset;
+    uint64_t bytes;
+    uint64_t n;            ///< elements
+    uint32_t element_size; ///< bytes per element, 0 for bool (bits)
+    uint16_t name_length;
+    uint16_t tag_length;
+    uint32_t container;    ///< 0-3: vertex, halfedge, edge or face property
+    uint32_t reserved;
+};
+
+static_assert(sizeof(Ogp_header) == 64, "unexpected padding of Ogp_header");
+static_assert(sizeof(Ogp_entry) == 40, "unexpected padding of Ogp_entry");
+
+const uint32_t ogp_version = 2;
+const uint32_t ogp_byte_order = 0x01020304;
+
+/// arrays of 64kB and more are page aligned
+inline uint64_t ogp_alignment(uint64_t bytes){ return (bytes >= 65536) ? 4096 : 64; }
+
+inline uint64_t ogp_align(uint64_t offset, uint64_t alignment){ return (offset + alignment - 1) / alignment * alignment; }
+
+/// the bytes of \c entry's elements (Bitset words for bits), false if they overflow
+inline bool ogp_array_bytes(const Ogp_entry& entry, uint64_t& bytes){
+    if (entry.element_size == 0) { bytes = 8 * (entry.n / 64 + (entry.n % 64 != 0)); return true; }
+    if (entry.n > UINT64_MAX / entry.element_size) return false;
+    bytes = entry.n * entry.element_size;
+    return true;
+}
+
+/// an array to write
+struct Ogp_array{
+    std::string name;
+    std::string tag;
+    Ogp_entry entry;
+    const void* data;
+};
+
+/// the raw bytes of a property
+struct Ogp_write_visitor{
+    const Property_container& props;
+    const std::string& name;
+    Ogp_array& array;
+
+    template <class T> bool apply(const char* tag){
+        const Property<T> p = props.get<T>(name);
+        if(!p) return false;
+        array.tag = tag;
+        array.entry.element_size = uint32_t(sizeof(T));
+        array.entry.n = p.vector().size();
+        array.entry.bytes = sizeof(T) * array.entry.n;
+        array.data = p.vector().data();
+        return true;
+    }
+};
+
+/// Puts the n elements at \c offset of the file into the property: the pages
+/// are mapped (copy-on-write) if \c resource is given and the array is page
+/// aligned, else the elements are copied from \c file.
+struct Ogp_read_visitor{
+    Property_container& props;
+    const std::string& name;
+    const Mapped_file& file;
+    Mapped_image_resource* resource;
+    const Ogp_entry& entry;
+    bool known;  ///< whether the type tag is known
+    bool mapped;
+
+    template <class T> bool apply(const char* /*tag*/){
+        typedef typename Property<T>::vector_type vector_type;
+        known = true;
+        if(entry.element_size != sizeof(T)) return false;
+        Property<T> p = props.get_or_add<T>(name);
+        if(!p) return false;
+        const size_t n = size_t(entry.n);
+
+        mapped = false;
+        if(resource && n > 0 && entry.offset % Mapped_image_resource::page_size() == 0){
+            vector_type data((Resource_allocator<T>(resource)));
+            resource->begin_adopt(int64_t(entry.offset));
+            try{
+                data.reserve(n);
+                data.resize(n);
+                mapped = true;
+            } catch(const std::bad_alloc&){}
+            resource->end_adopt();
+            if(mapped){
+                p.vector().swap(data);
+                return true;
+            }
+        }
+
+        // the arrays are 64-byte aligned in the file, not necessarily in memory
+        vector_type data(p.vector().get_allocator());
+        data.resize(n);
+        if (n > 0) memcpy(static_cast<void*>(data.data()), file.data() + entry.offset, n * sizeof(T));
+        p.vector().swap(data);
+        return true;
+    }
+};
+
+} // namespace internal
+
+
+//-----------------------------------------------------------------------------
+
+
+/// Writes every vertex, halfedge, edge and face property of a raw type (see
+/// internal::visit_raw_type) or bool, deleted elements included.
+bool write_ogp(const SurfaceMesh& mesh, const std::string& filename)
+{
+    using namespace internal;
+
+    // the containers are only read, shared arrays are not copied
+    const Property_container* containers[4] = { &mesh.vprops_, &mesh.hprops_, &mesh.eprops_, &mesh.fprops_ };
+
+
+    // the arrays of raw types and bool, the others are skipped
+    std::vector<Ogp_array> arrays;
+    for (uint32_t k=0; k<4; ++k)
+    {
+        const Property_container* props = containers[k];
+        for (const std::string& name : props->properties())
+        {
+            Ogp_array array;
+            memset(&array.entry, 0, sizeof(Ogp_entry));
+            array.entry.container = k;
+            array.name = name;
+            const std::type_info& type = props->get_type(name);
+            if (type == typeid(bool))
+            {
+                const Property<bool> p = props->get<bool>(name);
+                array.tag = "bits";
+                array.entry.n = p.vector().size();
+                array.entry.bytes = 8 * Bitset::n_words(p.vector().size());
+                array.data = p.vector().words();
+            }
+            else
+            {
+                Ogp_write_visitor visitor = { *props, name, array };
+                if (!visit_raw_type(std::string(), type, visitor)) continue;
+            }
+            if (name.size() > 0xffff) continue;
+            array.entry.name_length = uint16_t(array.name.size());
+            array.entry.tag_length = uint16_t(array.tag.size());
+            arrays.push_back(array);
+        }
+    }
+
+
+    // the layout
+    Ogp_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "OGPMESH", 8);
+    header.version = ogp_version;
+    header.byte_order = ogp_byte_order;
+    header.index_size = uint32_t(sizeof(Index));
+    header.n_arrays = uint32_t(arrays.size());
+    header.sizes[0] = mesh.vertices_size();
+    header.sizes[1] = mesh.halfedges_size();
+    header.sizes[2] = mesh.edges_size();
+    header.sizes[3] = mesh.faces_size();
+    for (const Ogp_array& array : arrays)
+        header.directory_size += ogp_align(sizeof(Ogp_entry) + array.name.size() + array.tag.size(), 8);
+
+    uint64_t offset = sizeof(Ogp_header) + header.directory_size;
+    for (Ogp_array& array : arrays)
+    {
+        offset = ogp_align(offset, ogp_alignment(array.entry.bytes));
+        array.entry.offset = offset;
+        offset += array.entry.bytes;
+    }
+
+
+    // header, directory, then the arrays
+    FILE* out = fopen(filename.c_str(), "wb");
+    if (!out) return false;
+    const char zeros[4096] = { 0 };
+    uint64_t position = 0;
+    auto put = [&](const void* data, uint64_t bytes)
+    {
+        if (bytes > 0) fwrite(data, 1, size_t(bytes), out);
+        position += bytes;
+    };
+
+    put(&header, sizeof(header));
+    for (const Ogp_array& array : arrays)
+    {
+        const uint64_t start = position;
+        put(&array.entry, sizeof(Ogp_entry));
+        put(array.name.data(), array.name.size());
+        put(array.tag.data(), array.tag.size());
+        put(zeros, ogp_align(position - start, 8) - (position - start));
+    }
+    for (const Ogp_array& array : arrays)
+    {
+        put(zeros, array.entry.offset - position);
+        put(array.data, array.entry.bytes);
+    }
+
+    const bool ok = !ferror(out);
+    fclose(out);
+    return ok;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+/// With a \c resource (opened on \c filename), the page-aligned arrays are
+/// mapped copy-on-write instead of read: loading touches nothing but the
+/// header, the pages are read when first used. The resource has to outlive
+/// the mesh and its copies, which share the arrays until they are written
+/// (see SurfaceMesh::set_memory_resource).
+bool read_ogp(SurfaceMesh& mesh, const std::string& filename, Mapped_image_resource* resource)
+{
+    using namespace internal;
+
+    Mapped_file file;
+    if (!file.open(filename)) return false;
+    const char* data = file.data();
+    const uint64_t size = file.size();
+
+
+    // header
+    Ogp_header header;
+    if (size < sizeof(header)) return false;
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, "OGPMESH", 8) != 0) return false;
+    if (header.version != ogp_version || header.byte_order != ogp_byte_order)
+    {
+        std::cerr << "[read_ogp] " << filename << " has version " << header.version
+                  << " or was written with another byte order" << std::endl;
+        return false;
+    }
+    if (header.index_size != sizeof(Index))
+    {
+        std::cerr << "[read_ogp] " << filename << " was saved with " << 8*header.index_size
+                  << " bit indices (see OPENGP_INDEX_TYPE)" << std::endl;
+        return false;
+    }
+    if (header.directory_size > size - sizeof(header)) return false;
+
+    mesh.clear();
+    if (resource && !resource->open(filename))
+    {
+        std::cerr << "[read_ogp] Could not map " << filename << ", reading it instead" << std::endl;
+        resource = NULL;
+    }
+
+
+    // the arrays
+    Property_container* containers[4] = { &mesh.vprops_, &mesh.hprops_, &mesh.eprops_, &mesh.fprops_ };
+    const char* entry_data = data + sizeof(header);
+    const char* directory_end = entry_data + header.directory_size;
+    for (uint32_t i=0; i<header.n_arrays; ++i)
+    {
+        Ogp_entry entry;
+        if (size_t(directory_end - entry_data) < sizeof(entry)) return false;
+        memcpy(&entry, entry_data, sizeof(entry));
+        const uint64_t length = sizeof(entry) + entry.name_length + entry.tag_length;
+        if (uint64_t(directory_end - entry_data) < length) return false;
+        const std::string name(entry_data + sizeof(entry), entry.name_length);
+        const std::string tag(entry_data + sizeof(entry) + entry.name_length, entry.tag_length);
+        entry_data += ogp_align(length, 8);
+
+        const uint32_t k = entry.container;
+        uint64_t bytes = 0;
+        if (k >= 4 || entry.n != header.sizes[k] || (tag == "bits") != (entry.element_size == 0) ||
+            !ogp_array_bytes(entry, bytes) || entry.bytes != bytes ||
+            entry.offset % 64 != 0 || entry.offset > size || entry.bytes > size - entry.offset)
+        {
+            std::cerr << "[read_ogp] " << filename << ": invalid array \"" << name << "\"" << std::endl;
+            mesh.clear();
+            return false;
+        }
+        Property_container& props = *containers[k];
+
+        bool ok;
+        if (tag == "bits")
+        {
+            // every word is in the file, only the set bits are assigned (deletion flags are mostly zero)
+            Property<bool> p = props.get_or_add<bool>(name);
+            ok = bool(p);
+            if (ok)
+            {
+                Bitset& bits = p.vector();
+                bits.clear();
+                bits.resize(size_t(entry.n), false);
+                const char* words = data + entry.offset;
+                for (size_t w=0; w<size_t(entry.bytes / 8); ++w)
+                {
+                    Bitset::word_type word;
+                    memcpy(&word, words + 8*w, 8);
+                    for (; word; word &= word - 1)
+                        bits[64*w + bitset_lowest_bit(word)] = true;
+                }
+            }
+        }
+        else
+        {
+            Ogp_read_visitor visitor = { props, name, file, resource, entry, false, false };
+            ok = visit_raw_type(tag, typeid(void), visitor);
+            if (!visitor.known)
+            {
+                // a type this build does not know
+                std::cerr << "[read_ogp] Skipping the property \"" << name << "\" of type " << tag << std::endl;
+                continue;
+            }
+        }
+        if (!ok)
+        {
+            std::cerr << "[read_ogp] Could not read the property \"" << name << "\" of " << filename << std::endl;
+            mesh.clear();
+            return false;
+        }
+    }
+
+
+    // properties that were not in the file get their default value
+    mesh.vprops_.resize(size_t(header.sizes[0]));
+    mesh.hprops_.resize(size_t(header.sizes[1]));
+    mesh.eprops_.resize(size_t(header.sizes[2]));
+    mesh.fprops_.resize(size_t(header.sizes[3]));
+
+    mesh.deleted_vertices_ = Size(mesh.vdeleted_.vector().count());
+    mesh.deleted_edges_    = Size(mesh.edeleted_.vector().count());
+    mesh.deleted_faces_    = Size(mesh.fdeleted_.vector().count());
+    mesh.garbage_ = (mesh.deleted_vertices_ + mesh.deleted_edges_ + mesh.deleted_faces_) > 0;
+    mesh.topology_rebuilt();
+    return true;
+}
+
+//=============================================================================
+} // namespace OpenGP
+//=============================================================================
@@ -0,0 +1,606 @@
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Library General Public License Version 2
+// as published by the Free Software Foundation.
+//
+// This file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with OpenGP.  If not, see <http://www.gnu.org/licenses/>.
+
+//== INCLUDES =================================================================
+
+#include <OpenGP/SurfaceMesh/SurfaceMesh.h>
+#include <OpenGP/SurfaceMesh/IO/IO.h>
+#include <OpenGP/util/mapped_file.h>
+#include <OpenGP/util/number_parser.h>
+#include <OpenGP/util/parallel.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+//=============================================================================
+namespace OpenGP {
+//=============================================================================
+
+namespace internal {
+
+/// scalar types of PLY properties
+enum Ply_type { PLY_NONE, PLY_INT8, PLY_UINT8, PLY_INT16, PLY_UINT16, PLY_INT32, PLY_UINT32, PLY_FLOAT32, PLY_FLOAT64 };
+
+inline Ply_type ply_type(const std::string& name){
+    if (name == "char"   || name == "int8")    return PLY_INT8;
+    if (name == "uchar"  || name == "uint8")   return PLY_UINT8;
+    if (name == "short"  || name == "int16")   return PLY_INT16;
+    if (name == "ushort" || name == "uint16")  return PLY_UINT16;
+    if (name == "int"    || name == "int32")   return PLY_INT32;
+    if (name == "uint"   || name == "uint32")  return PLY_UINT32;
+    if (name == "float"  || name == "float32") return PLY_FLOAT32;
+    if (name == "double" || name == "float64") return PLY_FLOAT64;
+    return PLY_NONE;
+}
+
+inline size_t ply_size(Ply_type t){
+    static const size_t size[] = { 0, 1, 1, 2, 2, 4, 4, 4, 8 };
+    return size[t];
+}
+
+/// the PLY type of a property value type (PLY_NONE if it has none)
+template <class T> Ply_type ply_type_of(){ return PLY_NONE; }
+template <> inline Ply_type ply_type_of<int8_t>()   { return PLY_INT8; }
+template <> inline Ply_type ply_type_of<uint8_t>()  { return PLY_UINT8; }
+template <> inline Ply_type ply_type_of<int16_t>()  { return PLY_INT16; }
+template <> inline Ply_type ply_type_of<uint16_t>() { return PLY_UINT16; }
+template <> inline Ply_type ply_type_of<int32_t>()  { return PLY_INT32; }
+template <> inline Ply_type ply_type_of<uint32_t>() { return PLY_UINT32; }
+template <> inline Ply_type ply_type_of<float>()    { return PLY_FLOAT32; }
+template <> inline Ply_type ply_type_of<double>()   { return PLY_FLOAT64; }
+
+inline const char* ply_type_name(Ply_type t){
+    static const char* name[] = { "", "char", "uchar", "short", "ushort", "int", "uint", "float", "double" };
+    return name[t];
+}
+
+/// reads a value of type t at p (byte swapped if swap)
+inline double ply_value(const char* p, Ply_type t, bool swap){
+    char b[8];
+    const size_t n = ply_size(t);
+    if (swap) for (size_t k=0; k<n; ++k) b[k] = p[n-1-k];
+    else      memcpy(b, p, n);
+    switch (t) {
+        case PLY_INT8:    { int8_t   x; memcpy(&x, b, 1); return x; }
+        case PLY_UINT8:   { uint8_t  x; memcpy(&x, b, 1); return x; }
+        case PLY_INT16:   { int16_t  x; memcpy(&x, b, 2); return x; }
+        case PLY_UINT16:  { uint16_t x; memcpy(&x, b, 2); return x; }
+        case PLY_INT32:   { int32_t  x; memcpy(&x, b, 4); return x; }
+        case PLY_UINT32:  { uint32_t x; memcpy(&x, b, 4); return x; }
+        case PLY_FLOAT32: { float    x; memcpy(&x, b, 4); return x; }
+        case PLY_FLOAT64: { double   x; memcpy(&x, b, 8); return x; }
+        default: return 0;
+    }
+}
+
+/// stores x as a native value of type t at p
+inline void ply_store(char* p, Ply_type t, double x){
+    switch (t) {
+        case PLY_INT8:    { int8_t   v = int8_t(x);   memcpy(p, &v, 1); break; }
+        case PLY_UINT8:   { uint8_t  v = uint8_t(x);  memcpy(p, &v, 1); break; }
+        case PLY_INT16:   { int16_t  v = int16_t(x);  memcpy(p, &v, 2); break; }
+        case PLY_UINT16:  { uint16_t v = uint16_t(x); memcpy(p, &v, 2); break; }
+        case PLY_INT32:   { int32_t  v = int32_t(x);  memcpy(p, &v, 4); break; }
+        case PLY_UINT32:  { uint32_t v = uint32_t(x); memcpy(p, &v, 4); break; }
+        case PLY_FLOAT32: { float    v = float(x);    memcpy(p, &v, 4); break; }
+        case PLY_FLOAT64: { memcpy(p, &x, 8); break; }
+        default: break;
+    }
+}
+
+struct Ply_property{
+    std::string name;
+    Ply_type type = PLY_NONE;       ///< of the value, or of the list items
+    Ply_type count_type = PLY_NONE; ///< of the list size, PLY_NONE for scalars
+    size_t offset = 0;              ///< in the packed record of the scalars
+};
+
+struct Ply_element{
+    std::string name;
+    size_t count = 0;
+    std::vector<Ply_property> properties;
+    size_t stride = 0;   ///< of the packed record of the scalars
+    bool has_lists = false;
+};
+
+/// the scalars of an element, packed in records of element.stride bytes
+struct Ply_table{
+    const char* data = NULL; ///< the mapped file itself if its records are packed and native, else buffer
+    std::vector<char> buffer;
+};
+
+/** Reads the element starting at p (which is advanced past it). Binary
+ elements without lists in the native byte order are not copied: their
+ table points into the file. Otherwise the scalars are packed into the
+ table buffer (swapped into the native order, or parsed from text), and
+ list(record, property, items) is called for every list. */
+template <class List>
+bool ply_read_element(const char*& p, const char* end, const Ply_element& e, bool ascii, bool swap,
+                      Ply_table& table, List list){
+    if (!ascii && !e.has_lists && !swap) {
+        if (size_t(end - p) / std::max<size_t>(e.stride, 1) < e.count) return false;
+        table.data = p;
+        p += e.count * e.stride;
+        return true;
+    }
+
+    table.buffer.resize(e.count * e.stride);
+    std::vector<long long> items;
+    for (size_t r=0; r<e.count; ++r) {
+        char* record = table.buffer.data() + r * e.stride;
+        for (size_t k=0; k<e.properties.size(); ++k) {
+            const Ply_property& prop = e.properties[k];
+            if (prop.count_type == PLY_NONE) { // scalar
+                if (ascii) {
+                    double x;
+                    if (!parse_double(p, end, x)) return false;
+                    ply_store(record + prop.offset, prop.type, x);
+                } else {
+                    if (size_t(end - p) < ply_size(prop.type)) return false;
+                    ply_store(record + prop.offset, prop.type, ply_value(p, prop.type, swap));
+                    p += ply_size(prop.type);
+                }
+            } else { // list
+                long long n;
+                items.clear();
+                if (ascii) {
+                    if (!parse_integer(p, end, n) || n < 0) return false;
+                    for (long long i=0; i<n; ++i) {
+                        double x;
+                        if (!parse_double(p, end, x)) return false;
+                        items.push_back((long long) x);
+                    }
+                } else {
+                    const size_t cs = ply_size(prop.count_type), is = ply_size(prop.type);
+                    if (size_t(end - p) < cs) return false;
+                    n = (long long) ply_value(p, prop.count_type, swap);
+                    p += cs;
+                    if (n < 0 || size_t(end - p) / is < size_t(n)) return false;
+                    for (long long i=0; i<n; ++i, p += is)
+                        items.push_back((long long) ply_value(p, prop.type, swap));
+                }
+                list(r, k, items);
+            }
+        }
+        if (ascii) p = next_line(p, end);
+    }
+    table.data = table.buffer.data();
+    return true;
+}
+
+/** Copies a column of a table into dst[i*dst_stride] (i < n, in parallel),
+ for row rows[i] (rows=NULL: row i). Matching types are copied bytewise,
+ others converted (and multiplied by scale). */
+template <class T>
+void ply_copy_column(const Ply_table& table, const Ply_element& e, const Ply_property& prop, size_t n,
+                     const Index* rows, T* dst, size_t dst_stride, double scale=1){
+    const bool same = (ply_type_of<T>() == prop.type) && scale == 1;
+    parallel_for_chunks(0, Index(n), [&](Index begin, Index end) {
+        for (Index i=begin; i<end; ++i) {
+            const char* src = table.data + size_t(rows ? rows[i] : i) * e.stride + prop.offset;
+            if (same) memcpy(dst + i * dst_stride, src, sizeof(T));
+            else      dst[i * dst_stride] = T(scale * ply_value(src, prop.type, false));
+        }
+    });
+}
+
+/// adds the vertex (or face) property \c name of the value type of \c prop and copies the column into it
+inline void ply_add_column(SurfaceMesh& mesh, bool vertex, const std::string& name, const Ply_table& table,
+                           const Ply_element& e, const Ply_property& prop, size_t n, const Index* rows){
+    #define OPENGP_PLY_COLUMN(T) \
+    { \
+        if (vertex) { \
+            auto p = mesh.add_vertex_property<T>(name); \
+            if (p) ply_copy_column(table, e, prop, n, rows, p.vector().data(), 1); \
+        } else { \
+            auto p = mesh.add_face_property<T>(name); \
+            if (p) ply_copy_column(table, e, prop, n, rows, p.vector().data(), 1); \
+        } \
+        break; \
+    }
+    switch (prop.type) {
+        case PLY_INT8:    OPENGP_PLY_COLUMN(int8_t)
+        case PLY_UINT8:   OPENGP_PLY_COLUMN(uint8_t)
+        case PLY_INT16:   OPENGP_PLY_COLUMN(int16_t)
+        case PLY_UINT16:  OPENGP_PLY_COLUMN(uint16_t)
+        case PLY_INT32:   OPENGP_PLY_COLUMN(int32_t)
+        case PLY_UINT32:  OPENGP_PLY_COLUMN(uint32_t)
+        case PLY_FLOAT32: OPENGP_PLY_COLUMN(float)
+        case PLY_FLOAT64: OPENGP_PLY_COLUMN(double)
+        default: break;
+    }
+    #undef OPENGP_PLY_COLUMN
+}
+
+} // namespace internal
+
+
+//-----------------------------------------------------------------------------
+
+
+/// The vertex properties x,y,z go to "v:point", nx,ny,nz to "v:normal",
+/// red,green,blue to "v:color" (in [0,1]); any other scalar vertex (face)
+/// property "name" becomes a Vertex_property (Face_property) "v:name"
+/// ("f:name") of the same type. Binary columns are block copied, from the
+/// mapped file itself when the byte order is native. Other elements and
+/// lists are skipped.
+bool read_ply(SurfaceMesh& mesh, const std::string& filename)
+{
+    using namespace internal;
+
+    mesh.clear();
+
+    Mapped_file file;
+    if (!file.open(filename)) return false;
+    const char* p = file.data();
+    const char* end = file.end();
+
+
+    // header
+    if (file.size() < 4 || strncmp(p, "ply", 3) != 0) return false;
+    bool ascii = false, big_endian = false;
+    std::vector<Ply_element> elements;
+    for (p = next_line(p, end); ; p = next_line(p, end))
+    {
+        if (p == end) return false;
+        std::istringstream line(std::string(p, next_line(p, end)));
+        std::string keyword;
+        line >> keyword;
+        if (keyword == "format")
+        {
+            std::string format;
+            line >> format;
+            ascii = (format == "ascii");
+            big_endian = (format == "binary_big_endian");
+            if (!ascii && !big_endian && format != "binary_little_endian") return false;
+        }
+        else if (keyword == "element")
+        {
+            Ply_element e;
+            long long count = -1;
+            line >> e.name >> count;
+            if (count < 0) return false;
+            e.count = size_t(count);
+            elements.push_back(e);
+        }
+        else if (keyword == "property")
+        {
+            if (elements.empty()) return false;
+            Ply_element& e = elements.back();
+            Ply_property prop;
+            std::string type;
+            line >> type;
+            if (type == "list")
+            {
+                std::string count_type, item_type;
+                line >> count_type >> item_type;
+                prop.count_type = ply_type(count_type);
+                prop.type = ply_type(item_type);
+                e.has_lists = true;
+            }
+            else
+            {
+                prop.type = ply_type(type);
+                prop.offset = e.stride;
+                e.stride += ply_size(prop.type);
+            }
+            line >> prop.name;
+            if (prop.type == PLY_NONE || (type == "list" && prop.count_type == PLY_NONE))
+            {
+                std::cerr << "[read_ply] unknown type of property " << prop.name << "\n";
+                return false;
+            }
+            e.properties.push_back(prop);
+        }
+        else if (keyword == "end_header")
+        {
+            p = next_line(p, end);
+            break;
+        }
+    }
+    const uint16_t one = 1;
+    const bool native_big_endian = (*reinterpret_cast<const char*>(&one) == 0);
+    const bool swap = !ascii && (big_endian != native_big_endian);
+
+
+    // body: vertex scalars, face lists and scalars, the rest is skipped
+    std::vector<Vec3> points;
+    std::vector<unsigned int> face_sizes;
+    std::vector<Size> indices;
+    Ply_table vtable, ftable;
+    const Ply_element* velement = NULL;
+    const Ply_element* felement = NULL;
+    for (const Ply_element& e : elements)
+    {
+        bool ok;
+        if (e.name == "vertex")
+        {
+            velement = &e;
+            ok = ply_read_element(p, end, e, ascii, swap, vtable, [](size_t, size_t, const std::vector<long long>&){});
+        }
+        else if (e.name == "face")
+        {
+            felement = &e;
+            face_sizes.reserve(e.count);
+            indices.reserve(3 * e.count);
+            ok = ply_read_element(p, end, e, ascii, swap, ftable, [&](size_t, size_t k, const std::vector<long long>& items) {
+                const std::string& name = e.properties[k].name;
+                if (name != "vertex_indices" && name != "vertex_index") return;
+                face_sizes.push_back((unsigned int) items.size());
+                for (long long i : items) indices.push_back((Size) i);
+            });
+        }
+        else
+        {
+            Ply_table skipped;
+            ok = ply_read_element(p, end, e, ascii, swap, skipped, [](size_t, size_t, const std::vector<long long>&){});
+        }
+        if (!ok)
+        {
+            std::cerr << "[read_ply] " << filename << ": element " << e.name << " is truncated\n";
+            return false;
+        }
+    }
+    if (!velement) return false;
+
+
+    // vertex positions, then the mesh
+    const size_t nV = velement->count;
+    points.resize(nV, Vec3(0,0,0));
+    const char* coordinates[3][3] = { { "x", "y", "z" }, { "nx", "ny", "nz" }, { "red", "green", "blue" } };
+    for (const Ply_property& prop : velement->properties)
+        for (int k=0; k<3; ++k)
+            if (prop.count_type == PLY_NONE && prop.name == coordinates[0][k])
+                ply_copy_column(vtable, *velement, prop, nV, (const Index*) NULL, points.data()->data() + k, 3);
+
+    std::vector<Index> rejected;
+    if (!mesh.build_from_indices(points, face_sizes, indices, &rejected))
+        return false;
+
+
+    // vertex properties
+    SurfaceMesh::Vertex_property<Vec3> normals, colors;
+    for (const Ply_property& prop : velement->properties)
+    {
+        if (prop.count_type != PLY_NONE) continue;
+        int group = -1, k = 0;
+        for (int g=0; g<3; ++g)
+            for (int c=0; c<3; ++c)
+                if (prop.name == coordinates[g][c]) { group = g; k = c; }
+        if (group == 0) continue;
+        if (group == 1)
+        {
+            if (!normals) normals = mesh.vertex_property<Vec3>("v:normal");
+            ply_copy_column(vtable, *velement, prop, nV, (const Index*) NULL, normals.vector().data()->data() + k, 3);
+        }
+        else if (group == 2)
+        {
+            // integer colors are in [0,255]
+            if (!colors) colors = mesh.vertex_property<Vec3>("v:color");
+            const double scale = (prop.type == PLY_FLOAT32 || prop.type == PLY_FLOAT64) ? 1.0 : 1.0/255.0;
+            ply_copy_column(vtable, *velement, prop, nV, (const Index*) NULL, colors.vector().data()->data() + k, 3, scale);
+        }
+        else
+        {
+            ply_add_column(mesh, true, "v:" + prop.name, vtable, *velement, prop, nV, NULL);
+        }
+    }
+
+
+    // face properties, for the faces that were not rejected
+    if (felement && felement->stride > 0)
+    {
+        std::vector<Index> rows;
+        rows.reserve(mesh.faces_size());
+        for (Index f=0, r=0; f<(Index) face_sizes.size(); ++f)
+        {
+            if (r < (Index) rejected.size() && rejected[r] == f) ++r;
+            else rows.push_back(f);
+        }
+        for (const Ply_property& prop : felement->properties)
+            if (prop.count_type == PLY_NONE)
+                ply_add_column(mesh, false, "f:" + prop.name, ftable, *felement, prop, rows.size(), rows.data());
+    }
+
+    return true;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+/// Writes the faces as "vertex_indices", "v:point", "v:normal", "v:color"
+/// (as uchar) and every other vertex and face property of a scalar type
+/// (as "v:name" -> "name"). Binary files are written in the native byte
+/// order: the records are packed from the property arrays into blocks of
+/// about 1MB, or written straight from the array when it has the layout
+/// of the records (e.g. only "v:point" and no deleted vertices).
+bool write_ply(const SurfaceMesh& mesh, const std::string& filename, bool binary)
+{
+    using namespace internal;
+    typedef SurfaceMesh::Vertex Vertex;
+    typedef SurfaceMesh::Face Face;
+
+    FILE* out = fopen(filename.c_str(), binary ? "wb" : "w");
+    if (!out) return false;
+
+    // the columns to write: the value of element i has the type \c type and is at data + i*stride
+    struct Column
+    {
+        std::string name;
+        Ply_type type;
+        const char* data;
+        size_t stride;
+    };
+    auto scalar_columns = [&](const std::vector<std::string>& names, const std::string& prefix, bool vertices)
+    {
+        std::vector<Column> columns;
+        for (const std::string& name : names)
+        {
+            if (name.compare(0, prefix.size(), prefix) != 0) continue;
+            if (name == "v:point" || name == "v:normal" || name == "v:color") continue;
+            #define OPENGP_PLY_WRITE_COLUMN(T) \
+            { \
+                const Property<T> p = vertices ? Property<T>(mesh.get_vertex_property<T>(name)) \
+                                               : Property<T>(mesh.get_face_property<T>(name)); \
+                if (p) { columns.push_back(Column{ name.substr(prefix.size()), ply_type_of<T>(), \
+                                                   reinterpret_cast<const char*>(p.vector().data()), sizeof(T) }); continue; } \
+            }
+            OPENGP_PLY_WRITE_COLUMN(int8_t)
+            OPENGP_PLY_WRITE_COLUMN(uint8_t)
+            OPENGP_PLY_WRITE_COLUMN(int16_t)
+            OPENGP_PLY_WRITE_COLUMN(uint16_t)
+            OPENGP_PLY_WRITE_COLUMN(int32_t)
+            OPENGP_PLY_WRITE_COLUMN(uint32_t)
+            OPENGP_PLY_WRITE_COLUMN(float)
+            OPENGP_PLY_WRITE_COLUMN(double)
+            #undef OPENGP_PLY_WRITE_COLUMN
+        }
+        return columns;
+    };
+    auto vec3_columns = [](std::vector<Column>& columns, const SurfaceMesh::Vertex_property<Vec3>& p, const char* names[3])
+    {
+        const char* data = reinterpret_cast<const char*>(p.vector().data());
+        for (int k=0; k<3; ++k)
+            columns.push_back(Column{ names[k], ply_type_of<Scalar>(), data + k * sizeof(Scalar), sizeof(Vec3) });
+    };
+
+    const SurfaceMesh::Vertex_property<Vec3> points = mesh.get_vertex_property<Vec3>("v:point");
+    const SurfaceMesh::Vertex_property<Vec3> normals = mesh.get_vertex_property<Vec3>("v:normal");
+    const SurfaceMesh::Vertex_property<Vec3> colors = mesh.get_vertex_property<Vec3>("v:color");
+    std::vector<Column> vcolumns;
+    const char* axes[3] = { "x", "y", "z" };
+    vec3_columns(vcolumns, points, axes);
+    if (normals)
+    {
+        const char* names[3] = { "nx", "ny", "nz" };
+        vec3_columns(vcolumns, normals, names);
+    }
+    std::vector<uint8_t> rgb; // colors in [0,1] go to uchar [0,255]
+    if (colors)
+    {
+        const char* names[3] = { "red", "green", "blue" };
+        const Scalar* c = colors.vector().data()->data();
+        rgb.resize(3 * mesh.vertices_size());
+        for (size_t i=0; i<rgb.size(); ++i)
+            rgb[i] = uint8_t(std::floor(std::min(1.0, std::max(0.0, double(c[i]))) * 255 + 0.5));
+        for (int k=0; k<3; ++k)
+            vcolumns.push_back(Column{ names[k], PLY_UINT8, reinterpret_cast<const char*>(rgb.data() + k), 3 });
+    }
+    std::vector<Column> vextra = scalar_columns(mesh.vertex_properties(), "v:", true);
+    vcolumns.insert(vcolumns.end(), vextra.begin(), vextra.end());
+    std::vector<Column> fcolumns = scalar_columns(mesh.face_properties(), "f:", false);
+
+    // vertices are renumbered past the deleted ones
+    std::vector<Index> vindex(mesh.vertices_size(), -1);
+    Index n = 0;
+    for (Vertex v : mesh.vertices()) vindex[v.idx()] = n++;
+
+
+    // header
+    const uint16_t one = 1;
+    const bool native_big_endian = (*reinterpret_cast<const char*>(&one) == 0);
+    fprintf(out, "ply\nformat %s 1.0\ncomment OpenGP\n",
+            !binary ? "ascii" : (native_big_endian ? "binary_big_endian" : "binary_little_endian"));
+    fprintf(out, "element vertex %lld\n", (long long) mesh.n_vertices());
+    for (const Column& c : vcolumns) fprintf(out, "property %s %s\n", ply_type_name(c.type), c.name.c_str());
+    fprintf(out, "element face %lld\nproperty list uchar int vertex_indices\n", (long long) mesh.n_faces());
+    for (const Column& c : fcolumns) fprintf(out, "property %s %s\n", ply_type_name(c.type), c.name.c_str());
+    fprintf(out, "end_header\n");
+
+
+    // the records: packed rows in a block buffer, or text lines
+    std::vector<char> block;
+    const size_t block_size = size_t(1) << 20;
+    block.reserve(block_size + 1024);
+    auto flush = [&]()
+    {
+        if (!block.empty()) fwrite(block.data(), 1, block.size(), out);
+        block.clear();
+    };
+    auto write_row = [&](const std::vector<Column>& columns, Index i)
+    {
+        for (const Column& c : columns)
+        {
+            const char* value = c.data + size_t(i) * c.stride;
+            if (binary) block.insert(block.end(), value, value + ply_size(c.type));
+            else if (c.type == PLY_FLOAT32 || c.type == PLY_FLOAT64) fprintf(out, " %.10g", ply_value(value, c.type, false));
+            else fprintf(out, " %lld", (long long) ply_value(value, c.type, false));
+        }
+    };
+
+    // vertices: the columns of a single array in record layout are written as they are
+    size_t record = 0;
+    bool direct = binary && mesh.n_vertices() == mesh.vertices_size();
+    for (const Column& c : vcolumns)
+    {
+        direct = direct && c.data == vcolumns[0].data + record;
+        record += ply_size(c.type);
+    }
+    if (direct && record == vcolumns[0].stride)
+    {
+        fwrite(vcolumns[0].data, record, mesh.n_vertices(), out);
+    }
+    else
+    {
+        for (Vertex v : mesh.vertices())
+        {
+            write_row(vcolumns, v.idx());
+            if (!binary) fprintf(out, "\n");
+            else if (block.size() >= block_size) flush();
+        }
+        flush();
+    }
+
+    for (Face f : mesh.faces())
+    {
+        const unsigned int valence = mesh.valence(f);
+        if (valence > 255)
+        {
+            std::cerr << "[write_ply] faces of more than 255 vertices are not supported\n";
+            fclose(out);
+            return false;
+        }
+        if (binary)
+        {
+            block.push_back(char(uint8_t(valence)));
+            for (Vertex v : mesh.vertices(f))
+            {
+                const int32_t i = int32_t(vindex[v.idx()]);
+                const char* b = reinterpret_cast<const char*>(&i);
+                block.insert(block.end(), b, b + 4);
+            }
+        }
+        else
+        {
+            fprintf(out, "%u", valence);
+            for (Vertex v : mesh.vertices(f)) fprintf(out, " %lld", (long long) vindex[v.idx()]);
+        }
+        write_row(fcolumns, f.idx());
+        if (!binary) fprintf(out, "\n");
+        else if (block.size() >= block_size) flush();
+    }
+    flush();
+
+    const bool ok = !ferror(out);
+    fclose(out);
+    return ok;
+}
+
+
+//=============================================================================
+} // namespace OpenGP
+//=============================================================================
@@ -64,7 +64,8 @@ bool read_poly(SurfaceMesh& mesh, const std::string& filename)
     SurfaceMesh::Face_property<SurfaceMesh::Face_connectivity>          fconn = mesh.face_property<SurfaceMesh::Face_connectivity>("f:connectivity");
     SurfaceMesh::Vertex_property<Vec3>                                  point = mesh.vertex_property<Vec3>("v:point");
 
-    // read properties from file
+    // read properties from file (raw handles: files only load with the Index
+    // width they were written with, see OPENGP_INDEX_TYPE)
     n_items = fread((char*)vconn.data(), sizeof(SurfaceMesh::Vertex_connectivity),   nv, in);
     n_items = fread((char*)hconn.data(), sizeof(SurfaceMesh::Halfedge_connectivity), nh, in);
     n_items = fread((char*)fconn.data(), sizeof(SurfaceMesh::Face_connectivity),     nf, in);
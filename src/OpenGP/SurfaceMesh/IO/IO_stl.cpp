@@ -14,10 +14,14 @@
 
 #include <OpenGP/SurfaceMesh/SurfaceMesh.h>
 #include <OpenGP/SurfaceMesh/IO/IO.h>
+#include <OpenGP/util/mapped_file.h>
+#include <OpenGP/util/number_parser.h>
+#include <OpenGP/util/parallel.h>
+#include <OpenGP/util/weld.h>
 
 #include <cstdio>
-#include <cfloat>
-#include <map>
+#include <cstdint>
+#include <cstring>
 
 
 //== NAMESPACES ===============================================================
@@ -29,175 +33,85 @@ namespace OpenGP {
 //== IMPLEMENTATION ===========================================================
 
 
-//-----------------------------------------------------------------------------
-
-
-// helper class for STL reader
-class CmpVec{
-    typedef Vec3 Normal;
-    typedef Vec3 TextureCoordinate;
-public:
-
-    CmpVec(float _eps=FLT_MIN) : eps_(_eps) {}
-
-    bool operator()(const Vec3& v0, const Vec3& v1) const
-    {
-        if (fabs(v0[0] - v1[0]) <= eps_)
-        {
-            if (fabs(v0[1] - v1[1]) <= eps_)
-            {
-                return (v0[2] < v1[2] - eps_);
-            }
-            else return (v0[1] < v1[1] - eps_);
-        }
-        else return (v0[0] < v1[0] - eps_);
-    }
-
-private:
-    float eps_;
-};
-
-
-//-----------------------------------------------------------------------------
-
-
-bool read_stl(SurfaceMesh& mesh, const std::string& filename){
-    // typedef Vec3 Normal;
-    // typedef Vec3 TextureCoordinate;
-
-    char                            line[100], *c;
-    unsigned int                    i, nT;
-    Vec3                            p;
-    SurfaceMesh::Vertex               v;
-    std::vector<SurfaceMesh::Vertex>  vertices(3);
-    size_t n_items(0);
-
-    CmpVec comp(FLT_MIN);
-    std::map<Vec3, SurfaceMesh::Vertex, CmpVec>            vMap(comp);
-    std::map<Vec3, SurfaceMesh::Vertex, CmpVec>::iterator  vMapIt;
-
+/// STL stores independent triangles: their corners are welded with
+/// weld_points() (exactly, or within \c weld_tolerance) and the mesh is
+/// built at once with SurfaceMesh::build_from_indices(). Triangles that
+/// degenerate after welding are skipped.
+bool read_stl(SurfaceMesh& mesh, const std::string& filename, Scalar weld_tolerance){
     // clear mesh
     mesh.clear();
 
-    // open file (in ASCII mode)
-    FILE* in = fopen(filename.c_str(), "r");
-    if (!in) return false;
+    Mapped_file file;
+    if (!file.open(filename)) return false;
+    const char* data = file.data();
+    const size_t size = file.size();
 
 
-    // ASCII or binary STL?
-    c = fgets(line, 6, in);
-    assert(c != NULL);
-    const bool binary = ((strncmp(line, "SOLID", 5) != 0) &&
-                         (strncmp(line, "solid", 5) != 0));
+    // ASCII or binary STL? Binary files may start with "solid" as well: a
+    // size matching the triangle count decides
+    uint32_t nT = 0;
+    if (size >= 84) memcpy(&nT, data + 80, 4);
+    const bool solid = (size >= 5) && (strncmp(data, "solid", 5) == 0 || strncmp(data, "SOLID", 5) == 0);
+    const bool binary = (size >= 84) && ((size == 84 + 50 * size_t(nT)) || (!solid && size >= 84 + 50 * size_t(nT)));
 
 
-    // parse binary STL
+    // gather the corners
+    std::vector<Vec3> corners;
     if (binary)
     {
-        // re-open file in binary mode
-        fclose(in);
-        in = fopen(filename.c_str(), "rb");
-        if (!in) return false;
-
-        // skip dummy header
-        n_items = fread(line, 1, 80, in);
-        assert(n_items > 0);
-
-        // read number of triangles
-        read(in, nT);
-
-        // read triangles
-        while (nT)
+        // 80 byte header, #triangles, then 50 bytes per triangle: normal, corners, attribute
+        corners.resize(3 * size_t(nT));
+        parallel_for_chunks(0, Index(nT), [&](Index begin, Index end)
         {
-            // skip triangle normal
-            n_items = fread(line, 1, 12, in);
-            assert(n_items > 0);
-            // triangle's vertices
-            for (i=0; i<3; ++i)
+            float p[9];
+            for (Index t=begin; t<end; ++t)
             {
-                read(in, p);
-
-                // has vector been referenced before?
-                if ((vMapIt=vMap.find(p)) == vMap.end())
-                {
-                    // No : add vertex and remember idx/vector mapping
-                    v = mesh.add_vertex((Vec3)p);
-                    vertices[i] = v;
-                    vMap[p] = v;
-                }
-                else
-                {
-                    // Yes : get index from map
-                    vertices[i] = vMapIt->second;
-                }
+                memcpy(p, data + 84 + 50 * size_t(t) + 12, sizeof(p));
+                for (int k=0; k<3; ++k)
+                    corners[3*t+k] = Vec3(p[3*k], p[3*k+1], p[3*k+2]);
             }
-
-            // Add face only if it is not degenerated
-            if ((vertices[0] != vertices[1]) &&
-                (vertices[0] != vertices[2]) &&
-                (vertices[1] != vertices[2]))
-                mesh.add_face(vertices);
-
-            n_items = fread(line, 1, 2, in);
-            assert(n_items > 0);
-            --nT;
-        }
+        });
     }
-
-
-    // parse ASCII STL
-    else
+    else if (solid)
     {
-        // parse line by line
-        while (in && !feof(in) && fgets(line, 100, in))
+        // only the "vertex x y z" lines matter, three per facet
+        const char* end = file.end();
+        for (const char* p = data; p < end; p = next_line(p, end))
         {
-            // skip white-space
-            for (c=line; isspace(*c) && *c!='\0'; ++c) {};
-
-            // face begins
-            if ((strncmp(c, "outer", 5) == 0) ||
-                (strncmp(c, "OUTER", 5) == 0))
+            const char* q = p;
+            skip_blanks(q, end);
+            if (end - q > 6 && (strncmp(q, "vertex", 6) == 0 || strncmp(q, "VERTEX", 6) == 0))
             {
-                // read three vertices
-                for (i=0; i<3; ++i)
-                {
-                    // read line
-                    c = fgets(line, 100, in);
-                    assert(c != NULL);
-
-                    // skip white-space
-                    for (c=line; isspace(*c) && *c!='\0'; ++c) {};
-
-                    // read x, y, z
-                    sscanf(c+6, "%f %f %f", &p[0], &p[1], &p[2]);
-
-                    // has vector been referenced before?
-                    if ((vMapIt=vMap.find(p)) == vMap.end())
-                    {
-                        // No : add vertex and remember idx/vector mapping
-                        v = mesh.add_vertex((Vec3)p);
-                        vertices[i] = v;
-                        vMap[p] = v;
-                    }
-                    else
-                    {
-                        // Yes : get index from map
-                        vertices[i] = vMapIt->second;
-                    }
-                }
-
-                // Add face only if it is not degenerated
-                if ((vertices[0] != vertices[1]) &&
-                    (vertices[0] != vertices[2]) &&
-                    (vertices[1] != vertices[2]))
-                    mesh.add_face(vertices);
+                q += 6;
+                Vec3 x;
+                if (parse_float(q, end, x[0]) && parse_float(q, end, x[1]) && parse_float(q, end, x[2]))
+                    corners.push_back(x);
             }
         }
+        corners.resize(corners.size() - corners.size() % 3);
     }
+    else return false;
+
 
+    // weld, drop degenerate triangles, build
+    std::vector<Index> corner_index;
+    std::vector<Vec3> points;
+    weld_points(corners, weld_tolerance, corner_index, points);
+    std::vector<Vec3>().swap(corners);
+
+    std::vector<Size> indices;
+    indices.reserve(corner_index.size());
+    for (size_t c=0; c<corner_index.size(); c+=3)
+    {
+        const Index a = corner_index[c], b = corner_index[c+1], d = corner_index[c+2];
+        if (a == b || a == d || b == d) continue;
+        indices.push_back(a);
+        indices.push_back(b);
+        indices.push_back(d);
+    }
+    std::vector<unsigned int> face_sizes(indices.size() / 3, 3);
 
-    fclose(in);
-    return true;
+    return mesh.build_from_indices(points, face_sizes, indices);
 }
 
 
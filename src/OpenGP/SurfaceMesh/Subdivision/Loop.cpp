@@ -18,9 +18,9 @@ void SurfaceMeshSubdivideLoop::exec(OpenGP::SurfaceMesh& mesh){
     CHECK(mesh.is_triangle_mesh());
 
     // reserve memory
-    int nv = mesh.n_vertices();
-    int ne = mesh.n_edges();
-    int nf = mesh.n_faces();
+    OpenGP::Size nv = mesh.n_vertices();
+    OpenGP::Size ne = mesh.n_edges();
+    OpenGP::Size nf = mesh.n_faces();
     mesh.reserve(nv+ne, 2*ne+3*nf, 4*nf);
 
     // get properties
@@ -30,7 +30,8 @@ void SurfaceMeshSubdivideLoop::exec(OpenGP::SurfaceMesh& mesh){
     VertexProperty<bool>  vfeature = mesh.get_vertex_property<bool>("v:feature");
     EdgeProperty<bool>    efeature = mesh.get_edge_property<bool>("e:feature");
 
-    // compute vertex positions
+    // compute vertex positions (the stencils read a snapshot of the one-rings)
+    OpenGP::SurfaceMesh::Adjacency adjacency = mesh.build_adjacency(OpenGP::SurfaceMesh::Adjacency::VERTEX_VERTEX);
     for(Vertex v: mesh.vertices()){
         if ( /*isolated vertex?*/ mesh.is_isolated(v)){
             vpoint[v] = points[v];
@@ -52,7 +53,7 @@ void SurfaceMeshSubdivideLoop::exec(OpenGP::SurfaceMesh& mesh){
             p *= 6.0;
             int count = 0;
 
-            for(Halfedge vh: mesh.halfedges(v)){
+            for(Halfedge vh: adjacency.halfedges(v)){
                 if (efeature[mesh.edge(vh)]) {
                     p += points[mesh.to_vertex(vh)];
                     ++count;
@@ -70,8 +71,8 @@ void SurfaceMeshSubdivideLoop::exec(OpenGP::SurfaceMesh& mesh){
         // interior vertex
         else {
             Point p = Point::Zero();
-            Scalar  inv_k = 1.0 / mesh.valence(v);
-            for(Vertex vvit: mesh.vertices(v))
+            Scalar  inv_k = 1.0 / adjacency.valence(v);
+            for(Vertex vvit: adjacency.vertices(v))
                 p += inv_k * points[vvit];
             Scalar beta = (0.625 - pow(0.375 + 0.25*cos(2.0*M_PI*inv_k), 2.0));
 
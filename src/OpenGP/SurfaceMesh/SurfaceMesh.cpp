@@ -12,7 +12,11 @@
 
 #include <OpenGP/SurfaceMesh/SurfaceMesh.h>
 #include <OpenGP/SurfaceMesh/IO/IO.h>
+#include <OpenGP/SurfaceMesh/normals.h>
+#include <OpenGP/util/parallel.h>
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
 
 //== NAMESPACE ================================================================
 namespace OpenGP {
@@ -36,6 +40,7 @@ SurfaceMesh()
 
     deleted_vertices_ = deleted_edges_ = deleted_faces_ = 0;
     garbage_ = false;
+    topology_version_.store(0, std::memory_order_relaxed);
 }
 
 
@@ -63,24 +68,31 @@ operator=(const SurfaceMesh& rhs)
         eprops_ = rhs.eprops_;
         fprops_ = rhs.fprops_;
 
-        // property handles contain pointers, have to be reassigned
-        vconn_    = vertex_property<Vertex_connectivity>("v:connectivity");
-        hconn_    = halfedge_property<Halfedge_connectivity>("h:connectivity");
-        fconn_    = face_property<Face_connectivity>("f:connectivity");
-        vdeleted_ = vertex_property<bool>("v:deleted");
-        edeleted_ = edge_property<bool>("e:deleted");
-        fdeleted_ = face_property<bool>("f:deleted");
-        vpoint_   = vertex_property<Vec3>("v:point");
+        copy_state(rhs);
+    }
 
-        // normals might be there, therefore use get_property
-        vnormal_  = get_vertex_property<Vec3>("v:normal");
-        fnormal_  = get_face_property<Vec3>("f:normal");
+    return *this;
+}
 
-        // how many elements are deleted?
-        deleted_vertices_ = rhs.deleted_vertices_;
-        deleted_edges_    = rhs.deleted_edges_;
-        deleted_faces_    = rhs.deleted_faces_;
-        garbage_          = rhs.garbage_;
+
+//-----------------------------------------------------------------------------
+
+
+SurfaceMesh&
+SurfaceMesh::
+share(const SurfaceMesh& rhs)
+{
+    if (this != &rhs)
+    {
+        // shared copy of property containers (copy-on-write)
+        vprops_.share(rhs.vprops_);
+        hprops_.share(rhs.hprops_);
+        eprops_.share(rhs.eprops_);
+        fprops_.share(rhs.fprops_);
+
+        // fetching the standard properties for writing copies them, the
+        // handles of rhs keep writing into storage of their own
+        copy_state(rhs);
     }
 
     return *this;
@@ -90,6 +102,41 @@ operator=(const SurfaceMesh& rhs)
 //-----------------------------------------------------------------------------
 
 
+void
+SurfaceMesh::
+copy_state(const SurfaceMesh& rhs)
+{
+    // property handles contain pointers, have to be reassigned
+    vconn_    = vertex_property<Vertex_connectivity>("v:connectivity");
+    hconn_    = halfedge_property<Halfedge_connectivity>("h:connectivity");
+    fconn_    = face_property<Face_connectivity>("f:connectivity");
+    vdeleted_ = vertex_property<bool>("v:deleted");
+    edeleted_ = edge_property<bool>("e:deleted");
+    fdeleted_ = face_property<bool>("f:deleted");
+    vpoint_   = vertex_property<Vec3>("v:point");
+
+    // normals might be there, therefore use get_property
+    vnormal_  = get_vertex_property<Vec3>("v:normal");
+    fnormal_  = get_face_property<Vec3>("f:normal");
+
+    // how many elements are deleted?
+    deleted_vertices_ = rhs.deleted_vertices_;
+    deleted_edges_    = rhs.deleted_edges_;
+    deleted_faces_    = rhs.deleted_faces_;
+    garbage_          = rhs.garbage_;
+
+    // the copy indexes its triangles again when asked for them
+    tbuffer_.enable(rhs.has_triangle_buffer());
+    topology_version_.store(0, std::memory_order_relaxed);
+
+    // the recorded edits refer to the replaced arrays
+    journal_.clear();
+}
+
+
+//-----------------------------------------------------------------------------
+
+
 SurfaceMesh&
 SurfaceMesh::
 assign(const SurfaceMesh& rhs)
@@ -135,6 +182,13 @@ assign(const SurfaceMesh& rhs)
         deleted_edges_    = rhs.deleted_edges_;
         deleted_faces_    = rhs.deleted_faces_;
         garbage_          = rhs.garbage_;
+
+        // the copy indexes its triangles again when asked for them
+        tbuffer_.enable(rhs.has_triangle_buffer());
+        topology_version_.store(0, std::memory_order_relaxed);
+
+        // the recorded edits refer to the replaced arrays
+        journal_.clear();
     }
 
     return *this;
@@ -182,6 +236,7 @@ clear()
 
     deleted_vertices_ = deleted_edges_ = deleted_faces_ = 0;
     garbage_ = false;
+    topology_rebuilt();
 }
 
 
@@ -204,9 +259,9 @@ free_memory()
 
 void
 SurfaceMesh::
-reserve(unsigned int nvertices,
-        unsigned int nedges,
-        unsigned int nfaces )
+reserve(Size nvertices,
+        Size nedges,
+        Size nfaces )
 {
     vprops_.reserve(nvertices);
     hprops_.reserve(2*nedges);
@@ -218,34 +273,297 @@ reserve(unsigned int nvertices,
 //-----------------------------------------------------------------------------
 
 
+void
+SurfaceMesh::
+set_memory_resource(Memory_resource* resource)
+{
+    vprops_.set_resource(resource);
+    hprops_.set_resource(resource);
+    eprops_.set_resource(resource);
+    fprops_.set_resource(resource);
+}
+
+
+//-----------------------------------------------------------------------------
+
+
 void
 SurfaceMesh::
 property_stats() const
 {
     std::vector<std::string> props;
 
-    std::cout << "vertex properties:\n";
+    std::cout << "vertex properties (" << vprops_.n_name_lookups() << " lookups by name, "
+              << vprops_.n_key_lookups() << " by key):\n";
     props = vertex_properties();
     for (unsigned int i=0; i<props.size(); ++i)
         std::cout << "\t" << props[i] << std::endl;
 
-    std::cout << "halfedge properties:\n";
+    std::cout << "halfedge properties (" << hprops_.n_name_lookups() << " lookups by name, "
+              << hprops_.n_key_lookups() << " by key):\n";
     props = halfedge_properties();
     for (unsigned int i=0; i<props.size(); ++i)
         std::cout << "\t" << props[i] << std::endl;
 
-    std::cout << "edge properties:\n";
+    std::cout << "edge properties (" << eprops_.n_name_lookups() << " lookups by name, "
+              << eprops_.n_key_lookups() << " by key):\n";
     props = edge_properties();
     for (unsigned int i=0; i<props.size(); ++i)
         std::cout << "\t" << props[i] << std::endl;
 
-    std::cout << "face properties:\n";
+    std::cout << "face properties (" << fprops_.n_name_lookups() << " lookups by name, "
+              << fprops_.n_key_lookups() << " by key):\n";
     props = face_properties();
     for (unsigned int i=0; i<props.size(); ++i)
         std::cout << "\t" << props[i] << std::endl;
 }
 
 
+//-----------------------------------------------------------------------------
+
+
+const std::vector<uint32_t>&
+SurfaceMesh::
+triangle_buffer() const
+{
+    assert(tbuffer_.enabled());
+    if (tbuffer_.stale() || tbuffer_.indices().size() != 3*size_t(faces_size()))
+    {
+        tbuffer_.update(faces_size(), [this](Index i, uint32_t* t)
+        {
+            t[0] = t[1] = t[2] = 0;
+            Face f(i);
+            if (fdeleted_[f]) return;
+            Halfedge h0 = halfedge(f);
+            Halfedge h1 = next_halfedge(h0);
+            Halfedge h2 = next_halfedge(h1);
+            if (next_halfedge(h2) != h0) return;
+            t[0] = (uint32_t) to_vertex(h0).idx();
+            t[1] = (uint32_t) to_vertex(h1).idx();
+            t[2] = (uint32_t) to_vertex(h2).idx();
+        });
+    }
+    return tbuffer_.indices();
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+std::vector< std::pair<Index,Index> >
+SurfaceMesh::
+triangle_buffer_dirty_ranges() const
+{
+    triangle_buffer();
+    return tbuffer_.dirty_ranges();
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+SurfaceMesh::Adjacency
+SurfaceMesh::
+build_adjacency(unsigned int relations, unsigned int n_threads) const
+{
+    Adjacency adj;
+    adj.mesh_      = this;
+    adj.version_   = topology_version();
+    adj.relations_ = relations & Adjacency::ALL;
+
+    // offsets from the per element counts (stored at i+1), then the entries
+    // of each element are written at its offset
+    auto prefix_sum = [](std::vector<Index>& offset)
+    {
+        for (size_t i=1; i<offset.size(); ++i)
+            offset[i] += offset[i-1];
+    };
+
+    const Index nV = vertices_size();
+    const Index nF = faces_size();
+
+    if (relations & (Adjacency::VERTEX_VERTEX | Adjacency::VERTEX_FACE))
+    {
+        const bool vv = (relations & Adjacency::VERTEX_VERTEX) != 0;
+        const bool vf = (relations & Adjacency::VERTEX_FACE) != 0;
+        if (vv) adj.vv_offset_.assign(nV+1, 0);
+        if (vf) adj.vf_offset_.assign(nV+1, 0);
+
+        parallel_for_chunks(0, nV, [&](Index begin, Index end)
+        {
+            for (Index i=begin; i<end; ++i)
+            {
+                Halfedge h = halfedge(Vertex(i));
+                if (vdeleted_[Vertex(i)] || !h.is_valid()) continue;
+                Index n_vertices = 0, n_faces = 0;
+                const Halfedge hend = h;
+                do
+                {
+                    ++n_vertices;
+                    if (face(h).is_valid()) ++n_faces;
+                    h = ccw_rotated_halfedge(h);
+                }
+                while (h != hend);
+                if (vv) adj.vv_offset_[i+1] = n_vertices;
+                if (vf) adj.vf_offset_[i+1] = n_faces;
+            }
+        }, n_threads);
+
+        if (vv)
+        {
+            prefix_sum(adj.vv_offset_);
+            adj.vv_vertex_.resize(adj.vv_offset_[nV]);
+            adj.vv_halfedge_.resize(adj.vv_offset_[nV]);
+        }
+        if (vf)
+        {
+            prefix_sum(adj.vf_offset_);
+            adj.vf_face_.resize(adj.vf_offset_[nV]);
+        }
+
+        parallel_for_chunks(0, nV, [&](Index begin, Index end)
+        {
+            for (Index i=begin; i<end; ++i)
+            {
+                Halfedge h = halfedge(Vertex(i));
+                if (vdeleted_[Vertex(i)] || !h.is_valid()) continue;
+                Index jv = vv ? adj.vv_offset_[i] : 0;
+                Index jf = vf ? adj.vf_offset_[i] : 0;
+                const Halfedge hend = h;
+                do
+                {
+                    if (vv)
+                    {
+                        adj.vv_vertex_[jv]   = to_vertex(h);
+                        adj.vv_halfedge_[jv] = h;
+                        ++jv;
+                    }
+                    if (vf && face(h).is_valid())
+                        adj.vf_face_[jf++] = face(h);
+                    h = ccw_rotated_halfedge(h);
+                }
+                while (h != hend);
+            }
+        }, n_threads);
+    }
+
+    if (relations & Adjacency::FACE_FACE)
+    {
+        adj.ff_offset_.assign(nF+1, 0);
+
+        parallel_for_chunks(0, nF, [&](Index begin, Index end)
+        {
+            for (Index i=begin; i<end; ++i)
+            {
+                if (fdeleted_[Face(i)]) continue;
+                Index n = 0;
+                const Halfedge hend = halfedge(Face(i));
+                Halfedge h = hend;
+                do
+                {
+                    if (face(opposite_halfedge(h)).is_valid()) ++n;
+                    h = next_halfedge(h);
+                }
+                while (h != hend);
+                adj.ff_offset_[i+1] = n;
+            }
+        }, n_threads);
+
+        prefix_sum(adj.ff_offset_);
+        adj.ff_face_.resize(adj.ff_offset_[nF]);
+
+        parallel_for_chunks(0, nF, [&](Index begin, Index end)
+        {
+            for (Index i=begin; i<end; ++i)
+            {
+                if (fdeleted_[Face(i)]) continue;
+                Index j = adj.ff_offset_[i];
+                const Halfedge hend = halfedge(Face(i));
+                Halfedge h = hend;
+                do
+                {
+                    Face g = face(opposite_halfedge(h));
+                    if (g.is_valid()) adj.ff_face_[j++] = g;
+                    h = next_halfedge(h);
+                }
+                while (h != hend);
+            }
+        }, n_threads);
+    }
+
+    return adj;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+SurfaceMesh::Checkpoint
+SurfaceMesh::
+checkpoint() const
+{
+    Checkpoint c;
+    c.epoch            = journal_.epoch();
+    c.position         = journal_.position();
+    c.n_vertices       = vertices_size();
+    c.n_halfedges      = halfedges_size();
+    c.n_edges          = edges_size();
+    c.n_faces          = faces_size();
+    c.deleted_vertices = deleted_vertices_;
+    c.deleted_edges    = deleted_edges_;
+    c.deleted_faces    = deleted_faces_;
+    c.garbage          = garbage_;
+    return c;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+bool
+SurfaceMesh::
+rollback(const Checkpoint& c)
+{
+    if (!journal_.enabled() || c.epoch != journal_.epoch() || c.position > journal_.position())
+    {
+        std::cerr << "[SurfaceMesh] rollback: the journal was cleared since the checkpoint\n";
+        return false;
+    }
+
+    // the faces whose triangles change back (before and after)
+    if (tbuffer_.enabled())
+    {
+        journal_.for_each_since(hconn_.parray_, c.position, [&](Index h, const Halfedge_connectivity& old)
+        {
+            tbuffer_.touch(face(Halfedge(h)).idx());
+            tbuffer_.touch(old.face_.idx());
+        });
+        journal_.for_each_since(fconn_.parray_, c.position, [&](Index f, const Face_connectivity&)
+        {
+            tbuffer_.touch(f);
+        });
+        journal_.for_each_since(fdeleted_.parray_, c.position, [&](Index f, bool)
+        {
+            tbuffer_.touch(f);
+        });
+    }
+
+    // restore the recorded writes, then drop the elements added since
+    journal_.rollback(c.position);
+    vprops_.resize(c.n_vertices);
+    hprops_.resize(c.n_halfedges);
+    eprops_.resize(c.n_edges);
+    fprops_.resize(c.n_faces);
+
+    deleted_vertices_ = c.deleted_vertices;
+    deleted_edges_    = c.deleted_edges;
+    deleted_faces_    = c.deleted_faces;
+    garbage_          = c.garbage;
+    topology_version_.store(0, std::memory_order_relaxed);
+    return true;
+}
+
+
 //-----------------------------------------------------------------------------
 
 HEADERONLY_INLINE
@@ -262,6 +580,32 @@ add_vertex(const Vec3& p)
 //-----------------------------------------------------------------------------
 
 
+SurfaceMesh::Vertex
+SurfaceMesh::
+add_vertices(Size n)
+{
+    const Vertex first(vertices_size());
+    vprops_.push_back(n);
+    return first;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+SurfaceMesh::Vertex
+SurfaceMesh::
+add_vertices(const std::vector<Vec3>& points)
+{
+    const Vertex first = add_vertices((Size)points.size());
+    std::copy(points.begin(), points.end(), vpoint_.vector().begin() + first.idx());
+    return first;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
 SurfaceMesh::Halfedge
 SurfaceMesh::
 find_halfedge(Vertex start, Vertex end) const
@@ -342,6 +686,49 @@ add_triangle(Vertex v0, Vertex v1, Vertex v2)
 //-----------------------------------------------------------------------------
 
 
+Size
+SurfaceMesh::
+add_faces(const std::vector<unsigned int>& face_sizes,
+          const std::vector<Size>& indices)
+{
+    size_t n_indices = 0;
+    for (size_t f=0; f<face_sizes.size(); ++f)
+        n_indices += face_sizes[f];
+    if (n_indices != indices.size())
+    {
+        std::cerr << "[SurfaceMesh] add_faces: face sizes do not match the number of indices\n";
+        return 0;
+    }
+    for (size_t c=0; c<indices.size(); ++c)
+    {
+        if (indices[c] >= vertices_size())
+        {
+            std::cerr << "[SurfaceMesh] add_faces: vertex index " << indices[c] << " out of range\n";
+            return 0;
+        }
+    }
+
+    // a closed mesh has one edge per two corners
+    reserve(vertices_size(), edges_size() + (Size)(indices.size()/2),
+            faces_size() + (Size)face_sizes.size());
+
+    Size n_added = 0;
+    std::vector<Vertex> vertices;
+    for (size_t f=0, c=0; f<face_sizes.size(); c+=face_sizes[f++])
+    {
+        vertices.resize(face_sizes[f]);
+        for (size_t i=0; i<face_sizes[f]; ++i)
+            vertices[i] = Vertex(indices[c+i]);
+        if (face_sizes[f] > 2 && add_face(vertices).is_valid())
+            ++n_added;
+    }
+    return n_added;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
 SurfaceMesh::Face
 SurfaceMesh::
 add_quad(Vertex v0, Vertex v1, Vertex v2, Vertex v3)
@@ -552,6 +939,360 @@ add_face(const std::vector<Vertex>& vertices)
 }
 
 
+
+//-----------------------------------------------------------------------------
+
+
+bool
+SurfaceMesh::
+build_from_indices(const std::vector<Vec3>& points,
+                   const std::vector<unsigned int>& face_sizes,
+                   const std::vector<Size>& indices,
+                   std::vector<Index>* rejected_faces,
+                   unsigned int n_threads)
+{
+    clear();
+    if (rejected_faces) rejected_faces->clear();
+
+    const Index nV = (Index) points.size();
+    const Index nF = (Index) face_sizes.size();
+    const Index nC = (Index) indices.size();
+
+
+    // check input, compute the first corner of every face
+    std::vector<Index> offset(nF+1, 0);
+    for (Index f=0; f<nF; ++f)
+    {
+        if (face_sizes[f] < 3)
+        {
+            std::cerr << "[SurfaceMesh] build_from_indices: face " << f << " has less than 3 vertices\n";
+            return false;
+        }
+        offset[f+1] = offset[f] + face_sizes[f];
+    }
+    if (offset[nF] != nC)
+    {
+        std::cerr << "[SurfaceMesh] build_from_indices: face sizes do not match the number of indices\n";
+        return false;
+    }
+    for (Index c=0; c<nC; ++c)
+    {
+        if (indices[c] >= (Size)nV)
+        {
+            std::cerr << "[SurfaceMesh] build_from_indices: vertex index " << indices[c] << " out of range\n";
+            return false;
+        }
+    }
+
+
+    // corner c is the halfedge from vertex indices[c] to vertex indices[cnext[c]]
+    std::vector<Index> cface(nC), cnext(nC), cprev(nC);
+    std::vector<char> rejected(nF, 0);
+    parallel_for_chunks(0, nF, [&](Index begin, Index end)
+    {
+        for (Index f=begin; f<end; ++f)
+        {
+            const Index first = offset[f], last = offset[f+1]-1;
+            for (Index c=first; c<=last; ++c)
+            {
+                cface[c] = f;
+                cnext[c] = (c==last)  ? first : c+1;
+                cprev[c] = (c==first) ? last  : c-1;
+            }
+
+            // faces with a repeated vertex cannot be represented
+            for (Index c=first; c<=last && !rejected[f]; ++c)
+                for (Index d=c+1; d<=last; ++d)
+                    if (indices[c] == indices[d]) { rejected[f] = 1; break; }
+        }
+    }, n_threads);
+
+
+    std::vector<Index> twin(nC), hid(nC), fid(nF), face_input;
+    std::vector<Index> bucket(nV+1);
+    // an entry of the sorted corners: the larger vertex of the edge, then
+    // 2*corner + whether the corner starts at the smaller vertex
+    struct Corner_key
+    {
+        Size vertex, corner;
+        bool operator<(const Corner_key& k) const
+        {
+            return vertex < k.vertex || (vertex == k.vertex && corner < k.corner);
+        }
+    };
+    std::vector<Corner_key> sorted;
+    Index n_edges = 0, n_faces = 0;
+
+    // faces rejected at complex vertices (see the end of the loop) require to
+    // match the edges again, this only happens for bad input
+    for (;;)
+    {
+        // bucket the corners by their smaller vertex (counting sort) and sort each
+        // (small) bucket by (larger vertex, corner): corners on the same edge become
+        // adjacent in input order. An entry packs the larger vertex, the corner and
+        // whether the corner starts at the smaller vertex (see Corner_key).
+        std::fill(bucket.begin(), bucket.end(), 0);
+        for (Index c=0; c<nC; ++c)
+            if (!rejected[cface[c]])
+                ++bucket[std::min(indices[c], indices[cnext[c]]) + 1];
+        for (Index v=0; v<nV; ++v)
+            bucket[v+1] += bucket[v];
+        const Index n_sorted = bucket[nV];
+        sorted.resize(n_sorted);
+        {
+            std::vector<Index> fill(bucket.begin(), bucket.end()-1);
+            for (Index c=0; c<nC; ++c)
+            {
+                if (rejected[cface[c]]) continue;
+                const Size a = indices[c], b = indices[cnext[c]];
+                const Corner_key key = { std::max(a,b), (Size(c) << 1) | Size(a<b) };
+                sorted[fill[std::min(a,b)]++] = key;
+            }
+        }
+        parallel_for_chunks(0, nV, [&](Index begin, Index end)
+        {
+            for (Index v=begin; v<end; ++v)
+                std::sort(sorted.begin()+bucket[v], sorted.begin()+bucket[v+1]);
+        }, n_threads);
+
+        auto corner = [&](Index i) { return Index(sorted[i].corner >> 1); };
+        // the corners in sorted[i,end) share an edge
+        auto group_end = [&](Index i, Index end)
+        {
+            Index j = i+1;
+            while (j<end && sorted[j].vertex == sorted[i].vertex) ++j;
+            return j;
+        };
+
+
+        // number the edges (groups of corners) and resolve the conflicts in input
+        // order, as add_face() would: a face is kept if none of its edges already
+        // has a kept corner with the same orientation (bit 1: from the smaller vertex)
+        std::vector<Index> cedge(nC, -1);
+        Index n_groups = 0;
+        for (Index v=0; v<nV; ++v)
+        {
+            for (Index i=bucket[v], j; i<bucket[v+1]; i=j, ++n_groups)
+            {
+                j = group_end(i, bucket[v+1]);
+                for (Index k=i; k<j; ++k) cedge[corner(k)] = n_groups;
+            }
+        }
+        std::vector<char> used(n_groups, 0);
+        for (Index f=0; f<nF; ++f)
+        {
+            if (rejected[f]) continue;
+            bool ok = true;
+            for (Index c=offset[f]; c<offset[f+1] && ok; ++c)
+                ok = !(used[cedge[c]] & (indices[c] < indices[cnext[c]] ? 1 : 2));
+            if (!ok) { rejected[f] = 1; continue; }
+            for (Index c=offset[f]; c<offset[f+1]; ++c)
+                used[cedge[c]] |= (indices[c] < indices[cnext[c]] ? 1 : 2);
+        }
+
+        // match the corners of the remaining faces
+        parallel_for_chunks(0, nV, [&](Index begin, Index end)
+        {
+            for (Index v=begin; v<end; ++v)
+            {
+                for (Index i=bucket[v], j; i<bucket[v+1]; i=j)
+                {
+                    j = group_end(i, bucket[v+1]);
+                    Index c0 = -1, c1 = -1;
+                    for (Index k=i; k<j; ++k)
+                    {
+                        const Index c = corner(k);
+                        if (rejected[cface[c]]) continue;
+                        if (c0 < 0) c0 = c; else c1 = c;
+                    }
+                    if (c0 >= 0) twin[c0] = c1;
+                    if (c1 >= 0) twin[c1] = c0;
+                }
+            }
+        }, n_threads);
+
+
+        // number edges by their first corner, halfedge 2e+1 of a boundary edge is the boundary halfedge
+        n_edges = n_faces = 0;
+        face_input.clear();
+        for (Index f=0; f<nF; ++f)
+        {
+            if (rejected[f]) continue;
+            fid[f] = n_faces++;
+            face_input.push_back(f);
+            for (Index c=offset[f]; c<offset[f+1]; ++c)
+            {
+                if (twin[c] < 0 || c < twin[c])
+                {
+                    hid[c] = 2*n_edges;
+                    if (twin[c] >= 0) hid[twin[c]] = 2*n_edges+1;
+                    ++n_edges;
+                }
+            }
+        }
+
+
+        // allocate all elements at once
+        vprops_.resize(0);
+        hprops_.resize(0);
+        eprops_.resize(0);
+        fprops_.resize(0);
+        vprops_.resize(nV);
+        hprops_.resize(2*n_edges);
+        eprops_.resize(n_edges);
+        fprops_.resize(n_faces);
+        vpoint_.vector().assign(points.begin(), points.end());
+
+
+        // interior halfedges and faces
+        parallel_for_chunks(0, nF, [&](Index begin, Index end)
+        {
+            for (Index f=begin; f<end; ++f)
+            {
+                if (rejected[f]) continue;
+                fconn_[Face(fid[f])].halfedge_ = Halfedge(hid[offset[f]]);
+                for (Index c=offset[f]; c<offset[f+1]; ++c)
+                {
+                    Halfedge_connectivity& hc = hconn_[Halfedge(hid[c])];
+                    hc.vertex_        = Vertex(indices[cnext[c]]);
+                    hc.face_          = Face(fid[f]);
+                    hc.next_halfedge_ = Halfedge(hid[cnext[c]]);
+                    hc.prev_halfedge_ = Halfedge(hid[cprev[c]]);
+                }
+            }
+        }, n_threads);
+
+
+        // boundary halfedges: (target vertex, boundary halfedge, outgoing boundary halfedge of its fan)
+        std::vector< std::pair<Index, std::pair<Index,Index> > > fans;
+        for (Index c=0; c<nC; ++c)
+        {
+            if (rejected[cface[c]] || twin[c] >= 0) continue;
+            Halfedge b(hid[c] ^ 1);
+            hconn_[b].vertex_ = Vertex(indices[c]);
+
+            // rotate counter-clockwise around indices[c] until the fan ends
+            Halfedge x(hid[c]);
+            Halfedge y = ccw_rotated_halfedge(x);
+            while (!is_boundary(y))
+            {
+                x = y;
+                y = ccw_rotated_halfedge(x);
+            }
+            fans.push_back(std::make_pair((Index)indices[c], std::make_pair(b.idx(), y.idx())));
+        }
+
+        // link the fans around each vertex into a single cycle
+        std::sort(fans.begin(), fans.end());
+        for (size_t i=0; i<fans.size(); )
+        {
+            size_t j = i+1;
+            while (j<fans.size() && fans[j].first == fans[i].first) ++j;
+            for (size_t k=i; k<j; ++k)
+            {
+                size_t kk = (k+1 < j) ? k+1 : i;
+                set_next_halfedge(Halfedge(fans[k].second.first), Halfedge(fans[kk].second.second));
+            }
+            i = j;
+        }
+
+
+        // outgoing halfedges, boundary ones take precedence
+        for (Index c=0; c<nC; ++c)
+            if (!rejected[cface[c]])
+                vconn_[Vertex(indices[c])].halfedge_ = Halfedge(hid[c]);
+        for (size_t i=0; i<fans.size(); ++i)
+        {
+            Halfedge out(fans[i].second.second);
+            vconn_[to_vertex(opposite_halfedge(out))].halfedge_ = out;
+        }
+
+
+        // a vertex with a closed fan and other faces cannot be circulated completely (complex vertex)
+        std::vector<char> reached(2*n_edges, 0);
+        parallel_for_chunks(0, nV, [&](Index begin, Index end)
+        {
+            for (Index v=begin; v<end; ++v)
+            {
+                Halfedge h = halfedge(Vertex(v)), hend = h;
+                if (h.is_valid()) do
+                {
+                    reached[h.idx()] = 1;
+                    h = cw_rotated_halfedge(h);
+                }
+                while (h != hend);
+            }
+        }, n_threads);
+
+        std::vector< std::pair<Index,Index> > unreached; // (vertex, corner)
+        for (Index c=0; c<nC; ++c)
+            if (!rejected[cface[c]] && !reached[hid[c]])
+                unreached.push_back(std::make_pair((Index)indices[c], c));
+        if (unreached.empty()) break;
+
+        // at such a vertex only the fan(s) holding the first input face are kept,
+        // the faces of the other fans are rejected (as add_face() would do)
+        std::sort(unreached.begin(), unreached.end());
+        for (size_t i=0; i<unreached.size(); )
+        {
+            size_t j = i+1;
+            while (j<unreached.size() && unreached[j].first == unreached[i].first) ++j;
+
+            // group 0: the faces reached from the vertex, then one group per closed fan
+            std::vector< std::vector<Index> > groups(1);
+            Halfedge h = halfedge(Vertex(unreached[i].first)), hend = h;
+            do
+            {
+                if (!is_boundary(h)) groups[0].push_back(face_input[face(h).idx()]);
+                h = cw_rotated_halfedge(h);
+            }
+            while (h != hend);
+            for (size_t k=i; k<j; ++k)
+            {
+                h = hend = Halfedge(hid[unreached[k].second]);
+                if (!reached[h.idx()]) groups.push_back(std::vector<Index>());
+                while (!reached[h.idx()])
+                {
+                    reached[h.idx()] = 1;
+                    groups.back().push_back(face_input[face(h).idx()]);
+                    h = cw_rotated_halfedge(h);
+                }
+            }
+
+            size_t best = 0;
+            std::vector<Index> first(groups.size());
+            for (size_t g=0; g<groups.size(); ++g)
+            {
+                first[g] = groups[g].empty() ? nF : *std::min_element(groups[g].begin(), groups[g].end());
+                if (first[g] < first[best]) best = g;
+            }
+            for (size_t g=0; g<groups.size(); ++g)
+                if (g != best)
+                    for (size_t k=0; k<groups[g].size(); ++k)
+                        rejected[groups[g][k]] = 1;
+            i = j;
+        }
+    }
+
+
+    Index n_rejected = 0;
+    for (Index f=0; f<nF; ++f)
+    {
+        if (!rejected[f]) continue;
+        if (rejected_faces) rejected_faces->push_back(f);
+        ++n_rejected;
+    }
+    if (n_rejected > 0)
+        std::cerr << "[SurfaceMesh] build_from_indices: skipped " << n_rejected
+                  << " degenerate or non-manifold faces\n";
+
+    // the connectivity was written directly
+    topology_rebuilt();
+
+    return true;
+}
+
+
 //-----------------------------------------------------------------------------
 
 
@@ -700,10 +1441,7 @@ update_face_normals()
     if (!fnormal_)
         fnormal_ = face_property<Vec3>("f:normal");
 
-    Face_iterator fit, fend=faces_end();
-
-    for (fit=faces_begin(); fit!=fend; ++fit)
-        fnormal_[*fit] = compute_face_normal(*fit);
+    SurfaceMeshNormals::update_face_normals(*this);
 }
 
 
@@ -758,10 +1496,7 @@ update_vertex_normals()
     if (!vnormal_)
         vnormal_ = vertex_property<Vec3>("v:normal");
 
-    Vertex_iterator vit, vend=vertices_end();
-
-    for (vit=vertices_begin(); vit!=vend; ++vit)
-        vnormal_[*vit] = compute_vertex_normal(*vit);
+    SurfaceMeshNormals::update_vertex_normals(*this);
 }
 
 
@@ -1267,6 +2002,125 @@ collapse(Halfedge h)
 //-----------------------------------------------------------------------------
 
 
+SurfaceMesh::Halfedge
+SurfaceMesh::
+vertex_split(Vertex v0, Vertex v1, Vertex vl, Vertex vr)
+{
+    // check everything before changing anything
+    const Index nV = vertices_size();
+    auto in_range = [nV](Vertex v) { return v.is_valid() && v.idx() < nV; };
+    if (!in_range(v0) || !in_range(v1) || v0 == v1 || !is_isolated(v0) || is_isolated(v1) || vdeleted_[v1])
+        return Halfedge();
+    if (!vl.is_valid() && !vr.is_valid())
+        return Halfedge();
+    if (vl.is_valid() ? (!in_range(vl) || !find_halfedge(v1, vl).is_valid()) : !is_boundary(v1))
+        return Halfedge();
+    if (vr.is_valid() ? (!in_range(vr) || !find_halfedge(vr, v1).is_valid()) : !is_boundary(v1))
+        return Halfedge();
+
+    // the vertex removed by a collapse comes back
+    if (vdeleted_[v0])
+    {
+        journal(vdeleted_, v0.idx());
+        vdeleted_[v0] = false;
+        --deleted_vertices_;
+    }
+
+    // the two triangles of the new edge, as loops next to (v1,vl) and (vr,v1)
+    Halfedge vlv1, vrv1;
+    if (vl.is_valid())
+    {
+        Halfedge v1vl = find_halfedge(v1, vl);
+        vlv1 = insert_loop(v1vl);
+    }
+    if (vr.is_valid())
+    {
+        vrv1 = find_halfedge(vr, v1);
+        insert_loop(vrv1);
+    }
+
+    // on the boundary the fan ends at the boundary halfedge into v1
+    if (!vl.is_valid()) vlv1 = prev_halfedge(halfedge(v1));
+    if (!vr.is_valid()) vrv1 = prev_halfedge(halfedge(v1));
+
+
+    // split v1: the fan from vrv1 to vlv1 moves to v0
+    Halfedge v0v1 = new_edge(v0, v1);
+    Halfedge v1v0 = opposite_halfedge(v0v1);
+
+    set_halfedge(v0, v0v1);
+    set_halfedge(v1, v1v0);
+
+    set_next_halfedge(v0v1, next_halfedge(vlv1));
+    set_next_halfedge(vlv1, v0v1);
+    set_next_halfedge(v1v0, next_halfedge(vrv1));
+    set_next_halfedge(vrv1, v1v0);
+
+    Halfedge h = v0v1;
+    do
+    {
+        set_vertex(opposite_halfedge(h), v0);
+        h = cw_rotated_halfedge(h);
+    }
+    while (h != v0v1);
+
+    set_face(v0v1, face(vlv1));
+    set_face(v1v0, face(vrv1));
+
+    if (face(v0v1).is_valid()) set_halfedge(face(v0v1), v0v1);
+    if (face(v1v0).is_valid()) set_halfedge(face(v1v0), v1v0);
+
+    adjust_outgoing_halfedge(v0);
+    adjust_outgoing_halfedge(v1);
+
+    return v0v1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+SurfaceMesh::Halfedge
+SurfaceMesh::
+insert_loop(Halfedge h0)
+{
+    Halfedge o0 = opposite_halfedge(h0);
+
+    Vertex   v0 = to_vertex(o0);
+    Vertex   v1 = to_vertex(h0);
+
+    Halfedge h1 = new_edge(v1, v0);
+    Halfedge o1 = opposite_halfedge(h1);
+
+    Face     f0 = face(h0);
+    Face     f1 = new_face();
+
+    // halfedge -> halfedge
+    set_next_halfedge(prev_halfedge(h0), o1);
+    set_next_halfedge(o1, next_halfedge(h0));
+    set_next_halfedge(h1, h0);
+    set_next_halfedge(h0, h1);
+
+    // halfedge -> face
+    set_face(o1, f0);
+    set_face(h0, f1);
+    set_face(h1, f1);
+
+    // face -> halfedge
+    set_halfedge(f1, h0);
+    if (f0.is_valid()) set_halfedge(f0, o1);
+
+    // vertex -> halfedge
+    adjust_outgoing_halfedge(v0);
+    adjust_outgoing_halfedge(v1);
+
+    return h1;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
 void
 SurfaceMesh::
 remove_edge(Halfedge h)
@@ -1315,6 +2169,8 @@ remove_edge(Halfedge h)
     // delete stuff
     if (!vdeleted_) vdeleted_ = vertex_property<bool>("v:deleted", false);
     if (!edeleted_) edeleted_ = edge_property<bool>("e:deleted", false);
+    journal(vdeleted_, vo.idx());
+    journal(edeleted_, edge(h).idx());
     vdeleted_[vo]      = true; ++deleted_vertices_;
     edeleted_[edge(h)] = true; ++deleted_edges_;
     garbage_ = true;
@@ -1368,7 +2224,8 @@ remove_loop(Halfedge h)
     // delete stuff
     if (!edeleted_) edeleted_ = edge_property<bool>("e:deleted", false);
     if (!fdeleted_) fdeleted_ = face_property<bool>("f:deleted", false);
-    if (fh.is_valid()) { fdeleted_[fh] = true; ++deleted_faces_; }
+    if (fh.is_valid()) { journal(fdeleted_, fh.idx()); fdeleted_[fh] = true; ++deleted_faces_; topology_changed(fh); }
+    journal(edeleted_, edge(h0).idx());
     edeleted_[edge(h0)] = true; ++deleted_edges_;
     garbage_ = true;
 }
@@ -1403,9 +2260,11 @@ delete_vertex(Vertex v)
     for (; fit != fend; ++fit)
         delete_face(*fit);
 
+    journal(vdeleted_, v.idx());
     vdeleted_[v] = true;
     deleted_vertices_++;
     garbage_ = true;
+    topology_changed();
 }
 
 
@@ -1437,8 +2296,10 @@ delete_face(Face f)
     // mark face deleted
     if (!fdeleted_[f])
     {
+        journal(fdeleted_, f.idx());
         fdeleted_[f] = true;
         deleted_faces_++;
+        topology_changed(f);
     }
 
     // boundary edges of face f to be deleted
@@ -1499,6 +2360,7 @@ delete_face(Face f)
             // mark edge deleted
             if (!edeleted_[*del_it])
             {
+                journal(edeleted_, del_it->idx());
                 edeleted_[*del_it] = true;
                 deleted_edges_++;
             }
@@ -1510,6 +2372,7 @@ delete_face(Face f)
                 {
                     if (!vdeleted_[v0])
                     {
+                        journal(vdeleted_, v0.idx());
                         vdeleted_[v0] = true;
                         deleted_vertices_++;
                     }
@@ -1524,6 +2387,7 @@ delete_face(Face f)
                 {
                     if (!vdeleted_[v1])
                     {
+                        journal(vdeleted_, v1.idx());
                         vdeleted_[v1] = true;
                         deleted_vertices_++;
                     }
@@ -1549,140 +2413,203 @@ delete_face(Face f)
 
 void
 SurfaceMesh::
-garbage_collection()
+garbage_collection(Garbage_collection_map* map, unsigned int n_threads)
 {
-    int  i, i0, i1,
-    nV(vertices_size()),
-    nE(edges_size()),
-    nH(halfedges_size()),
-    nF(faces_size());
+    const Index nV(vertices_size()), nE(edges_size()), nF(faces_size());
 
-    Vertex    v;
-    Halfedge  h;
-    Face      f;
 
+    // stable compaction: kept elements in order, old -> new index (-1 if removed)
+    auto compaction_map = [](const Property<bool>::vector_type& deleted, std::vector<Index>& kept, std::vector<Index>& remap)
+    {
+        const size_t n = deleted.size();
+        kept.clear();
+        kept.reserve(n - deleted.count());
+        remap.assign(n, -1);
+        for (size_t i=deleted.find_next(0, false); i<n; i=deleted.find_next(i+1, false))
+        {
+            remap[i] = (Index)kept.size();
+            kept.push_back((Index)i);
+        }
+    };
+
+    std::vector<Index> vkept, ekept, fkept, hkept, vmap, emap, fmap;
+    compaction_map(vdeleted_.vector(), vkept, vmap);
+    compaction_map(edeleted_.vector(), ekept, emap);
+    compaction_map(fdeleted_.vector(), fkept, fmap);
+    hkept.resize(2*ekept.size());
+    for (size_t i=0; i<ekept.size(); ++i)
+    {
+        hkept[2*i]   = 2*ekept[i];
+        hkept[2*i+1] = 2*ekept[i]+1;
+    }
 
-    // setup handle mapping
-    Vertex_property<Vertex>      vmap = add_vertex_property<Vertex>("v:garbage-collection");
-    Halfedge_property<Halfedge>  hmap = add_halfedge_property<Halfedge>("h:garbage-collection");
-    Face_property<Face>          fmap = add_face_property<Face>("f:garbage-collection");
-    for (i=0; i<nV; ++i)
-        vmap[Vertex(i)] = Vertex(i);
-    for (i=0; i<nH; ++i)
-        hmap[Halfedge(i)] = Halfedge(i);
-    for (i=0; i<nF; ++i)
-        fmap[Face(i)] = Face(i);
 
+    // move the property arrays (connectivity included)
+    if ((Index)vkept.size() != nV) vprops_.compact(vkept, n_threads);
+    if ((Index)ekept.size() != nE) eprops_.compact(ekept, n_threads);
+    if ((Index)hkept.size() != 2*nE) hprops_.compact(hkept, n_threads);
+    if ((Index)fkept.size() != nF) fprops_.compact(fkept, n_threads);
 
 
-    // remove deleted vertices
-    if (nV > 0)
+    // update the handles stored in the connectivity
+    auto hmap = [&emap](Halfedge h)
     {
-        i0=0;  i1=nV-1;
+        return (h.is_valid() && emap[h.idx() >> 1] >= 0) ? Halfedge(2*emap[h.idx() >> 1] + (h.idx() & 1)) : Halfedge();
+    };
 
-        while (1)
+    parallel_for_chunks(0, (Index)vkept.size(), [&](Index begin, Index end){
+        for (Index i=begin; i<end; ++i)
         {
-            // find first deleted and last un-deleted
-            while (!vdeleted_[Vertex(i0)] && i0 < i1)  ++i0;
-            while ( vdeleted_[Vertex(i1)] && i0 < i1)  --i1;
-            if (i0 >= i1) break;
+            Vertex_connectivity& vc = vconn_[Vertex(i)];
+            vc.halfedge_ = hmap(vc.halfedge_);
+        }
+    }, n_threads);
 
-            // swap
-            vprops_.swap(i0, i1);
-        };
+    parallel_for_chunks(0, (Index)hkept.size(), [&](Index begin, Index end){
+        for (Index i=begin; i<end; ++i)
+        {
+            Halfedge_connectivity& hc = hconn_[Halfedge(i)];
+            if (hc.vertex_.is_valid()) hc.vertex_ = Vertex(vmap[hc.vertex_.idx()]);
+            if (hc.face_.is_valid())   hc.face_   = Face(fmap[hc.face_.idx()]);
+            hc.next_halfedge_ = hmap(hc.next_halfedge_);
+            hc.prev_halfedge_ = hmap(hc.prev_halfedge_);
+        }
+    }, n_threads);
 
-        // remember new size
-        nV = vdeleted_[Vertex(i0)] ? i0 : i0+1;
-    }
+    parallel_for_chunks(0, (Index)fkept.size(), [&](Index begin, Index end){
+        for (Index i=begin; i<end; ++i)
+        {
+            Face_connectivity& fc = fconn_[Face(i)];
+            fc.halfedge_ = hmap(fc.halfedge_);
+        }
+    }, n_threads);
 
 
-    // remove deleted edges
-    if (nE > 0)
+    // export the maps
+    if (map)
     {
-        i0=0;  i1=nE-1;
-
-        while (1)
+        map->vertices.resize(nV);
+        map->edges.resize(nE);
+        map->halfedges.resize(2*nE);
+        map->faces.resize(nF);
+        for (Index i=0; i<nV; ++i)
+            map->vertices[i] = (vmap[i] >= 0) ? Vertex(vmap[i]) : Vertex();
+        for (Index i=0; i<nE; ++i)
         {
-            // find first deleted and last un-deleted
-            while (!edeleted_[Edge(i0)] && i0 < i1)  ++i0;
-            while ( edeleted_[Edge(i1)] && i0 < i1)  --i1;
-            if (i0 >= i1) break;
-
-            // swap
-            eprops_.swap(i0, i1);
-            hprops_.swap(2*i0,   2*i1);
-            hprops_.swap(2*i0+1, 2*i1+1);
-        };
-
-        // remember new size
-        nE = edeleted_[Edge(i0)] ? i0 : i0+1;
-        nH = 2*nE;
+            map->edges[i] = (emap[i] >= 0) ? Edge(emap[i]) : Edge();
+            map->halfedges[2*i]   = hmap(Halfedge(2*i));
+            map->halfedges[2*i+1] = hmap(Halfedge(2*i+1));
+        }
+        for (Index i=0; i<nF; ++i)
+            map->faces[i] = (fmap[i] >= 0) ? Face(fmap[i]) : Face();
     }
 
 
-    // remove deleted faces
-    if (nF > 0)
-    {
-        i0=0;  i1=nF-1;
+    // finally release the memory
+    vprops_.free_memory();
+    hprops_.free_memory();
+    eprops_.free_memory();
+    fprops_.free_memory();
 
-        while (1)
-        {
-            // find 1st deleted and last un-deleted
-            while (!fdeleted_[Face(i0)] && i0 < i1)  ++i0;
-            while ( fdeleted_[Face(i1)] && i0 < i1)  --i1;
-            if (i0 >= i1) break;
+    deleted_vertices_ = deleted_edges_ = deleted_faces_ = 0;
+    garbage_ = false;
+    topology_rebuilt();
+}
 
-            // swap
-            fprops_.swap(i0, i1);
-        };
 
-        // remember new size
-        nF = fdeleted_[Face(i0)] ? i0 : i0+1;
-    }
+//-----------------------------------------------------------------------------
 
 
-    // update vertex connectivity
-    for (i=0; i<nV; ++i)
+bool
+SurfaceMesh::
+permute(const std::vector<Index>& vertex_order,
+        const std::vector<Index>& face_order,
+        const std::vector<Index>& edge_order)
+{
+    const Index nV(vertices_size()), nE(edges_size()), nF(faces_size());
+
+    // inverts order into map (old index -> new index), identity if order is empty
+    auto invert = [](const std::vector<Index>& order, Index n, std::vector<Index>& map) -> bool
     {
-        v = Vertex(i);
-        if (!is_isolated(v))
-            set_halfedge(v, hmap[halfedge(v)]);
+        map.assign(n, -1);
+        if (order.empty())
+        {
+            for (Index i=0; i<n; ++i) map[i] = i;
+            return true;
+        }
+        if ((Index)order.size() != n) return false;
+        for (Index i=0; i<n; ++i)
+        {
+            if (order[i] < 0 || order[i] >= n || map[order[i]] != -1) return false;
+            map[order[i]] = i;
+        }
+        return true;
+    };
+
+    std::vector<Index> vmap, emap, fmap;
+    if (!invert(vertex_order, nV, vmap) ||
+        !invert(face_order, nF, fmap) ||
+        !invert(edge_order, nE, emap))
+    {
+        std::cerr << "[SurfaceMesh] permute: order is not a permutation of the elements\n";
+        return false;
     }
 
 
-    // update halfedge connectivity
-    for (i=0; i<nH; ++i)
+    // permute all property arrays (connectivity included)
+    if (!vertex_order.empty())
+        vprops_.permute(vertex_order);
+    if (!face_order.empty())
+        fprops_.permute(face_order);
+    if (!edge_order.empty())
     {
-        h = Halfedge(i);
-        set_vertex(h, vmap[to_vertex(h)]);
-        set_next_halfedge(h, hmap[next_halfedge(h)]);
-        if (!is_boundary(h))
-            set_face(h, fmap[face(h)]);
+        std::vector<Index> halfedge_order(2*nE);
+        for (Index i=0; i<nE; ++i)
+        {
+            halfedge_order[2*i]   = 2*edge_order[i];
+            halfedge_order[2*i+1] = 2*edge_order[i]+1;
+        }
+        eprops_.permute(edge_order);
+        hprops_.permute(halfedge_order);
     }
 
 
-    // update handles of faces
-    for (i=0; i<nF; ++i)
+    // update the handles stored in the connectivity
+    auto hmap = [&emap](Halfedge h)
     {
-        f = Face(i);
-        set_halfedge(f, hmap[halfedge(f)]);
-    }
+        return h.is_valid() ? Halfedge(2*emap[h.idx() >> 1] + (h.idx() & 1)) : h;
+    };
 
+    parallel_for_chunks(0, nV, [&](Index begin, Index end){
+        for (Index i=begin; i<end; ++i)
+        {
+            Vertex_connectivity& vc = vconn_[Vertex(i)];
+            vc.halfedge_ = hmap(vc.halfedge_);
+        }
+    });
 
-    // remove handle maps
-    remove_vertex_property(vmap);
-    remove_halfedge_property(hmap);
-    remove_face_property(fmap);
+    parallel_for_chunks(0, 2*nE, [&](Index begin, Index end){
+        for (Index i=begin; i<end; ++i)
+        {
+            Halfedge_connectivity& hc = hconn_[Halfedge(i)];
+            if (hc.vertex_.is_valid()) hc.vertex_ = Vertex(vmap[hc.vertex_.idx()]);
+            if (hc.face_.is_valid())   hc.face_   = Face(fmap[hc.face_.idx()]);
+            hc.next_halfedge_ = hmap(hc.next_halfedge_);
+            hc.prev_halfedge_ = hmap(hc.prev_halfedge_);
+        }
+    });
 
+    parallel_for_chunks(0, nF, [&](Index begin, Index end){
+        for (Index i=begin; i<end; ++i)
+        {
+            Face_connectivity& fc = fconn_[Face(i)];
+            fc.halfedge_ = hmap(fc.halfedge_);
+        }
+    });
 
-    // finally resize arrays
-    vprops_.resize(nV); vprops_.free_memory();
-    hprops_.resize(nH); hprops_.free_memory();
-    eprops_.resize(nE); eprops_.free_memory();
-    fprops_.resize(nF); fprops_.free_memory();
+    topology_rebuilt();
 
-    deleted_vertices_ = deleted_edges_ = deleted_faces_ = 0;
-    garbage_ = false;
+    return true;
 }
 
 
@@ -15,6 +15,9 @@
 #include <OpenGP/headeronly.h>
 #include <OpenGP/SurfaceMesh/internal/Global_properties.h>
 #include <OpenGP/SurfaceMesh/internal/properties.h>
+#include <OpenGP/SurfaceMesh/internal/triangle_buffer.h>
+#include <OpenGP/SurfaceMesh/internal/journal.h>
+#include <atomic>
 
 //=============================================================================
 namespace OpenGP {
@@ -34,10 +37,10 @@ public: //------------------------------------------------------ topology types
     public:
 
         /// constructor
-        explicit Base_handle(int _idx=-1) : idx_(_idx) {}
+        explicit Base_handle(Index _idx=-1) : idx_(_idx) {}
 
         /// Get the underlying index of this handle
-        int idx() const { return idx_; }
+        Index idx() const { return idx_; }
 
         /// reset handle to be invalid (index=-1)
         void reset() { idx_=-1; }
@@ -66,7 +69,7 @@ public: //------------------------------------------------------ topology types
         friend class Edge_iterator;
         friend class Face_iterator;
         friend class SurfaceMesh;
-        int idx_;
+        Index idx_;
     };
 
 
@@ -75,7 +78,7 @@ public: //------------------------------------------------------ topology types
     struct Vertex : public Base_handle
     {
         /// default constructor (with invalid index)
-        explicit Vertex(int _idx=-1) : Base_handle(_idx) {}
+        explicit Vertex(Index _idx=-1) : Base_handle(_idx) {}
         std::ostream& operator<<(std::ostream& os) const { return os << 'v' << idx(); }
     };
 
@@ -85,7 +88,7 @@ public: //------------------------------------------------------ topology types
     struct Halfedge : public Base_handle
     {
         /// default constructor (with invalid index)
-        explicit Halfedge(int _idx=-1) : Base_handle(_idx) {}
+        explicit Halfedge(Index _idx=-1) : Base_handle(_idx) {}
     };
 
 
@@ -94,7 +97,7 @@ public: //------------------------------------------------------ topology types
     struct Edge : public Base_handle
     {
         /// default constructor (with invalid index)
-        explicit Edge(int _idx=-1) : Base_handle(_idx) {}
+        explicit Edge(Index _idx=-1) : Base_handle(_idx) {}
     };
 
 
@@ -103,7 +106,7 @@ public: //------------------------------------------------------ topology types
     struct Face : public Base_handle
     {
         /// default constructor (with invalid index)
-        explicit Face(int _idx=-1) : Base_handle(_idx) {}
+        explicit Face(Index _idx=-1) : Base_handle(_idx) {}
     };
 
 
@@ -144,6 +147,17 @@ public: //-------------------------------------------------- connectivity types
     };
 
 
+    /// Old to new element indices, as returned by garbage_collection().
+    /// Removed elements map to invalid handles.
+    struct Garbage_collection_map
+    {
+        std::vector<Vertex>    vertices;
+        std::vector<Halfedge>  halfedges;
+        std::vector<Edge>      edges;
+        std::vector<Face>      faces;
+    };
+
+
 
 
 public: //------------------------------------------------------ property types
@@ -258,7 +272,7 @@ public: //------------------------------------------------------ iterator types
         /// Default constructor
         Vertex_iterator(Vertex v=Vertex(), const SurfaceMesh* m=NULL) : hnd_(v), mesh_(m)
         {
-            if (mesh_ && mesh_->garbage()) while (mesh_->is_valid(hnd_) && mesh_->is_deleted(hnd_)) ++hnd_.idx_;
+            if (mesh_ && mesh_->garbage()) hnd_.idx_ = mesh_->next_live_vertex(hnd_.idx_);
         }
 
         /// get the vertex the iterator refers to
@@ -281,7 +295,7 @@ public: //------------------------------------------------------ iterator types
         {
             ++hnd_.idx_;
             assert(mesh_);
-            while (mesh_->garbage() && mesh_->is_valid(hnd_) && mesh_->is_deleted(hnd_)) ++hnd_.idx_;
+            if (mesh_->garbage()) hnd_.idx_ = mesh_->next_live_vertex(hnd_.idx_);
             return *this;
         }
 
@@ -290,7 +304,7 @@ public: //------------------------------------------------------ iterator types
         {
             --hnd_.idx_;
             assert(mesh_);
-            while (mesh_->garbage() && mesh_->is_valid(hnd_) && mesh_->is_deleted(hnd_)) --hnd_.idx_;
+            if (mesh_->garbage()) hnd_.idx_ = mesh_->prev_live_vertex(hnd_.idx_);
             return *this;
         }
 
@@ -310,7 +324,7 @@ public: //------------------------------------------------------ iterator types
         /// Default constructor
         Halfedge_iterator(Halfedge h=Halfedge(), const SurfaceMesh* m=NULL) : hnd_(h), mesh_(m)
         {
-            if (mesh_ && mesh_->garbage()) while (mesh_->is_valid(hnd_) && mesh_->is_deleted(hnd_)) ++hnd_.idx_;
+            if (mesh_ && mesh_->garbage()) hnd_.idx_ = mesh_->next_live_halfedge(hnd_.idx_);
         }
 
         /// get the halfedge the iterator refers to
@@ -333,7 +347,7 @@ public: //------------------------------------------------------ iterator types
         {
             ++hnd_.idx_;
             assert(mesh_);
-            while (mesh_->garbage() && mesh_->is_valid(hnd_) && mesh_->is_deleted(hnd_)) ++hnd_.idx_;
+            if (mesh_->garbage()) hnd_.idx_ = mesh_->next_live_halfedge(hnd_.idx_);
             return *this;
         }
 
@@ -342,7 +356,7 @@ public: //------------------------------------------------------ iterator types
         {
             --hnd_.idx_;
             assert(mesh_);
-            while (mesh_->garbage() && mesh_->is_valid(hnd_) && mesh_->is_deleted(hnd_)) --hnd_.idx_;
+            if (mesh_->garbage()) hnd_.idx_ = mesh_->prev_live_halfedge(hnd_.idx_);
             return *this;
         }
 
@@ -362,7 +376,7 @@ public: //------------------------------------------------------ iterator types
         /// Default constructor
         Edge_iterator(Edge e=Edge(), const SurfaceMesh* m=NULL) : hnd_(e), mesh_(m)
         {
-            if (mesh_ && mesh_->garbage()) while (mesh_->is_valid(hnd_) && mesh_->is_deleted(hnd_)) ++hnd_.idx_;
+            if (mesh_ && mesh_->garbage()) hnd_.idx_ = mesh_->next_live_edge(hnd_.idx_);
         }
 
         /// get the edge the iterator refers to
@@ -385,7 +399,7 @@ public: //------------------------------------------------------ iterator types
         {
             ++hnd_.idx_;
             assert(mesh_);
-            while (mesh_->garbage() && mesh_->is_valid(hnd_) && mesh_->is_deleted(hnd_)) ++hnd_.idx_;
+            if (mesh_->garbage()) hnd_.idx_ = mesh_->next_live_edge(hnd_.idx_);
             return *this;
         }
 
@@ -394,7 +408,7 @@ public: //------------------------------------------------------ iterator types
         {
             --hnd_.idx_;
             assert(mesh_);
-            while (mesh_->garbage() && mesh_->is_valid(hnd_) && mesh_->is_deleted(hnd_)) --hnd_.idx_;
+            if (mesh_->garbage()) hnd_.idx_ = mesh_->prev_live_edge(hnd_.idx_);
             return *this;
         }
 
@@ -414,7 +428,7 @@ public: //------------------------------------------------------ iterator types
         /// Default constructor
         Face_iterator(Face f=Face(), const SurfaceMesh* m=NULL) : hnd_(f), mesh_(m)
         {
-            if (mesh_ && mesh_->garbage()) while (mesh_->is_valid(hnd_) && mesh_->is_deleted(hnd_)) ++hnd_.idx_;
+            if (mesh_ && mesh_->garbage()) hnd_.idx_ = mesh_->next_live_face(hnd_.idx_);
         }
 
         /// get the face the iterator refers to
@@ -437,7 +451,7 @@ public: //------------------------------------------------------ iterator types
         {
             ++hnd_.idx_;
             assert(mesh_);
-            while (mesh_->garbage() && mesh_->is_valid(hnd_) && mesh_->is_deleted(hnd_)) ++hnd_.idx_;
+            if (mesh_->garbage()) hnd_.idx_ = mesh_->next_live_face(hnd_.idx_);
             return *this;
         }
 
@@ -446,7 +460,7 @@ public: //------------------------------------------------------ iterator types
         {
             --hnd_.idx_;
             assert(mesh_);
-            while (mesh_->garbage() && mesh_->is_valid(hnd_) && mesh_->is_deleted(hnd_)) --hnd_.idx_;
+            if (mesh_->garbage()) hnd_.idx_ = mesh_->prev_live_face(hnd_.idx_);
             return *this;
         }
 
@@ -857,6 +871,122 @@ public: //---------------------------------------------------- circulator types
 
 
 
+public: //--------------------------------------------------- adjacency snapshot
+
+
+    /// contiguous range of handles, as stored in an Adjacency
+    template <class Handle>
+    class Handle_range
+    {
+    public:
+        Handle_range(const Handle* begin=NULL, const Handle* end=NULL) : begin_(begin), end_(end) {}
+        const Handle* begin() const { return begin_; }
+        const Handle* end()   const { return end_; }
+        Size size() const { return (Size) (end_ - begin_); }
+        bool empty() const { return begin_ == end_; }
+        const Handle& operator[](Size i) const { return begin_[i]; }
+    private:
+        const Handle* begin_;
+        const Handle* end_;
+    };
+
+
+    /** Read-only snapshot of the mesh adjacency in compressed sparse row
+     form, see build_adjacency(). The neighbors of an element are stored
+     contiguously, in the order of the corresponding circulator, so visiting
+     them is a linear scan. Topology changes do not update the snapshot:
+     is_valid() tells whether it still describes the mesh. */
+    class Adjacency
+    {
+    public:
+        /// the relations to build (or'ed together)
+        enum Relation
+        {
+            VERTEX_VERTEX = 1, ///< one-rings and outgoing halfedges
+            VERTEX_FACE   = 2, ///< faces incident to a vertex
+            FACE_FACE     = 4, ///< faces sharing an edge with a face
+            ALL           = 7
+        };
+
+        Adjacency() : mesh_(NULL), version_(0), relations_(0) {}
+
+        /// one-ring of \c v, in the order of SurfaceMesh::vertices(v)
+        Handle_range<Vertex> vertices(Vertex v) const
+        {
+            assert(has(VERTEX_VERTEX));
+            return range(vv_offset_, vv_vertex_, v.idx());
+        }
+
+        /// outgoing halfedges of \c v, in the same order as vertices(v)
+        Handle_range<Halfedge> halfedges(Vertex v) const
+        {
+            assert(has(VERTEX_VERTEX));
+            return range(vv_offset_, vv_halfedge_, v.idx());
+        }
+
+        /// number of neighbors of \c v
+        unsigned int valence(Vertex v) const
+        {
+            assert(has(VERTEX_VERTEX));
+            return (unsigned int) (vv_offset_[v.idx()+1] - vv_offset_[v.idx()]);
+        }
+
+        /// faces incident to \c v, in the order of SurfaceMesh::faces(v)
+        Handle_range<Face> faces(Vertex v) const
+        {
+            assert(has(VERTEX_FACE));
+            return range(vf_offset_, vf_face_, v.idx());
+        }
+
+        /// faces across the edges of \c f, in the order of
+        /// SurfaceMesh::halfedges(f) (boundary edges are skipped)
+        Handle_range<Face> faces(Face f) const
+        {
+            assert(has(FACE_FACE));
+            return range(ff_offset_, ff_face_, f.idx());
+        }
+
+        /// CSR offsets of a relation: the neighbors of element i are the
+        /// entries [offsets[i], offsets[i+1]) (one entry per element slot)
+        const std::vector<Index>& offsets(Relation r) const
+        {
+            assert(r == VERTEX_VERTEX || r == VERTEX_FACE || r == FACE_FACE);
+            return (r == VERTEX_VERTEX) ? vv_offset_ : ((r == VERTEX_FACE) ? vf_offset_ : ff_offset_);
+        }
+
+        /// whether relation \c r was built
+        bool has(Relation r) const { return (relations_ & r) == unsigned(r); }
+
+        /// whether the snapshot was built from \c mesh and its topology did not change since
+        bool is_valid(const SurfaceMesh& mesh) const
+        {
+            return mesh_ == &mesh && version_ == mesh.topology_version();
+        }
+
+    private:
+        friend class SurfaceMesh;
+
+        template <class Handle>
+        static Handle_range<Handle> range(const std::vector<Index>& offset, const std::vector<Handle>& items, Index i)
+        {
+            const Handle* first = items.empty() ? NULL : &items[0];
+            return Handle_range<Handle>(first + offset[i], first + offset[i+1]);
+        }
+
+        const SurfaceMesh*     mesh_;
+        size_t                 version_;
+        unsigned int           relations_;
+        std::vector<Index>     vv_offset_;
+        std::vector<Vertex>    vv_vertex_;
+        std::vector<Halfedge>  vv_halfedge_;
+        std::vector<Index>     vf_offset_;
+        std::vector<Face>      vf_face_;
+        std::vector<Index>     ff_offset_;
+        std::vector<Face>      ff_face_;
+    };
+
+
+
 public: //-------------------------------------------- constructor / destructor
 
     /// \name Construct, destruct, assignment
@@ -869,11 +999,20 @@ public: //-------------------------------------------- constructor / destructor
     HEADERONLY_INLINE virtual ~SurfaceMesh();
 
     /// copy constructor: copies \c rhs to \c *this. performs a deep copy of all properties.
-    SurfaceMesh(const SurfaceMesh& rhs) { operator=(rhs); }
+    SurfaceMesh(const SurfaceMesh& rhs) : topology_version_(0) { operator=(rhs); }
 
     /// assign \c rhs to \c *this. performs a deep copy of all properties.
     HEADERONLY_INLINE SurfaceMesh& operator=(const SurfaceMesh& rhs);
 
+    /** assign \c rhs to \c *this, sharing the custom properties copy-on-write
+     (see Property_container::share()): a property is only copied when either
+     mesh fetches it for writing with vertex_property() & co or changes its
+     size, get_vertex_property() & co give handles for reading. The
+     connectivity, positions and deletion flags are copied right away.
+     Handles of custom properties of either mesh obtained before must be
+     fetched again before writing through them. */
+    HEADERONLY_INLINE SurfaceMesh& share(const SurfaceMesh& rhs);
+
     /// assign \c rhs to \c *this. does not copy custom properties.
     HEADERONLY_INLINE SurfaceMesh& assign(const SurfaceMesh& rhs);
 
@@ -908,6 +1047,13 @@ public: //----------------------------------------------- add new vertex / face
     /// add a new vertex with position \c p
     HEADERONLY_INLINE Vertex add_vertex(const Vec3& p);
 
+    /// add \c n vertices at once (positions are left to the caller), returns
+    /// the first one, the others follow it
+    HEADERONLY_INLINE Vertex add_vertices(Size n);
+
+    /// add a vertex for every position in \c points, returns the first one
+    HEADERONLY_INLINE Vertex add_vertices(const std::vector<Vec3>& points);
+
     /// add a new face with vertex list \c vertices
     /// \sa add_triangle, add_quad
     HEADERONLY_INLINE Face add_face(const std::vector<Vertex>& vertices);
@@ -920,6 +1066,37 @@ public: //----------------------------------------------- add new vertex / face
     /// \sa add_triangle, add_face
     HEADERONLY_INLINE Face add_quad(Vertex v1, Vertex v2, Vertex v3, Vertex v4);
 
+    /** add faces given as an index buffer (face \c i has \c face_sizes[i]
+     vertices, stored one after the other in \c indices) to the existing
+     vertices. This is a convenience, not a bulk path: storage is reserved
+     once for all of them, then each face is added by add_face(), so it only
+     saves the reallocations. Returns the number of faces that were added.
+     For a mesh built from scratch, build_from_indices() is much faster.
+     \sa add_face, build_from_indices */
+    HEADERONLY_INLINE Size add_faces(const std::vector<unsigned int>& face_sizes,
+                                     const std::vector<Size>& indices);
+
+    /** Build the whole mesh at once from \c points and an index buffer: face
+     \c i has \c face_sizes[i] vertices, stored one after the other in \c indices.
+     Opposite halfedges are matched by bucketing the edges by vertex, which is
+     much faster than calling add_face() for every face (n_threads=0 uses all cores).
+     The mesh is cleared first; registered properties are kept (with default values).
+     Faces that cannot be added (repeated vertex, edge shared by more than two
+     faces or by two faces with the same orientation) are skipped, reported on
+     std::cerr and their input indices are returned in \c rejected_faces, so
+     the faces of the mesh are the remaining input faces, in order. Edge
+     conflicts are resolved as add_face() in input order would; at a complex
+     vertex (several closed fans) the fan holding the first input face is
+     kept, which can differ from what add_face() keeps.
+     Returns false (and leaves an empty mesh) if an index is out of range or
+     a face has fewer than three vertices.
+     \sa add_face */
+    HEADERONLY_INLINE bool build_from_indices(const std::vector<Vec3>& points,
+                                              const std::vector<unsigned int>& face_sizes,
+                                              const std::vector<Size>& indices,
+                                              std::vector<Index>* rejected_faces=NULL,
+                                              unsigned int n_threads=0);
+
     //@}
 
 
@@ -931,23 +1108,23 @@ public: //--------------------------------------------------- memory management
     //@{
 
     /// returns number of (deleted and valid) vertices in the mesh
-    unsigned int vertices_size() const { return (unsigned int) vprops_.size(); }
+    Size vertices_size() const { return (Size) vprops_.size(); }
     /// returns number of (deleted and valid)halfedge in the mesh
-    unsigned int halfedges_size() const { return (unsigned int) hprops_.size(); }
+    Size halfedges_size() const { return (Size) hprops_.size(); }
     /// returns number of (deleted and valid)edges in the mesh
-    unsigned int edges_size() const { return (unsigned int) eprops_.size(); }
+    Size edges_size() const { return (Size) eprops_.size(); }
     /// returns number of (deleted and valid)faces in the mesh
-    unsigned int faces_size() const { return (unsigned int) fprops_.size(); }
+    Size faces_size() const { return (Size) fprops_.size(); }
 
 
     /// returns number of vertices in the mesh
-    unsigned int n_vertices() const { return vertices_size() - deleted_vertices_; }
+    Size n_vertices() const { return vertices_size() - deleted_vertices_; }
     /// returns number of halfedge in the mesh
-    unsigned int n_halfedges() const { return halfedges_size() - 2*deleted_edges_; }
+    Size n_halfedges() const { return halfedges_size() - 2*deleted_edges_; }
     /// returns number of edges in the mesh
-    unsigned int n_edges() const { return edges_size() - deleted_edges_; }
+    Size n_edges() const { return edges_size() - deleted_edges_; }
     /// returns number of faces in the mesh
-    unsigned int n_faces() const { return faces_size() - deleted_faces_; }
+    Size n_faces() const { return faces_size() - deleted_faces_; }
 
 
     /// returns true iff the mesh is empty, i.e., has no vertices
@@ -961,13 +1138,39 @@ public: //--------------------------------------------------- memory management
     HEADERONLY_INLINE void free_memory();
 
     /// reserve memory (mainly used in file readers)
-    HEADERONLY_INLINE void reserve(unsigned int nvertices,
-                                   unsigned int nedges,
-                                   unsigned int nfaces );
-
-
-    /// remove deleted vertices/edges/faces
-    HEADERONLY_INLINE void garbage_collection();
+    HEADERONLY_INLINE void reserve(Size nvertices,
+                                   Size nedges,
+                                   Size nfaces );
+
+    /** Allocate the property arrays (existing ones and the ones added later)
+     from \c resource, e.g. an Arena_resource or a Huge_page_resource.
+     The resource is not owned by the mesh and has to outlive it; NULL
+     restores the default. Copies of the mesh share the arrays until they are
+     written, and with them the resource, which has to outlive the copies too. */
+    HEADERONLY_INLINE void set_memory_resource(Memory_resource* resource);
+
+    /// the memory resource of the property arrays
+    Memory_resource* memory_resource() const { return vprops_.resource(); }
+
+
+    /** Remove deleted vertices/edges/faces. The remaining elements keep their
+     relative order; every property array is compacted in a single pass (the
+     arrays are processed concurrently, n_threads=0 uses all cores). If \c map
+     is given it receives the old to new index of every element, e.g. to
+     update indices stored outside of the mesh. */
+    HEADERONLY_INLINE void garbage_collection(Garbage_collection_map* map=NULL,
+                                              unsigned int n_threads=0);
+
+    /** Reorder the elements of the mesh: vertex \c i becomes the former vertex
+     \c vertex_order[i] (same for faces and edges; the two halfedges of an edge
+     move with it). All property arrays are permuted in place and the
+     connectivity is updated. An empty order leaves that element type
+     unchanged. Returns false (and does nothing) if an order is not a
+     permutation of all (deleted and valid) elements.
+     \sa SurfaceMeshReorder */
+    HEADERONLY_INLINE bool permute(const std::vector<Index>& vertex_order,
+                                   const std::vector<Index>& face_order,
+                                   const std::vector<Index>& edge_order=std::vector<Index>());
 
 
     /// returns whether vertex \c v is deleted
@@ -999,22 +1202,22 @@ public: //--------------------------------------------------- memory management
     /// return whether vertex \c v is valid, i.e. the index is stores it within the array bounds.
     bool is_valid(Vertex v) const
     {
-        return (0 <= v.idx()) && (v.idx() < (int)vertices_size());
+        return (0 <= v.idx()) && (v.idx() < (Index)vertices_size());
     }
     /// return whether halfedge \c h is valid, i.e. the index is stores it within the array bounds.
     bool is_valid(Halfedge h) const
     {
-        return (0 <= h.idx()) && (h.idx() < (int)halfedges_size());
+        return (0 <= h.idx()) && (h.idx() < (Index)halfedges_size());
     }
     /// return whether edge \c e is valid, i.e. the index is stores it within the array bounds.
     bool is_valid(Edge e) const
     {
-        return (0 <= e.idx()) && (e.idx() < (int)edges_size());
+        return (0 <= e.idx()) && (e.idx() < (Index)edges_size());
     }
     /// return whether face \c f is valid, i.e. the index is stores it within the array bounds.
     bool is_valid(Face f) const
     {
-        return (0 <= f.idx()) && (f.idx() < (int)faces_size());
+        return (0 <= f.idx()) && (f.idx() < (Index)faces_size());
     }
 
     //@}
@@ -1037,7 +1240,9 @@ public: //---------------------------------------------- low-level connectivity
     /// set the outgoing halfedge of vertex \c v to \c h
     void set_halfedge(Vertex v, Halfedge h)
     {
+        journal(vconn_, v.idx());
         vconn_[v].halfedge_ = h;
+        topology_version_.store(0, std::memory_order_relaxed);
     }
 
     /// returns whether \c v is a boundary vertex
@@ -1084,7 +1289,9 @@ public: //---------------------------------------------- low-level connectivity
     /// sets the vertex the halfedge \c h points to to \c v
     void set_vertex(Halfedge h, Vertex v)
     {
+        journal(hconn_, h.idx());
         hconn_[h].vertex_ = v;
+        topology_changed(face(h));
     }
 
     /// returns the face incident to halfedge \c h
@@ -1096,7 +1303,10 @@ public: //---------------------------------------------- low-level connectivity
     /// sets the incident face to halfedge \c h to \c f
     void set_face(Halfedge h, Face f)
     {
+        topology_changed(face(h));
+        journal(hconn_, h.idx());
         hconn_[h].face_ = f;
+        topology_changed(f);
     }
 
     /// returns the next halfedge within the incident face
@@ -1108,8 +1318,12 @@ public: //---------------------------------------------- low-level connectivity
     /// sets the next halfedge of \c h within the face to \c nh
     void set_next_halfedge(Halfedge h, Halfedge nh)
     {
+        journal(hconn_, h.idx());
+        journal(hconn_, nh.idx());
         hconn_[h].next_halfedge_ = nh;
         hconn_[nh].prev_halfedge_ = h;
+        topology_changed(face(h));
+        topology_changed(face(nh));
     }
 
     /// returns the previous halfedge within the incident face
@@ -1189,7 +1403,9 @@ public: //---------------------------------------------- low-level connectivity
     /// sets the halfedge of face \c f to \c h
     void set_halfedge(Face f, Halfedge h)
     {
+        journal(fconn_, f.idx());
         fconn_[f].halfedge_ = h;
+        topology_changed(f);
     }
 
     /// returns whether \c f is a boundary face, i.e., it one of its edges is a boundary edge.
@@ -1245,6 +1461,26 @@ public: //--------------------------------------------------- property handling
     {
         return Face_property<T>(fprops_.add<T>(name, t));
     }
+    /// add a vertex property of type \c T under the (pre-resolved) key \c key, see above
+    template <class T> Vertex_property<T> add_vertex_property(const Property_key<T>& key, const T t=T())
+    {
+        return Vertex_property<T>(vprops_.add<T>(key, t));
+    }
+    /// add a halfedge property of type \c T under the (pre-resolved) key \c key, see above
+    template <class T> Halfedge_property<T> add_halfedge_property(const Property_key<T>& key, const T t=T())
+    {
+        return Halfedge_property<T>(hprops_.add<T>(key, t));
+    }
+    /// add a edge property of type \c T under the (pre-resolved) key \c key, see above
+    template <class T> Edge_property<T> add_edge_property(const Property_key<T>& key, const T t=T())
+    {
+        return Edge_property<T>(eprops_.add<T>(key, t));
+    }
+    /// add a face property of type \c T under the (pre-resolved) key \c key, see above
+    template <class T> Face_property<T> add_face_property(const Property_key<T>& key, const T t=T())
+    {
+        return Face_property<T>(fprops_.add<T>(key, t));
+    }
 
 
     /** get the vertex property named \c name of type \c T. returns an invalid
@@ -1271,6 +1507,26 @@ public: //--------------------------------------------------- property handling
     {
         return Face_property<T>(fprops_.get<T>(name));
     }
+    /// get the vertex property with key \c key in constant time, see above
+    template <class T> Vertex_property<T> get_vertex_property(const Property_key<T>& key) const
+    {
+        return Vertex_property<T>(vprops_.get<T>(key));
+    }
+    /// get the halfedge property with key \c key in constant time, see above
+    template <class T> Halfedge_property<T> get_halfedge_property(const Property_key<T>& key) const
+    {
+        return Halfedge_property<T>(hprops_.get<T>(key));
+    }
+    /// get the edge property with key \c key in constant time, see above
+    template <class T> Edge_property<T> get_edge_property(const Property_key<T>& key) const
+    {
+        return Edge_property<T>(eprops_.get<T>(key));
+    }
+    /// get the face property with key \c key in constant time, see above
+    template <class T> Face_property<T> get_face_property(const Property_key<T>& key) const
+    {
+        return Face_property<T>(fprops_.get<T>(key));
+    }
 
 
     /** if a vertex property of type \c T with name \c name exists, it is returned.
@@ -1297,26 +1553,50 @@ public: //--------------------------------------------------- property handling
     {
         return Face_property<T>(fprops_.get_or_add<T>(name, t));
     }
+    /// get or add the vertex property with key \c key, the lookup takes constant time
+    template <class T> Vertex_property<T> vertex_property(const Property_key<T>& key, const T t=T())
+    {
+        return Vertex_property<T>(vprops_.get_or_add<T>(key, t));
+    }
+    /// get or add the halfedge property with key \c key, the lookup takes constant time
+    template <class T> Halfedge_property<T> halfedge_property(const Property_key<T>& key, const T t=T())
+    {
+        return Halfedge_property<T>(hprops_.get_or_add<T>(key, t));
+    }
+    /// get or add the edge property with key \c key, the lookup takes constant time
+    template <class T> Edge_property<T> edge_property(const Property_key<T>& key, const T t=T())
+    {
+        return Edge_property<T>(eprops_.get_or_add<T>(key, t));
+    }
+    /// get or add the face property with key \c key, the lookup takes constant time
+    template <class T> Face_property<T> face_property(const Property_key<T>& key, const T t=T())
+    {
+        return Face_property<T>(fprops_.get_or_add<T>(key, t));
+    }
 
 
     /// remove the vertex property \c p
     template <class T> void remove_vertex_property(Vertex_property<T>& p)
     {
+        journal_.forget(p.parray_);
         vprops_.remove(p);
     }
     /// remove the halfedge property \c p
     template <class T> void remove_halfedge_property(Halfedge_property<T>& p)
     {
+        journal_.forget(p.parray_);
         hprops_.remove(p);
     }
     /// remove the edge property \c p
     template <class T> void remove_edge_property(Edge_property<T>& p)
     {
+        journal_.forget(p.parray_);
         eprops_.remove(p);
     }
     /// remove the face property \c p
     template <class T> void remove_face_property(Face_property<T>& p)
     {
+        journal_.forget(p.parray_);
         fprops_.remove(p);
     }
 
@@ -1367,8 +1647,155 @@ public: //--------------------------------------------------- property handling
     {
         return fprops_.properties();
     }
-    /// prints the names of all properties
+    /// prints the names of all properties and the number of property lookups
     HEADERONLY_INLINE void property_stats() const;
+    /// number of property lookups by name, these should not happen in loops
+    /// (use a Property_key or keep the property handle instead)
+    size_t n_property_name_lookups() const
+    {
+        return vprops_.n_name_lookups() + hprops_.n_name_lookups() +
+               eprops_.n_name_lookups() + fprops_.n_name_lookups();
+    }
+    /// number of property lookups by key
+    size_t n_property_key_lookups() const
+    {
+        return vprops_.n_key_lookups() + hprops_.n_key_lookups() +
+               eprops_.n_key_lookups() + fprops_.n_key_lookups();
+    }
+    /// reset the property lookup counters
+    void reset_property_lookup_counters()
+    {
+        vprops_.reset_lookup_counters();
+        hprops_.reset_lookup_counters();
+        eprops_.reset_lookup_counters();
+        fprops_.reset_lookup_counters();
+    }
+
+    //@}
+
+
+
+
+public: //----------------------------------------------- triangle index buffer
+
+    /// \name Triangle index buffer
+    //@{
+
+    /** Start (or stop) maintaining a contiguous triangle index buffer: face f
+     owns the indices [3f,3f+3), which are the vertices of f as circulated by
+     vertices(f). Deleted and non-triangular faces are stored as (0,0,0), a
+     degenerate triangle which draws nothing. Topology operations (add_face,
+     flip, split, collapse, ...) only mark the faces they modify, which are
+     indexed again by the next triangle_buffer(). */
+    void enable_triangle_buffer(bool enable=true) { tbuffer_.enable(enable); }
+
+    /// whether the triangle index buffer is maintained
+    bool has_triangle_buffer() const { return tbuffer_.enabled(); }
+
+    /// the triangle index buffer, up to date with the current topology.
+    /// \attention the buffer has to be enabled; not thread-safe.
+    HEADERONLY_INLINE const std::vector<uint32_t>& triangle_buffer() const;
+
+    /** Face ranges [begin,end) whose indices changed since the last
+     clear_triangle_buffer_dirty() (faces appended since then included),
+     e.g. the parts of a GPU index buffer that have to be uploaded again.
+     The dirty state is shared by all users of the mesh. */
+    HEADERONLY_INLINE std::vector< std::pair<Index,Index> > triangle_buffer_dirty_ranges() const;
+
+    /// marks the triangle buffer as seen by its consumer
+    void clear_triangle_buffer_dirty() const { tbuffer_.clear_dirty(); }
+
+    //@}
+
+
+
+
+public: //-------------------------------------------------- adjacency snapshots
+
+    /// \name Adjacency snapshots
+    //@{
+
+    /** Builds a compressed sparse row snapshot of the \c relations (see
+     Adjacency::Relation) in parallel (n_threads=0 uses all cores). Deleted
+     elements have no neighbors. Meant for read-only passes that circulate
+     a lot (smoothing, subdivision stencils, Laplacians). */
+    HEADERONLY_INLINE Adjacency build_adjacency(unsigned int relations=Adjacency::ALL,
+                                                unsigned int n_threads=0) const;
+
+    /// changes with every change of the connectivity, e.g. to check whether
+    /// data derived from it (like an Adjacency) is out of date. The versions
+    /// are drawn from a counter shared by all meshes, so a version never
+    /// repeats, not even for another mesh at the same address.
+    size_t topology_version() const
+    {
+        size_t version = topology_version_.load(std::memory_order_relaxed);
+        if (version == 0)
+        {
+            // first call since the last change, concurrent callers agree on one
+            const size_t next = next_topology_version();
+            if (topology_version_.compare_exchange_strong(version, next, std::memory_order_relaxed))
+                version = next;
+        }
+        return version;
+    }
+
+    //@}
+
+
+
+
+public: //--------------------------------------------------------- journal
+
+    /// \name Journal
+    //@{
+
+    /// state of the mesh to return to with rollback()
+    struct Checkpoint
+    {
+        size_t epoch;     ///< of the journal, checkpoints do not survive its clearing
+        size_t position;  ///< in the journal
+        Size   n_vertices, n_halfedges, n_edges, n_faces;
+        Size   deleted_vertices, deleted_edges, deleted_faces;
+        bool   garbage;
+    };
+
+    /** Start recording the changes of the mesh, to cheaply undo speculative
+     edits: c = checkpoint(), flip/split/collapse/insert_vertex/..., then
+     rollback(c) if the result is not wanted. Every connectivity write saves
+     the old value and new elements are appended, so both calls cost
+     O(edits) instead of a copy of the mesh. Writes to other properties are
+     recorded by calling journal_write() before them. Operations that move
+     or drop elements (garbage_collection, permute, clear, assignment) clear
+     the journal. */
+    void begin_journal() { journal_.enable(true); }
+
+    /// stop recording and forget the recorded changes
+    void end_journal() { journal_.enable(false); }
+
+    /// whether the changes are recorded
+    bool has_journal() const { return journal_.enabled(); }
+
+    /// forget the recorded changes (checkpoints become invalid), e.g. once
+    /// the edits are accepted, to bound the memory of the journal
+    void clear_journal() { journal_.clear(); }
+
+    /// the current state, the journal has to be enabled
+    HEADERONLY_INLINE Checkpoint checkpoint() const;
+
+    /** Undo the changes made since \c c: connectivity, deletions, the writes
+     recorded with journal_write(), elements added since are removed again.
+     Checkpoints taken after \c c must not be used anymore. Returns false
+     (and does nothing) if the journal was cleared since \c c. */
+    HEADERONLY_INLINE bool rollback(const Checkpoint& c);
+
+    /// record the value of \c p[v] (if journaling), to be restored by rollback()
+    template <class T> void journal_write(Vertex_property<T> p, Vertex v) { journal(p, v.idx()); }
+    /// record the value of \c p[h] (if journaling), to be restored by rollback()
+    template <class T> void journal_write(Halfedge_property<T> p, Halfedge h) { journal(p, h.idx()); }
+    /// record the value of \c p[e] (if journaling), to be restored by rollback()
+    template <class T> void journal_write(Edge_property<T> p, Edge e) { journal(p, e.idx()); }
+    /// record the value of \c p[f] (if journaling), to be restored by rollback()
+    template <class T> void journal_write(Face_property<T> p, Face f) { journal(p, f.idx()); }
 
     //@}
 
@@ -1527,6 +1954,18 @@ public: //--------------------------------------------- higher-level operations
      */
     HEADERONLY_INLINE void collapse(Halfedge h);
 
+    /** Inverse of collapse(): split vertex \c v1 into the edge (v0,v1), which
+     gets the faces (v0,v1,vl) and (v1,v0,vr). The edges of v1 between vl
+     and vr (counter-clockwise from vl) move to v0. vl or vr is invalid on
+     the boundary. \c v0 has to be an isolated vertex, e.g. new or the one
+     deleted by the collapse of the halfedge (v0,v1) (it is restored).
+     Returns the halfedge from v0 to v1, or an invalid halfedge (and leaves
+     the mesh unchanged) if v0 is not isolated, the edges (v1,vl) and
+     (vr,v1) do not exist, or vl or vr is invalid but v1 is not a boundary
+     vertex.
+     \attention This function is only valid for triangle meshes. */
+    HEADERONLY_INLINE Halfedge vertex_split(Vertex v0, Vertex v1, Vertex vl, Vertex vr);
+
 
     /** Split the face \c f by first adding point \c p to the mesh and then
      inserting edges between \c p and the vertices of \c f. For a triangle
@@ -1646,15 +2085,15 @@ public: //------------------------------------------ geometry-related functions
     Vec3& position(Vertex v) { return vpoint_[v]; }
 
     /// vector of vertex positions
-    std::vector<Vec3>& points() { return vpoint_.vector(); }
+    Vertex_property<Vec3>::vector_type& points() { return vpoint_.vector(); }
 
-    /// compute face normals by calling compute_face_normal(Face) for each face.
+    /// compute face normals for all faces in parallel (see SurfaceMeshNormals).
     HEADERONLY_INLINE void update_face_normals();
 
     /// compute normal vector of face \c f.
     HEADERONLY_INLINE Vec3 compute_face_normal(Face f) const;
 
-    /// compute vertex normals by calling compute_vertex_normal(Vertex) for each vertex.
+    /// compute angle-weighted vertex normals in parallel (see SurfaceMeshNormals).
     HEADERONLY_INLINE void update_vertex_normals();
 
     /// compute normal vector of vertex \c v.
@@ -1674,6 +2113,7 @@ private: //---------------------------------------------- allocate new elements
     Vertex new_vertex()
     {
         vprops_.push_back();
+        topology_changed();
         return Vertex(vertices_size()-1);
     }
 
@@ -1699,6 +2139,7 @@ private: //---------------------------------------------- allocate new elements
     Face new_face()
     {
         fprops_.push_back();
+        topology_changed();
         return Face(faces_size()-1);
     }
 
@@ -1707,6 +2148,60 @@ private: //---------------------------------------------- allocate new elements
 
 private: //--------------------------------------------------- helper functions
 
+    /// \name Skipping deleted elements (word by word in the deletion bitsets)
+    //@{
+
+    /// first vertex index >= idx that is not deleted (vertices_size() if none)
+    Index next_live_vertex(Index idx) const
+    {
+        return (idx < 0) ? idx : (Index) vdeleted_.vector().find_next(idx, false);
+    }
+    /// last vertex index <= idx that is not deleted (-1 if none)
+    Index prev_live_vertex(Index idx) const
+    {
+        return (Index) vdeleted_.vector().find_prev(idx, false);
+    }
+    /// first edge index >= idx that is not deleted (edges_size() if none)
+    Index next_live_edge(Index idx) const
+    {
+        return (idx < 0) ? idx : (Index) edeleted_.vector().find_next(idx, false);
+    }
+    /// last edge index <= idx that is not deleted (-1 if none)
+    Index prev_live_edge(Index idx) const
+    {
+        return (Index) edeleted_.vector().find_prev(idx, false);
+    }
+    /// first halfedge index >= idx that is not deleted (halfedges_size() if none)
+    Index next_live_halfedge(Index idx) const
+    {
+        if (idx < 0) return idx;
+        const Index e = next_live_edge(idx >> 1);
+        return (e == (idx >> 1)) ? idx : 2*e;
+    }
+    /// last halfedge index <= idx that is not deleted (-1 if none)
+    Index prev_live_halfedge(Index idx) const
+    {
+        if (idx < 0) return idx;
+        const Index e = prev_live_edge(idx >> 1);
+        return (e == (idx >> 1)) ? idx : ((e < 0) ? -1 : 2*e+1);
+    }
+    /// first face index >= idx that is not deleted (faces_size() if none)
+    Index next_live_face(Index idx) const
+    {
+        return (idx < 0) ? idx : (Index) fdeleted_.vector().find_next(idx, false);
+    }
+    /// last face index <= idx that is not deleted (-1 if none)
+    Index prev_live_face(Index idx) const
+    {
+        return (Index) fdeleted_.vector().find_prev(idx, false);
+    }
+
+    //@}
+
+    /// reassign the property handles and copy the state of \c rhs, once its
+    /// property containers are copied (see operator=() and share())
+    HEADERONLY_INLINE void copy_state(const SurfaceMesh& rhs);
+
     /** make sure that the outgoing halfedge of vertex v is a boundary halfedge
      if v is a boundary vertex. */
     HEADERONLY_INLINE void adjust_outgoing_halfedge(Vertex v);
@@ -1717,14 +2212,49 @@ private: //--------------------------------------------------- helper functions
     /// Helper for halfedge collapse
     HEADERONLY_INLINE void remove_loop(Halfedge h);
 
+    /// Helper for vertex split: adds the triangle (h, opposite of h) on the
+    /// side of \c h, returns the new halfedge parallel to \c h
+    HEADERONLY_INLINE Halfedge insert_loop(Halfedge h);
+
     /// are there deleted vertices, edges or faces?
     bool garbage() const { return garbage_; }
 
+    /// saves element \c i of \c p in the journal (if it is enabled)
+    template <class T> void journal(Property<T>& p, Index i)
+    {
+        if (journal_.enabled()) journal_.record(p.parray_, i);
+    }
+
+    /// the connectivity of face \c f (if any) changed
+    void topology_changed(Face f=Face())
+    {
+        topology_version_.store(0, std::memory_order_relaxed);
+        if (tbuffer_.enabled()) tbuffer_.touch(f.idx());
+    }
+
+    /// a topology_version() no mesh had before
+    static size_t next_topology_version()
+    {
+        static std::atomic<size_t> counter(0);
+        return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    /// the connectivity was rewritten as a whole (the journal can not undo that)
+    void topology_rebuilt()
+    {
+        topology_version_.store(0, std::memory_order_relaxed);
+        tbuffer_.invalidate();
+        journal_.clear();
+    }
+
 
 
 private: //------------------------------------------------------- private data
 
     HEADERONLY_INLINE friend bool read_poly(SurfaceMesh& mesh, const std::string& filename);
+    HEADERONLY_INLINE friend bool read_ogp(SurfaceMesh& mesh, const std::string& filename, Mapped_image_resource* resource);
+    HEADERONLY_INLINE friend bool write_ogp(const SurfaceMesh& mesh, const std::string& filename);
+    friend class SurfaceMeshMappedStorage;
 
     Property_container vprops_;
     Property_container hprops_;
@@ -1743,9 +2273,9 @@ private: //------------------------------------------------------- private data
     Vertex_property<Vec3>  vnormal_;
     Face_property<Vec3>    fnormal_;
 
-    unsigned int deleted_vertices_;
-    unsigned int deleted_edges_;
-    unsigned int deleted_faces_;
+    Size deleted_vertices_;
+    Size deleted_edges_;
+    Size deleted_faces_;
     bool garbage_;
 
     // helper data for add_face()
@@ -1756,6 +2286,14 @@ private: //------------------------------------------------------- private data
     std::vector<bool>        add_face_is_new_;
     std::vector<bool>        add_face_needs_adjust_;
     NextCache                add_face_next_cache_;
+
+    // triangle index buffer, updated lazily by the const accessors
+    mutable Triangle_buffer  tbuffer_;
+    // see topology_version(), 0 until asked for after a change
+    mutable std::atomic<size_t> topology_version_;
+
+    // undo log of the edits, see begin_journal()
+    Journal                  journal_;
 };
 
 
@@ -0,0 +1,418 @@
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Library General Public License Version 2
+// as published by the Free Software Foundation.
+//
+// This file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with OpenGP.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <OpenGP/SurfaceMesh/TriSurfaceMesh.h>
+#include <OpenGP/util/parallel.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+//== NAMESPACE ================================================================
+namespace OpenGP {
+//=============================================================================
+
+
+TriSurfaceMesh::
+TriSurfaceMesh()
+{
+    init_properties();
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+TriSurfaceMesh::
+init_properties()
+{
+    // same list is used in operator=()
+    vhalfedge_ = vertex_property<Halfedge>("v:halfedge");
+    vpoint_    = vertex_property<Vec3>("v:point");
+    hvertex_   = halfedge_property<Vertex>("h:vertex");
+    hopposite_ = halfedge_property<Halfedge>("h:opposite");
+    n_interior_ = 0;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+TriSurfaceMesh&
+TriSurfaceMesh::
+operator=(const TriSurfaceMesh& rhs)
+{
+    if (this != &rhs)
+    {
+        // deep copy of property containers
+        vprops_ = rhs.vprops_;
+        hprops_ = rhs.hprops_;
+        eprops_ = rhs.eprops_;
+        fprops_ = rhs.fprops_;
+
+        // property handles contain pointers, have to be reassigned
+        init_properties();
+
+        n_interior_    = rhs.n_interior_;
+        boundary_next_ = rhs.boundary_next_;
+        boundary_prev_ = rhs.boundary_prev_;
+    }
+    return *this;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+TriSurfaceMesh::
+clear()
+{
+    vprops_.clear();
+    hprops_.clear();
+    eprops_.clear();
+    fprops_.clear();
+    boundary_next_.clear();
+    boundary_prev_.clear();
+    init_properties();
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+bool
+TriSurfaceMesh::
+build(const std::vector<Vec3>& points, const std::vector<Size>& triangles)
+{
+    clear();
+
+    const Size nV = (Size) points.size();
+    if (triangles.size() % 3 != 0)
+    {
+        std::cerr << "TriSurfaceMesh::build: index buffer size is not a multiple of 3\n";
+        return false;
+    }
+    for (size_t i=0; i<triangles.size(); ++i)
+    {
+        if (triangles[i] >= nV)
+        {
+            std::cerr << "TriSurfaceMesh::build: vertex index " << triangles[i] << " out of range\n";
+            return false;
+        }
+    }
+
+    // corner c of the kept triangles points to hv[c]
+    std::vector<Index> hv;
+    hv.reserve(triangles.size());
+    for (size_t i=0; i<triangles.size(); i+=3)
+    {
+        Size a=triangles[i], b=triangles[i+1], c=triangles[i+2];
+        if (a==b || b==c || c==a) continue;
+        hv.push_back(a); hv.push_back(b); hv.push_back(c);
+    }
+    if (hv.size() != triangles.size())
+        std::cerr << "TriSurfaceMesh::build: skipped "
+                  << (triangles.size()-hv.size())/3 << " degenerate triangles\n";
+
+    const Index nI = (Index) hv.size();
+    auto from = [&hv](Index c){ return hv[(c%3==0) ? c+2 : c-1]; };
+
+    // match opposite corners by sorting the undirected edge keys
+    std::vector< std::pair<std::pair<Index,Index>, Index> > keys(nI);
+    for (Index c=0; c<nI; ++c)
+    {
+        Index a = from(c), b = hv[c];
+        if (a > b) std::swap(a, b);
+        keys[c] = std::make_pair(std::make_pair(a, b), c);
+    }
+    std::sort(keys.begin(), keys.end());
+
+    std::vector<Index> opp(nI, -1);
+    for (Index i=0; i<nI; )
+    {
+        Index j = i+1;
+        while (j<nI && keys[j].first==keys[i].first) ++j;
+        // only consistently oriented manifold edges are paired, others are cut open
+        if (j-i == 2)
+        {
+            Index c0 = keys[i].second, c1 = keys[i+1].second;
+            if (hv[c0] == from(c1))
+            {
+                opp[c0] = c1;
+                opp[c1] = c0;
+            }
+        }
+        i = j;
+    }
+
+    // one boundary halfedge for every unmatched corner
+    Index nB = 0;
+    for (Index c=0; c<nI; ++c)
+        if (opp[c] < 0) ++nB;
+
+    n_interior_ = nI;
+    vprops_.resize(nV);
+    hprops_.resize(nI+nB);
+    eprops_.resize(nI+nB);
+    fprops_.resize(nI/3);
+    boundary_next_.resize(nB);
+    boundary_prev_.resize(nB);
+
+    vpoint_.vector().assign(points.begin(), points.end());
+    for (Index c=0, b=nI; c<nI; ++c)
+    {
+        hvertex_[Halfedge(c)] = Vertex(hv[c]);
+        if (opp[c] < 0)
+        {
+            hvertex_[Halfedge(b)] = Vertex(from(c));
+            hopposite_[Halfedge(b)] = Halfedge(c);
+            hopposite_[Halfedge(c)] = Halfedge(b);
+            ++b;
+        }
+        else
+        {
+            hopposite_[Halfedge(c)] = Halfedge(opp[c]);
+        }
+    }
+
+    // link each boundary halfedge to the outgoing boundary halfedge that
+    // closes the same fan around its target vertex
+    for (Index b=nI; b<nI+nB; ++b)
+    {
+        Halfedge x = opposite_halfedge(Halfedge(b));
+        Halfedge y = opposite_halfedge(prev_halfedge(x));
+        while (!is_boundary(y))
+        {
+            x = y;
+            y = opposite_halfedge(prev_halfedge(x));
+        }
+        boundary_next_[b-nI] = y;
+        boundary_prev_[y.idx()-nI] = Halfedge(b);
+    }
+
+    // outgoing halfedges, boundary ones take precedence
+    for (Index c=0; c<nI; ++c)
+        vhalfedge_[from_vertex(Halfedge(c))] = Halfedge(c);
+    for (Index b=nI; b<nI+nB; ++b)
+        vhalfedge_[from_vertex(Halfedge(b))] = Halfedge(b);
+
+    return true;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+bool
+TriSurfaceMesh::
+build(const SurfaceMesh& mesh)
+{
+    std::vector<Index> index(mesh.vertices_size(), -1);
+    std::vector<Vec3> points;
+    points.reserve(mesh.n_vertices());
+    for (SurfaceMesh::Vertex v : mesh.vertices())
+    {
+        index[v.idx()] = (Index) points.size();
+        points.push_back(mesh.position(v));
+    }
+
+    std::vector<Size> triangles;
+    triangles.reserve(3*mesh.n_faces());
+    for (SurfaceMesh::Face f : mesh.faces())
+    {
+        if (mesh.valence(f) != 3)
+        {
+            std::cerr << "TriSurfaceMesh::build: mesh is not a triangle mesh\n";
+            clear();
+            return false;
+        }
+        for (SurfaceMesh::Vertex v : mesh.vertices(f))
+            triangles.push_back(index[v.idx()]);
+    }
+
+    return build(points, triangles);
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+TriSurfaceMesh::
+to_surface_mesh(SurfaceMesh& mesh) const
+{
+    std::vector<Vec3> points(n_vertices());
+    for (Vertex v : vertices())
+        points[v.idx()] = position(v);
+
+    // corner h of the index buffer is the start vertex of halfedge h
+    std::vector<unsigned int> face_sizes(n_faces(), 3);
+    std::vector<Size> indices(n_interior_);
+    for (Index h=0; h<n_interior_; ++h)
+        indices[h] = from_vertex(Halfedge(h)).idx();
+    mesh.build_from_indices(points, face_sizes, indices);
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+bool
+TriSurfaceMesh::
+read(const std::string& filename)
+{
+    SurfaceMesh mesh;
+    if (!mesh.read(filename)) return false;
+    mesh.triangulate();
+    return build(mesh);
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+bool
+TriSurfaceMesh::
+write(const std::string& filename) const
+{
+    SurfaceMesh mesh;
+    to_surface_mesh(mesh);
+    return mesh.write(filename);
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+size_t
+TriSurfaceMesh::
+connectivity_bytes() const
+{
+    return vertices_size() * sizeof(Halfedge)
+         + halfedges_size() * (sizeof(Vertex) + sizeof(Halfedge))
+         + 2 * boundary_next_.size() * sizeof(Halfedge);
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+unsigned int
+TriSurfaceMesh::
+valence(Vertex v) const
+{
+    unsigned int count(0);
+    Vertex_around_vertex_circulator vvit = vertices(v);
+    Vertex_around_vertex_circulator vvend = vvit;
+    if (vvit) do
+    {
+        ++count;
+    } while (++vvit != vvend);
+    return count;
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+TriSurfaceMesh::Halfedge
+TriSurfaceMesh::
+find_halfedge(Vertex start, Vertex end) const
+{
+    assert(is_valid(start) && is_valid(end));
+
+    Halfedge h  = halfedge(start);
+    const Halfedge hh = h;
+    if (h.is_valid())
+    {
+        do
+        {
+            if (to_vertex(h) == end)
+                return h;
+            h = cw_rotated_halfedge(h);
+        }
+        while (h != hh);
+    }
+    return Halfedge();
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+TriSurfaceMesh::
+update_face_normals()
+{
+    Face_property<Vec3> fnormal = face_property<Vec3>("f:normal");
+    const TriSurfaceMesh& mesh = *this;
+    parallel_for_chunks(0, faces_size(), [&](Index begin, Index end){
+        for (Index i=begin; i<end; ++i)
+        {
+            Halfedge h = mesh.halfedge(Face(i));
+            const Vec3& p0 = mesh.position(mesh.to_vertex(h));
+            const Vec3& p1 = mesh.position(mesh.to_vertex(Halfedge(h.idx()+1)));
+            const Vec3& p2 = mesh.position(mesh.to_vertex(Halfedge(h.idx()+2)));
+            Vec3 n = (p2-p1).cross(p0-p1);
+            Scalar length = n.norm();
+            fnormal[Face(i)] = (length > std::numeric_limits<Scalar>::min()) ? Vec3(n/length) : Vec3(0,0,0);
+        }
+    });
+}
+
+
+//-----------------------------------------------------------------------------
+
+
+void
+TriSurfaceMesh::
+update_vertex_normals()
+{
+    Vertex_property<Vec3> vnormal = vertex_property<Vec3>("v:normal");
+    const TriSurfaceMesh& mesh = *this;
+    parallel_for_chunks(0, vertices_size(), [&](Index begin, Index end){
+        for (Index i=begin; i<end; ++i)
+        {
+            Vec3 nn(0,0,0);
+            Halfedge h = mesh.halfedge(Vertex(i));
+            if (h.is_valid())
+            {
+                const Halfedge hend = h;
+                const Vec3& p0 = mesh.position(Vertex(i));
+                do
+                {
+                    if (!mesh.is_boundary(h))
+                    {
+                        // the corner of face(h) at vertex i
+                        Vec3 d1 = mesh.position(mesh.to_vertex(h)) - p0;
+                        Vec3 d2 = mesh.position(mesh.to_vertex(mesh.next_halfedge(h))) - p0;
+                        Vec3 n = d1.cross(d2);
+                        Scalar length = n.norm();
+                        if (length > std::numeric_limits<Scalar>::min())
+                            nn += (std::atan2(length, d1.dot(d2)) / length) * n;
+                    }
+                    h = mesh.cw_rotated_halfedge(h);
+                }
+                while (h != hend);
+                nn.normalize();
+            }
+            vnormal[Vertex(i)] = nn;
+        }
+    });
+}
+
+
+//=============================================================================
+} // namespace OpenGP
+//=============================================================================
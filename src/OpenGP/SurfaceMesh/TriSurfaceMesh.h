@@ -0,0 +1,730 @@
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Library General Public License Version 2
+// as published by the Free Software Foundation.
+//
+// This file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with OpenGP.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+#include <OpenGP/types.h>
+#include <OpenGP/headeronly.h>
+#include <OpenGP/SurfaceMesh/SurfaceMesh.h>
+
+//=============================================================================
+namespace OpenGP {
+//=============================================================================
+
+/// A compact, static representation of triangle meshes (corner table).
+///
+/// The halfedges of face \c f are the corners 3f, 3f+1 and 3f+2: the face,
+/// next and previous halfedge of an interior halfedge follow from index
+/// arithmetic, and only the target vertex and the opposite halfedge are
+/// stored. Boundary halfedges are appended after the 3*n_faces() interior
+/// ones and additionally store their next/previous boundary halfedge.
+/// This takes roughly half the memory of SurfaceMesh and keeps the halfedges
+/// of a face adjacent in memory.
+///
+/// Handles, properties, iterators and circulators behave as in SurfaceMesh
+/// (the handle and property types are shared). The connectivity cannot be
+/// edited: the mesh is built in bulk from a SurfaceMesh or an index buffer.
+///
+/// An edge is identified by the index of its smaller halfedge, hence edge
+/// indices are not contiguous and edge properties are sized like halfedge
+/// properties (edges_size() == halfedges_size()).
+class TriSurfaceMesh : public Global_properties
+{
+
+public: //------------------------------------------------------ topology types
+
+    typedef SurfaceMesh::Vertex   Vertex;
+    typedef SurfaceMesh::Halfedge Halfedge;
+    typedef SurfaceMesh::Edge     Edge;
+    typedef SurfaceMesh::Face     Face;
+
+
+public: //------------------------------------------------------ property types
+
+    template <class T> using Vertex_property   = SurfaceMesh::Vertex_property<T>;
+    template <class T> using Halfedge_property = SurfaceMesh::Halfedge_property<T>;
+    template <class T> using Edge_property     = SurfaceMesh::Edge_property<T>;
+    template <class T> using Face_property     = SurfaceMesh::Face_property<T>;
+
+
+public: //------------------------------------------------------ iterator types
+
+    /// this class iterates linearly over all vertices
+    class Vertex_iterator
+    {
+    public:
+        Vertex_iterator(Vertex v=Vertex()) : hnd_(v) {}
+        Vertex operator*() const { return hnd_; }
+        bool operator==(const Vertex_iterator& rhs) const { return hnd_==rhs.hnd_; }
+        bool operator!=(const Vertex_iterator& rhs) const { return !operator==(rhs); }
+        Vertex_iterator& operator++() { hnd_ = Vertex(hnd_.idx()+1); return *this; }
+        Vertex_iterator& operator--() { hnd_ = Vertex(hnd_.idx()-1); return *this; }
+    private:
+        Vertex hnd_;
+    };
+
+    /// this class iterates linearly over all halfedges
+    class Halfedge_iterator
+    {
+    public:
+        Halfedge_iterator(Halfedge h=Halfedge()) : hnd_(h) {}
+        Halfedge operator*() const { return hnd_; }
+        bool operator==(const Halfedge_iterator& rhs) const { return hnd_==rhs.hnd_; }
+        bool operator!=(const Halfedge_iterator& rhs) const { return !operator==(rhs); }
+        Halfedge_iterator& operator++() { hnd_ = Halfedge(hnd_.idx()+1); return *this; }
+        Halfedge_iterator& operator--() { hnd_ = Halfedge(hnd_.idx()-1); return *this; }
+    private:
+        Halfedge hnd_;
+    };
+
+    /// this class iterates over all edges (skips the halfedge indices that do not name an edge)
+    class Edge_iterator
+    {
+    public:
+        Edge_iterator(Edge e=Edge(), const TriSurfaceMesh* m=NULL) : hnd_(e), mesh_(m)
+        {
+            if (mesh_) while (mesh_->is_valid(hnd_) && !mesh_->is_edge(hnd_)) hnd_ = Edge(hnd_.idx()+1);
+        }
+        Edge operator*() const { return hnd_; }
+        bool operator==(const Edge_iterator& rhs) const { return hnd_==rhs.hnd_; }
+        bool operator!=(const Edge_iterator& rhs) const { return !operator==(rhs); }
+        Edge_iterator& operator++()
+        {
+            assert(mesh_);
+            do hnd_ = Edge(hnd_.idx()+1); while (mesh_->is_valid(hnd_) && !mesh_->is_edge(hnd_));
+            return *this;
+        }
+        Edge_iterator& operator--()
+        {
+            assert(mesh_);
+            do hnd_ = Edge(hnd_.idx()-1); while (mesh_->is_valid(hnd_) && !mesh_->is_edge(hnd_));
+            return *this;
+        }
+    private:
+        Edge hnd_;
+        const TriSurfaceMesh* mesh_;
+    };
+
+    /// this class iterates linearly over all faces
+    class Face_iterator
+    {
+    public:
+        Face_iterator(Face f=Face()) : hnd_(f) {}
+        Face operator*() const { return hnd_; }
+        bool operator==(const Face_iterator& rhs) const { return hnd_==rhs.hnd_; }
+        bool operator!=(const Face_iterator& rhs) const { return !operator==(rhs); }
+        Face_iterator& operator++() { hnd_ = Face(hnd_.idx()+1); return *this; }
+        Face_iterator& operator--() { hnd_ = Face(hnd_.idx()-1); return *this; }
+    private:
+        Face hnd_;
+    };
+
+
+public: //-------------------------- containers for C++11 range-based for loops
+
+    template <class Iterator> class Container
+    {
+    public:
+        Container(Iterator _begin, Iterator _end) : begin_(_begin), end_(_end) {}
+        Iterator begin() const { return begin_; }
+        Iterator end()   const { return end_;   }
+    private:
+        Iterator begin_, end_;
+    };
+
+    typedef Container<Vertex_iterator>   Vertex_container;
+    typedef Container<Halfedge_iterator> Halfedge_container;
+    typedef Container<Edge_iterator>     Edge_container;
+    typedef Container<Face_iterator>     Face_container;
+
+
+public: //---------------------------------------------------- circulator types
+
+    /// this class circulates through all one-ring neighbors of a vertex.
+    /// it also acts as a container-concept for C++11 range-based for loops.
+    class Vertex_around_vertex_circulator
+    {
+    public:
+        Vertex_around_vertex_circulator(const TriSurfaceMesh* m=NULL, Vertex v=Vertex())
+        : mesh_(m), active_(true)
+        {
+            if (mesh_) halfedge_ = mesh_->halfedge(v);
+        }
+        bool operator==(const Vertex_around_vertex_circulator& rhs) const
+        {
+            assert(mesh_);
+            return (active_ && (mesh_==rhs.mesh_) && (halfedge_==rhs.halfedge_));
+        }
+        bool operator!=(const Vertex_around_vertex_circulator& rhs) const { return !operator==(rhs); }
+        /// pre-increment (rotate couter-clockwise)
+        Vertex_around_vertex_circulator& operator++()
+        {
+            assert(mesh_);
+            halfedge_ = mesh_->ccw_rotated_halfedge(halfedge_);
+            active_ = true;
+            return *this;
+        }
+        /// pre-decrement (rotate clockwise)
+        Vertex_around_vertex_circulator& operator--()
+        {
+            assert(mesh_);
+            halfedge_ = mesh_->cw_rotated_halfedge(halfedge_);
+            return *this;
+        }
+        Vertex operator*() const { assert(mesh_); return mesh_->to_vertex(halfedge_); }
+        /// cast to bool: true if vertex is not isolated
+        operator bool() const { return halfedge_.is_valid(); }
+        /// return current halfedge
+        Halfedge halfedge() const { return halfedge_; }
+        Vertex_around_vertex_circulator& begin() { active_=!halfedge_.is_valid(); return *this; }
+        Vertex_around_vertex_circulator& end()   { active_=true;  return *this; }
+    private:
+        const TriSurfaceMesh* mesh_;
+        Halfedge halfedge_;
+        bool active_;
+    };
+
+    /// this class circulates through all outgoing halfedges of a vertex.
+    /// it also acts as a container-concept for C++11 range-based for loops.
+    class Halfedge_around_vertex_circulator
+    {
+    public:
+        Halfedge_around_vertex_circulator(const TriSurfaceMesh* m=NULL, Vertex v=Vertex())
+        : mesh_(m), active_(true)
+        {
+            if (mesh_) halfedge_ = mesh_->halfedge(v);
+        }
+        bool operator==(const Halfedge_around_vertex_circulator& rhs) const
+        {
+            assert(mesh_);
+            return (active_ && (mesh_==rhs.mesh_) && (halfedge_==rhs.halfedge_));
+        }
+        bool operator!=(const Halfedge_around_vertex_circulator& rhs) const { return !operator==(rhs); }
+        /// pre-increment (rotate couter-clockwise)
+        Halfedge_around_vertex_circulator& operator++()
+        {
+            assert(mesh_);
+            halfedge_ = mesh_->ccw_rotated_halfedge(halfedge_);
+            active_ = true;
+            return *this;
+        }
+        /// pre-decrement (rotate clockwise)
+        Halfedge_around_vertex_circulator& operator--()
+        {
+            assert(mesh_);
+            halfedge_ = mesh_->cw_rotated_halfedge(halfedge_);
+            return *this;
+        }
+        Halfedge operator*() const { return halfedge_; }
+        /// cast to bool: true if vertex is not isolated
+        operator bool() const { return halfedge_.is_valid(); }
+        Halfedge_around_vertex_circulator& begin() { active_=!halfedge_.is_valid(); return *this; }
+        Halfedge_around_vertex_circulator& end()   { active_=true;  return *this; }
+    private:
+        const TriSurfaceMesh* mesh_;
+        Halfedge halfedge_;
+        bool active_;
+    };
+
+    /// this class circulates through all incident faces of a vertex.
+    /// it also acts as a container-concept for C++11 range-based for loops.
+    class Face_around_vertex_circulator
+    {
+    public:
+        /// construct with mesh and vertex (vertex should not be isolated!)
+        Face_around_vertex_circulator(const TriSurfaceMesh* m=NULL, Vertex v=Vertex())
+        : mesh_(m), active_(true)
+        {
+            if (mesh_)
+            {
+                halfedge_ = mesh_->halfedge(v);
+                if (halfedge_.is_valid() && mesh_->is_boundary(halfedge_))
+                    operator++();
+            }
+        }
+        bool operator==(const Face_around_vertex_circulator& rhs) const
+        {
+            assert(mesh_);
+            return (active_ && (mesh_==rhs.mesh_) && (halfedge_==rhs.halfedge_));
+        }
+        bool operator!=(const Face_around_vertex_circulator& rhs) const { return !operator==(rhs); }
+        /// pre-increment (rotates counter-clockwise)
+        Face_around_vertex_circulator& operator++()
+        {
+            assert(mesh_ && halfedge_.is_valid());
+            do {
+                halfedge_ = mesh_->ccw_rotated_halfedge(halfedge_);
+            } while (mesh_->is_boundary(halfedge_));
+            active_ = true;
+            return *this;
+        }
+        /// pre-decrement (rotate clockwise)
+        Face_around_vertex_circulator& operator--()
+        {
+            assert(mesh_ && halfedge_.is_valid());
+            do
+                halfedge_ = mesh_->cw_rotated_halfedge(halfedge_);
+            while (mesh_->is_boundary(halfedge_));
+            return *this;
+        }
+        Face operator*() const { assert(mesh_ && halfedge_.is_valid()); return mesh_->face(halfedge_); }
+        /// cast to bool: true if vertex is not isolated
+        operator bool() const { return halfedge_.is_valid(); }
+        Face_around_vertex_circulator& begin() { active_=!halfedge_.is_valid(); return *this; }
+        Face_around_vertex_circulator& end()   { active_=true;  return *this; }
+    private:
+        const TriSurfaceMesh* mesh_;
+        Halfedge halfedge_;
+        bool active_;
+    };
+
+    /// this class circulates through the vertices of a face.
+    /// it also acts as a container-concept for C++11 range-based for loops.
+    class Vertex_around_face_circulator
+    {
+    public:
+        Vertex_around_face_circulator(const TriSurfaceMesh* m=NULL, Face f=Face())
+        : mesh_(m), active_(true)
+        {
+            if (mesh_) halfedge_ = mesh_->halfedge(f);
+        }
+        bool operator==(const Vertex_around_face_circulator& rhs) const
+        {
+            assert(mesh_);
+            return (active_ && (mesh_==rhs.mesh_) && (halfedge_==rhs.halfedge_));
+        }
+        bool operator!=(const Vertex_around_face_circulator& rhs) const { return !operator==(rhs); }
+        /// pre-increment (rotates counter-clockwise)
+        Vertex_around_face_circulator& operator++()
+        {
+            assert(mesh_ && halfedge_.is_valid());
+            halfedge_ = mesh_->next_halfedge(halfedge_);
+            active_ = true;
+            return *this;
+        }
+        /// pre-decrement (rotates clockwise)
+        Vertex_around_face_circulator& operator--()
+        {
+            assert(mesh_ && halfedge_.is_valid());
+            halfedge_ = mesh_->prev_halfedge(halfedge_);
+            return *this;
+        }
+        Vertex operator*() const { assert(mesh_ && halfedge_.is_valid()); return mesh_->to_vertex(halfedge_); }
+        Vertex_around_face_circulator& begin() { active_=false; return *this; }
+        Vertex_around_face_circulator& end()   { active_=true;  return *this; }
+    private:
+        const TriSurfaceMesh* mesh_;
+        Halfedge halfedge_;
+        bool active_;
+    };
+
+    /// this class circulates through all halfedges of a face.
+    /// it also acts as a container-concept for C++11 range-based for loops.
+    class Halfedge_around_face_circulator
+    {
+    public:
+        Halfedge_around_face_circulator(const TriSurfaceMesh* m=NULL, Face f=Face())
+        : mesh_(m), active_(true)
+        {
+            if (mesh_) halfedge_ = mesh_->halfedge(f);
+        }
+        bool operator==(const Halfedge_around_face_circulator& rhs) const
+        {
+            assert(mesh_);
+            return (active_ && (mesh_==rhs.mesh_) && (halfedge_==rhs.halfedge_));
+        }
+        bool operator!=(const Halfedge_around_face_circulator& rhs) const { return !operator==(rhs); }
+        /// pre-increment (rotates counter-clockwise)
+        Halfedge_around_face_circulator& operator++()
+        {
+            assert(mesh_ && halfedge_.is_valid());
+            halfedge_ = mesh_->next_halfedge(halfedge_);
+            active_ = true;
+            return *this;
+        }
+        /// pre-decrement (rotates clockwise)
+        Halfedge_around_face_circulator& operator--()
+        {
+            assert(mesh_ && halfedge_.is_valid());
+            halfedge_ = mesh_->prev_halfedge(halfedge_);
+            return *this;
+        }
+        Halfedge operator*() const { return halfedge_; }
+        Halfedge_around_face_circulator& begin() { active_=false; return *this; }
+        Halfedge_around_face_circulator& end()   { active_=true;  return *this; }
+    private:
+        const TriSurfaceMesh* mesh_;
+        Halfedge halfedge_;
+        bool active_;
+    };
+
+
+public: //-------------------------------------------- constructor / destructor
+
+    /// \name Construct, destruct, assignment
+    //@{
+
+    /// default constructor (empty mesh)
+    HEADERONLY_INLINE TriSurfaceMesh();
+
+    /// build from a triangle SurfaceMesh (see build(const SurfaceMesh&))
+    explicit TriSurfaceMesh(const SurfaceMesh& mesh) { init_properties(); build(mesh); }
+
+    /// copy constructor: performs a deep copy of all properties.
+    TriSurfaceMesh(const TriSurfaceMesh& rhs) : Global_properties() { init_properties(); operator=(rhs); }
+
+    /// assign \c rhs to \c *this. performs a deep copy of all properties.
+    HEADERONLY_INLINE TriSurfaceMesh& operator=(const TriSurfaceMesh& rhs);
+
+    //@}
+
+
+public: //------------------------------------------------------ bulk building
+
+    /// \name Building
+    //@{
+
+    /** build the mesh from \c points and the index buffer \c triangles (three
+     vertex indices per face). Degenerate triangles are skipped. Edges shared by
+     more than two triangles, or by two inconsistently oriented triangles, are
+     cut open (they become two boundary edges). At a vertex shared by several
+     fans of triangles the vertex circulators only visit one of the fans.
+     Returns false if an index is out of range. Any previous content (and all
+     properties) is cleared. */
+    HEADERONLY_INLINE bool build(const std::vector<Vec3>& points,
+                                 const std::vector<Size>& triangles);
+
+    /** build the mesh from the non-deleted elements of \c mesh, which must be a
+     triangle mesh. Vertex positions are copied, other properties are not.
+     Returns false (and leaves an empty mesh) otherwise. */
+    HEADERONLY_INLINE bool build(const SurfaceMesh& mesh);
+
+    /// convert back to a (editable) SurfaceMesh. only vertex positions are copied.
+    HEADERONLY_INLINE void to_surface_mesh(SurfaceMesh& mesh) const;
+
+    /// read a mesh with SurfaceMesh::read(), triangulate it and build from it
+    HEADERONLY_INLINE bool read(const std::string& filename);
+
+    /// write the mesh with SurfaceMesh::write()
+    HEADERONLY_INLINE bool write(const std::string& filename) const;
+
+    /// clear mesh: remove all vertices, edges, faces and custom properties
+    HEADERONLY_INLINE void clear();
+
+    //@}
+
+
+public: //--------------------------------------------------- memory management
+
+    /// \name Sizes
+    //@{
+
+    /// returns number of vertices in the mesh
+    Size vertices_size() const { return (Size) vprops_.size(); }
+    /// returns number of halfedges (3*n_faces() interior ones, followed by the boundary ones)
+    Size halfedges_size() const { return (Size) hprops_.size(); }
+    /// returns the size of edge properties (== halfedges_size(), edge indices are sparse)
+    Size edges_size() const { return (Size) eprops_.size(); }
+    /// returns number of faces in the mesh
+    Size faces_size() const { return (Size) fprops_.size(); }
+
+    Size n_vertices() const { return vertices_size(); }
+    Size n_halfedges() const { return halfedges_size(); }
+    Size n_edges() const { return halfedges_size() / 2; }
+    Size n_faces() const { return faces_size(); }
+    /// returns number of boundary halfedges
+    Size n_boundary_halfedges() const { return (Size) boundary_next_.size(); }
+
+    /// returns true iff the mesh is empty, i.e., has no vertices
+    bool empty() const { return n_vertices() == 0; }
+
+    /// elements cannot be deleted, provided for compatibility with SurfaceMesh
+    bool is_deleted(Vertex) const { return false; }
+    bool is_deleted(Halfedge) const { return false; }
+    bool is_deleted(Edge) const { return false; }
+    bool is_deleted(Face) const { return false; }
+
+    bool is_valid(Vertex v) const   { return (0 <= v.idx()) && (v.idx() < (Index)vertices_size()); }
+    bool is_valid(Halfedge h) const { return (0 <= h.idx()) && (h.idx() < (Index)halfedges_size()); }
+    bool is_valid(Edge e) const     { return (0 <= e.idx()) && (e.idx() < (Index)edges_size()); }
+    bool is_valid(Face f) const     { return (0 <= f.idx()) && (f.idx() < (Index)faces_size()); }
+
+    /// returns whether the index of \c e names an edge (i.e. it is the smaller of its two halfedges)
+    bool is_edge(Edge e) const { return e.idx() < hopposite_[Halfedge(e.idx())].idx(); }
+
+    /// returns the number of bytes used by the connectivity (not by properties)
+    HEADERONLY_INLINE size_t connectivity_bytes() const;
+
+    //@}
+
+
+public: //---------------------------------------------- low-level connectivity
+
+    /// \name Low-level connectivity
+    //@{
+
+    /// returns an outgoing halfedge of vertex \c v.
+    /// if \c v is a boundary vertex this will be a boundary halfedge.
+    Halfedge halfedge(Vertex v) const { return vhalfedge_[v]; }
+
+    /// returns whether \c v is a boundary vertex
+    bool is_boundary(Vertex v) const
+    {
+        Halfedge h(halfedge(v));
+        return (!(h.is_valid() && !is_boundary(h)));
+    }
+
+    /// returns whether \c v is isolated, i.e., not incident to any face
+    bool is_isolated(Vertex v) const { return !halfedge(v).is_valid(); }
+
+    /// returns the vertex the halfedge \c h points to
+    Vertex to_vertex(Halfedge h) const { return hvertex_[h]; }
+
+    /// returns the vertex the halfedge \c h emanates from
+    Vertex from_vertex(Halfedge h) const { return to_vertex(opposite_halfedge(h)); }
+
+    /// returns the face incident to halfedge \c h (invalid for boundary halfedges)
+    Face face(Halfedge h) const { return is_boundary(h) ? Face() : Face(h.idx()/3); }
+
+    /// returns the next halfedge within the incident face (or along the boundary)
+    Halfedge next_halfedge(Halfedge h) const
+    {
+        if (is_boundary(h)) return boundary_next_[h.idx()-n_interior_];
+        return Halfedge((h.idx()%3 == 2) ? h.idx()-2 : h.idx()+1);
+    }
+
+    /// returns the previous halfedge within the incident face (or along the boundary)
+    Halfedge prev_halfedge(Halfedge h) const
+    {
+        if (is_boundary(h)) return boundary_prev_[h.idx()-n_interior_];
+        return Halfedge((h.idx()%3 == 0) ? h.idx()+2 : h.idx()-1);
+    }
+
+    /// returns the opposite halfedge of \c h
+    Halfedge opposite_halfedge(Halfedge h) const { return hopposite_[h]; }
+
+    /// returns the halfedge rotated counter-clockwise around the start vertex of \c h
+    Halfedge ccw_rotated_halfedge(Halfedge h) const { return opposite_halfedge(prev_halfedge(h)); }
+
+    /// returns the halfedge rotated clockwise around the start vertex of \c h
+    Halfedge cw_rotated_halfedge(Halfedge h) const { return next_halfedge(opposite_halfedge(h)); }
+
+    /// return the edge that contains halfedge \c h as one of its two halfedges.
+    Edge edge(Halfedge h) const { return Edge(std::min(h.idx(), opposite_halfedge(h).idx())); }
+
+    /// returns whether h is a boundary halfege, i.e., if its face does not exist.
+    bool is_boundary(Halfedge h) const { return h.idx() >= n_interior_; }
+
+    /// returns the \c i'th halfedge of edge \c e. \c i has to be 0 or 1.
+    Halfedge halfedge(Edge e, unsigned int i) const
+    {
+        assert(i<=1);
+        return (i==0) ? Halfedge(e.idx()) : opposite_halfedge(Halfedge(e.idx()));
+    }
+
+    /// returns the \c i'th vertex of edge \c e. \c i has to be 0 or 1.
+    Vertex vertex(Edge e, unsigned int i) const { return to_vertex(halfedge(e, i)); }
+
+    /// returns the face incident to the \c i'th halfedge of edge \c e. \c i has to be 0 or 1.
+    Face face(Edge e, unsigned int i) const { return face(halfedge(e, i)); }
+
+    /// returns whether \c e is a boundary edge
+    bool is_boundary(Edge e) const { return is_boundary(halfedge(e, 1)); }
+
+    /// returns the first halfedge of face \c f
+    Halfedge halfedge(Face f) const { return Halfedge(3*f.idx()); }
+
+    /// returns whether \c f is a boundary face, i.e., it one of its edges is a boundary edge.
+    bool is_boundary(Face f) const
+    {
+        const Index h = 3*f.idx();
+        return is_boundary(hopposite_[Halfedge(h)]) ||
+               is_boundary(hopposite_[Halfedge(h+1)]) ||
+               is_boundary(hopposite_[Halfedge(h+2)]);
+    }
+
+    /// returns the valence (number of incident edges) of vertex \c v.
+    HEADERONLY_INLINE unsigned int valence(Vertex v) const;
+
+    /// returns the valence of face \c f (always 3)
+    unsigned int valence(Face) const { return 3; }
+
+    /// find the halfedge from start to end
+    HEADERONLY_INLINE Halfedge find_halfedge(Vertex start, Vertex end) const;
+
+    /// find the edge (a,b)
+    Edge find_edge(Vertex a, Vertex b) const
+    {
+        Halfedge h = find_halfedge(a,b);
+        return h.is_valid() ? edge(h) : Edge();
+    }
+
+    //@}
+
+
+public: //--------------------------------------------------- property handling
+
+    /// \name Property handling
+    //@{
+
+    template <class T> Vertex_property<T> add_vertex_property(const std::string& name, const T t=T())
+    {
+        return Vertex_property<T>(vprops_.add<T>(name, t));
+    }
+    template <class T> Halfedge_property<T> add_halfedge_property(const std::string& name, const T t=T())
+    {
+        return Halfedge_property<T>(hprops_.add<T>(name, t));
+    }
+    template <class T> Edge_property<T> add_edge_property(const std::string& name, const T t=T())
+    {
+        return Edge_property<T>(eprops_.add<T>(name, t));
+    }
+    template <class T> Face_property<T> add_face_property(const std::string& name, const T t=T())
+    {
+        return Face_property<T>(fprops_.add<T>(name, t));
+    }
+
+    template <class T> Vertex_property<T> get_vertex_property(const std::string& name) const
+    {
+        return Vertex_property<T>(vprops_.get<T>(name));
+    }
+    template <class T> Halfedge_property<T> get_halfedge_property(const std::string& name) const
+    {
+        return Halfedge_property<T>(hprops_.get<T>(name));
+    }
+    template <class T> Edge_property<T> get_edge_property(const std::string& name) const
+    {
+        return Edge_property<T>(eprops_.get<T>(name));
+    }
+    template <class T> Face_property<T> get_face_property(const std::string& name) const
+    {
+        return Face_property<T>(fprops_.get<T>(name));
+    }
+
+    template <class T> Vertex_property<T> vertex_property(const std::string& name, const T t=T())
+    {
+        return Vertex_property<T>(vprops_.get_or_add<T>(name, t));
+    }
+    template <class T> Halfedge_property<T> halfedge_property(const std::string& name, const T t=T())
+    {
+        return Halfedge_property<T>(hprops_.get_or_add<T>(name, t));
+    }
+    template <class T> Edge_property<T> edge_property(const std::string& name, const T t=T())
+    {
+        return Edge_property<T>(eprops_.get_or_add<T>(name, t));
+    }
+    template <class T> Face_property<T> face_property(const std::string& name, const T t=T())
+    {
+        return Face_property<T>(fprops_.get_or_add<T>(name, t));
+    }
+
+    template <class T> void remove_vertex_property(Vertex_property<T>& p)     { vprops_.remove(p); }
+    template <class T> void remove_halfedge_property(Halfedge_property<T>& p) { hprops_.remove(p); }
+    template <class T> void remove_edge_property(Edge_property<T>& p)         { eprops_.remove(p); }
+    template <class T> void remove_face_property(Face_property<T>& p)         { fprops_.remove(p); }
+
+    std::vector<std::string> vertex_properties() const   { return vprops_.properties(); }
+    std::vector<std::string> halfedge_properties() const { return hprops_.properties(); }
+    std::vector<std::string> edge_properties() const     { return eprops_.properties(); }
+    std::vector<std::string> face_properties() const     { return fprops_.properties(); }
+
+    //@}
+
+
+public: //--------------------------------------------- iterators & circulators
+
+    /// \name Iterators & Circulators
+    //@{
+
+    Vertex_iterator vertices_begin() const { return Vertex_iterator(Vertex(0)); }
+    Vertex_iterator vertices_end() const { return Vertex_iterator(Vertex(vertices_size())); }
+    Vertex_container vertices() const { return Vertex_container(vertices_begin(), vertices_end()); }
+
+    Halfedge_iterator halfedges_begin() const { return Halfedge_iterator(Halfedge(0)); }
+    Halfedge_iterator halfedges_end() const { return Halfedge_iterator(Halfedge(halfedges_size())); }
+    Halfedge_container halfedges() const { return Halfedge_container(halfedges_begin(), halfedges_end()); }
+
+    Edge_iterator edges_begin() const { return Edge_iterator(Edge(0), this); }
+    Edge_iterator edges_end() const { return Edge_iterator(Edge(edges_size()), this); }
+    Edge_container edges() const { return Edge_container(edges_begin(), edges_end()); }
+
+    Face_iterator faces_begin() const { return Face_iterator(Face(0)); }
+    Face_iterator faces_end() const { return Face_iterator(Face(faces_size())); }
+    Face_container faces() const { return Face_container(faces_begin(), faces_end()); }
+
+    Vertex_around_vertex_circulator vertices(Vertex v) const { return Vertex_around_vertex_circulator(this, v); }
+    Halfedge_around_vertex_circulator halfedges(Vertex v) const { return Halfedge_around_vertex_circulator(this, v); }
+    Face_around_vertex_circulator faces(Vertex v) const { return Face_around_vertex_circulator(this, v); }
+    Vertex_around_face_circulator vertices(Face f) const { return Vertex_around_face_circulator(this, f); }
+    Halfedge_around_face_circulator halfedges(Face f) const { return Halfedge_around_face_circulator(this, f); }
+
+    //@}
+
+
+public: //------------------------------------------ geometry-related functions
+
+    /// \name Geometry-related Functions
+    //@{
+
+    /// position of a vertex (read only)
+    const Vec3& position(Vertex v) const { return vpoint_[v]; }
+
+    /// position of a vertex
+    Vec3& position(Vertex v) { return vpoint_[v]; }
+
+    /// vector of vertex positions
+    Vertex_property<Vec3>::vector_type& points() { return vpoint_.vector(); }
+
+    /// compute the "f:normal" property (in parallel)
+    HEADERONLY_INLINE void update_face_normals();
+
+    /// compute the angle-weighted "v:normal" property (in parallel)
+    HEADERONLY_INLINE void update_vertex_normals();
+
+    /// compute the length of edge \c e.
+    Scalar edge_length(Edge e) const { return (vpoint_[vertex(e,0)] - vpoint_[vertex(e,1)]).norm(); }
+
+    //@}
+
+
+private: //--------------------------------------------------- helper functions
+
+    /// allocates the standard properties
+    HEADERONLY_INLINE void init_properties();
+
+
+private: //------------------------------------------------------- private data
+
+    Property_container vprops_;
+    Property_container hprops_;
+    Property_container eprops_;
+    Property_container fprops_;
+
+    Vertex_property<Halfedge>   vhalfedge_;
+    Vertex_property<Vec3>       vpoint_;
+    Halfedge_property<Vertex>   hvertex_;
+    Halfedge_property<Halfedge> hopposite_;
+
+    /// number of interior halfedges (3*n_faces()), boundary halfedges come after
+    Index n_interior_;
+    /// next/previous halfedge of boundary halfedge n_interior_+i
+    std::vector<Halfedge> boundary_next_;
+    std::vector<Halfedge> boundary_prev_;
+};
+
+//=============================================================================
+} // namespace OpenGP
+//=============================================================================
+
+// Header only support
+#ifdef HEADERONLY
+    #include "TriSurfaceMesh.cpp"
+#endif
@@ -12,6 +12,7 @@
 
 #pragma once
 #include <OpenGP/SurfaceMesh/SurfaceMesh.h>
+#include <OpenGP/SurfaceMesh/geometry.h>
 
 //=============================================================================
 namespace Eigen{
@@ -33,12 +34,7 @@ namespace OpenGP{
 
 inline Box3 bounding_box(const SurfaceMesh& mesh)
 {
-    auto vpoints = mesh.get_vertex_property<Vec3>("v:point");
-    Box3 bbox;
-    bbox.setNull();
-    for(auto v: mesh.vertices())
-        bbox.extend( vpoints[v] );
-    return bbox;
+    return SurfaceMeshGeometry::bounding_box(mesh);
 }
 
 /// turn bounding box into a bounding cube (same edge lengths)
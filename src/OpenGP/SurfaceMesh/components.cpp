@@ -0,0 +1,169 @@
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Library General Public License Version 2
+// as published by the Free Software Foundation.
+//
+// This file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with OpenGP.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <OpenGP/SurfaceMesh/components.h>
+#include <OpenGP/SurfaceMesh/SurfaceMesh.h>
+#include <OpenGP/util/parallel.h>
+#include <OpenGP/util/union_find.h>
+#include <iostream>
+
+//=============================================================================
+namespace OpenGP {
+//=============================================================================
+
+std::vector<SurfaceMeshComponents::Component> SurfaceMeshComponents::compute(SurfaceMesh& mesh, unsigned int n_threads){
+    typedef SurfaceMesh::Vertex Vertex;
+    typedef SurfaceMesh::Halfedge Halfedge;
+    typedef SurfaceMesh::Edge Edge;
+    typedef SurfaceMesh::Face Face;
+
+    const Index nV = mesh.vertices_size();
+    const Index nE = mesh.edges_size();
+    const Index nF = mesh.faces_size();
+    const SurfaceMesh& cmesh = mesh;
+
+    ///--- unite the endpoints of every edge
+    Union_find sets(nV);
+    parallel_for_chunks(0, nE, [&](Index begin, Index end){
+        for(Index i=begin; i<end; ++i)
+            if(!cmesh.is_deleted(Edge(i)))
+                sets.unite(cmesh.to_vertex(Halfedge(2*i)).idx(), cmesh.to_vertex(Halfedge(2*i+1)).idx());
+    }, n_threads);
+
+    ///--- number the roots in index order, then label the elements
+    std::vector<Index> number(nV, -1);
+    Index n_components = 0;
+    for(Index i=0; i<nV; ++i)
+        if(sets.is_root(i) && !cmesh.is_deleted(Vertex(i)))
+            number[i] = n_components++;
+
+    SurfaceMesh::Vertex_property<Index> vcomponent = mesh.vertex_property<Index>("v:component");
+    SurfaceMesh::Face_property<Index> fcomponent = mesh.face_property<Index>("f:component");
+    Index* vlabel = nV ? &vcomponent.vector()[0] : NULL;
+    Index* flabel = nF ? &fcomponent.vector()[0] : NULL;
+    parallel_for_chunks(0, nV, [&](Index begin, Index end){
+        for(Index i=begin; i<end; ++i)
+            vlabel[i] = cmesh.is_deleted(Vertex(i)) ? -1 : number[sets.find(i)];
+    }, n_threads);
+    parallel_for_chunks(0, nF, [&](Index begin, Index end){
+        for(Index i=begin; i<end; ++i)
+            flabel[i] = cmesh.is_deleted(Face(i)) ? -1 : vlabel[cmesh.to_vertex(cmesh.halfedge(Face(i))).idx()];
+    }, n_threads);
+
+    ///--- sizes and bounding boxes
+    std::vector<Component> components(n_components);
+    for(Component& c: components) c.bbox.setNull();
+    const Vec3* points = mesh.get_vertex_property<Vec3>("v:point").data();
+    for(Index i=0; i<nV; ++i){
+        if(vlabel[i] < 0) continue;
+        Component& c = components[vlabel[i]];
+        ++c.n_vertices;
+        c.bbox.extend(points[i]);
+    }
+    for(Index i=0; i<nF; ++i)
+        if(flabel[i] >= 0) ++components[flabel[i]].n_faces;
+    return components;
+}
+
+//-----------------------------------------------------------------------------
+
+std::vector<SurfaceMesh> SurfaceMeshComponents::split(SurfaceMesh& mesh, const std::vector<Component>* components,
+                                                      unsigned int n_threads){
+    typedef SurfaceMesh::Vertex Vertex;
+    typedef SurfaceMesh::Face Face;
+
+    const SurfaceMesh& cmesh = mesh;
+    if(components && (!cmesh.get_vertex_property<Index>("v:component") || !cmesh.get_face_property<Index>("f:component"))){
+        std::cerr << "[SurfaceMeshComponents] split: the mesh has no component labels, computing them\n";
+        components = NULL;
+    }
+    std::vector<Component> computed;
+    if(!components){
+        computed = compute(mesh, n_threads);
+        components = &computed;
+    }
+    const Index n_components = components->size();
+    const Index nV = mesh.vertices_size();
+    const Index nF = mesh.faces_size();
+    const Index* vlabel = nV ? cmesh.get_vertex_property<Index>("v:component").data() : NULL;
+    const Index* flabel = nF ? cmesh.get_face_property<Index>("f:component").data() : NULL;
+    const Vec3* points = nV ? cmesh.get_vertex_property<Vec3>("v:point").data() : NULL;
+
+    ///--- check the labels (they may predate edits of the mesh), count the
+    ///    elements of every component
+    std::vector<Index> voffset(n_components+1, 0), foffset(n_components+1, 0);
+    bool valid = true;
+    for(Index i=0; i<nV; ++i){
+        if(vlabel[i] >= n_components || (vlabel[i] < 0) != cmesh.is_deleted(Vertex(i))) valid = false;
+        else if(vlabel[i] >= 0) ++voffset[vlabel[i]+1];
+    }
+    for(Index i=0; i<nF; ++i){
+        if(flabel[i] >= n_components || (flabel[i] < 0) != cmesh.is_deleted(Face(i))) valid = false;
+        else if(flabel[i] >= 0){
+            ++foffset[flabel[i]+1];
+            for(Vertex v: cmesh.vertices(Face(i)))
+                if(vlabel[v.idx()] != flabel[i]) valid = false;
+        }
+    }
+    for(Index c=0; c<n_components && valid; ++c)
+        valid = voffset[c+1] == Index((*components)[c].n_vertices) && foffset[c+1] == Index((*components)[c].n_faces);
+    if(!valid){
+        std::cerr << "[SurfaceMeshComponents] split: the component labels do not match the mesh, call compute() first\n";
+        return std::vector<SurfaceMesh>();
+    }
+    for(Index c=0; c<n_components; ++c){
+        voffset[c+1] += voffset[c];
+        foffset[c+1] += foffset[c];
+    }
+    std::vector<Index> vorder(voffset[n_components]), forder(foffset[n_components]);
+    std::vector<Index> local(nV, -1); // index of a vertex in its component
+    {
+        std::vector<Index> vnext(voffset.begin(), voffset.end()-1);
+        for(Index i=0; i<nV; ++i){
+            if(vlabel[i] < 0) continue;
+            local[i] = vnext[vlabel[i]] - voffset[vlabel[i]];
+            vorder[vnext[vlabel[i]]++] = i;
+        }
+        std::vector<Index> fnext(foffset.begin(), foffset.end()-1);
+        for(Index i=0; i<nF; ++i)
+            if(flabel[i] >= 0) forder[fnext[flabel[i]]++] = i;
+    }
+
+    ///--- build the meshes, one job per component
+    std::vector<SurfaceMesh> meshes(n_components);
+    parallel_for_grain(0, n_components, [&](Index begin, Index end){
+        std::vector<Vec3> positions;
+        std::vector<unsigned int> face_sizes;
+        std::vector<Size> indices;
+        for(Index c=begin; c<end; ++c){
+            positions.clear();
+            face_sizes.clear();
+            indices.clear();
+            for(Index k=voffset[c]; k<voffset[c+1]; ++k)
+                positions.push_back(points[vorder[k]]);
+            for(Index k=foffset[c]; k<foffset[c+1]; ++k){
+                unsigned int n = 0;
+                for(Vertex v: mesh.vertices(Face(forder[k]))){
+                    indices.push_back(local[v.idx()]);
+                    ++n;
+                }
+                face_sizes.push_back(n);
+            }
+            meshes[c].build_from_indices(positions, face_sizes, indices, NULL, 1);
+        }
+    }, 16, n_threads);
+    return meshes;
+}
+
+//=============================================================================
+} // namespace OpenGP
+//=============================================================================
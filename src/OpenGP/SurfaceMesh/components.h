@@ -0,0 +1,60 @@
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Library General Public License Version 2
+// as published by the Free Software Foundation.
+//
+// This file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with OpenGP.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+#include <OpenGP/headeronly.h>
+#include <OpenGP/types.h>
+#include <vector>
+
+//=============================================================================
+namespace OpenGP {
+//=============================================================================
+
+/// forward declaration
+class SurfaceMesh;
+
+/// Connected components (vertices connected by edges) of a mesh, found with
+/// a concurrent union-find (Union_find) over the edges. Components are
+/// numbered in the order of their smallest vertex index, so the labels do
+/// not depend on the number of threads (n_threads=0 uses all cores).
+/// Isolated vertices are components without faces.
+class SurfaceMeshComponents{
+public:
+    struct Component{
+        Size n_vertices = 0;
+        Size n_faces = 0;
+        Box3 bbox; ///< of the vertices
+    };
+
+    /// Labels the vertices and faces with their component in the
+    /// "v:component" and "f:component" properties (Index, -1 for deleted
+    /// elements) and returns the components.
+    static HEADERONLY_INLINE std::vector<Component> compute(SurfaceMesh& mesh, unsigned int n_threads=0);
+
+    /** Copies every component into its own mesh, at once: the faces are
+     bucketed by component and each mesh is built in parallel with
+     SurfaceMesh::build_from_indices(). Only the positions are copied; the
+     vertices and faces keep their relative order. Uses the labels of
+     compute(), which runs first if \c components is NULL or the mesh has no
+     labels. Returns no meshes if the labels do not match the mesh or
+     \c components (e.g. the mesh was edited since compute()). */
+    static HEADERONLY_INLINE std::vector<SurfaceMesh> split(SurfaceMesh& mesh, const std::vector<Component>* components=NULL,
+                                                          unsigned int n_threads=0);
+};
+
+//=============================================================================
+} // namespace OpenGP
+//=============================================================================
+
+#ifdef HEADERONLY
+    #include "components.cpp"
+#endif
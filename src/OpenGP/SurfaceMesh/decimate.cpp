@@ -0,0 +1,197 @@
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Library General Public License Version 2
+// as published by the Free Software Foundation.
+//
+// This file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with OpenGP.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <OpenGP/SurfaceMesh/decimate.h>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+//=============================================================================
+namespace OpenGP {
+//=============================================================================
+
+SurfaceMeshDecimator::SurfaceMeshDecimator(SurfaceMesh& mesh) : mesh(mesh){
+    points = mesh.vertex_property<Vec3>("v:point");
+    quadrics = mesh.vertex_property<Quadric>("v:quadric");
+    efeature = mesh.get_edge_property<bool>("e:feature");
+}
+
+//-----------------------------------------------------------------------------
+
+SurfaceMeshDecimator::~SurfaceMeshDecimator(){
+    mesh.remove_vertex_property(quadrics);
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMeshDecimator::initialize(){
+    const Index nV = mesh.vertices_size();
+    const SurfaceMesh& cmesh = mesh;
+    min_cos = std::cos(max_normal_deviation * Scalar(M_PI) / 180);
+
+    ///--- plane of every face, weighted by its area
+    std::vector<Quadric> fquadric(mesh.faces_size());
+    std::vector<Vec3> fnormal(mesh.faces_size(), Vec3(0,0,0));
+    parallel_for_faces(mesh, [&](Face f){
+        Halfedge h = cmesh.halfedge(f);
+        const Vec3& p0 = points[cmesh.to_vertex(h)];
+        const Vec3& p1 = points[cmesh.to_vertex(cmesh.next_halfedge(h))];
+        const Vec3& p2 = points[cmesh.from_vertex(h)];
+        Vec3 n = (p1-p0).cross(p2-p0);
+        const Scalar area2 = n.norm();
+        if(area2 <= std::numeric_limits<Scalar>::min()) return;
+        n /= area2;
+        fnormal[f.idx()] = n;
+        fquadric[f.idx()] = Quadric(n, -n.dot(p0), area2/2);
+    }, 1024, n_threads);
+
+    ///--- each vertex gathers its faces (and the planes through its boundary
+    ///    edges, orthogonal to the surface, which keep the boundary in place)
+    locked.assign(nV, 0);
+    parallel_for_vertices(mesh, [&](Vertex v){
+        Quadric q;
+        bool lock = cmesh.is_isolated(v) || !cmesh.is_manifold(v) || (lock_boundary && cmesh.is_boundary(v));
+        if(!cmesh.is_isolated(v)){
+            for(Halfedge h: cmesh.halfedges(v)){
+                if(efeature && efeature[cmesh.edge(h)]) lock = true;
+                if(!cmesh.is_boundary(h)) q += fquadric[cmesh.face(h).idx()];
+                if(cmesh.is_boundary(cmesh.edge(h))){
+                    const Halfedge g = cmesh.is_boundary(h) ? cmesh.opposite_halfedge(h) : h;
+                    const Vec3 e = points[cmesh.to_vertex(g)] - points[cmesh.from_vertex(g)];
+                    Vec3 n = e.cross(fnormal[cmesh.face(g).idx()]);
+                    if(n.norm() > std::numeric_limits<Scalar>::min()){
+                        n.normalize();
+                        q += Quadric(n, -n.dot(points[v]), e.squaredNorm());
+                    }
+                }
+            }
+        }
+        quadrics[v] = q;
+        locked[v.idx()] = lock;
+    }, 1024, n_threads);
+
+    ///--- cheapest collapse of every vertex
+    target.assign(nV, Halfedge());
+    std::vector<double> cost(nV, 0);
+    parallel_for_vertices(mesh, [&](Vertex v){
+        target[v.idx()] = best_collapse(v, cost[v.idx()]);
+    }, 1024, n_threads);
+
+    std::vector<Mutable_heap<double>::Item> items;
+    for(Index i=0; i<nV; ++i)
+        if(target[i].is_valid()) items.push_back(Mutable_heap<double>::Item(cost[i], i));
+    heap.reset(nV);
+    heap.assign(items);
+    initialized = true;
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceMeshDecimator::collapse_cost(Halfedge h, double& cost, double bound){
+    const Vertex v0 = mesh.from_vertex(h);
+    const Vertex v1 = mesh.to_vertex(h);
+    if(locked[v0.idx()] || mesh.is_deleted(v0) || mesh.is_deleted(v1)) return false;
+
+    // boundary vertices only slide along the boundary
+    if(mesh.is_boundary(v0) && !mesh.is_boundary(mesh.edge(h))) return false;
+
+    // the error first, the topological and geometric checks cost much more
+    const Vec3& p0 = points[v0];
+    const Vec3& p1 = points[v1];
+    cost = (quadrics[v0] + quadrics[v1])(p1);
+    if(cost >= bound) return false;
+    if(!mesh.is_collapse_ok(h)) return false;
+
+    // the faces that remain must not turn too much (or fold over)
+    for(Halfedge g: mesh.halfedges(v0)){
+        if(mesh.is_boundary(g)) continue;
+        const Vertex a = mesh.to_vertex(g);
+        const Vertex b = mesh.to_vertex(mesh.next_halfedge(g));
+        if(a == v1 || b == v1) continue;
+        const Vec3& pa = points[a];
+        const Vec3& pb = points[b];
+        const Vec3 n0 = (pa-p0).cross(pb-p0);
+        const Vec3 n1 = (pa-p1).cross(pb-p1);
+        const Scalar l1 = n1.norm();
+        if(l1 <= std::numeric_limits<Scalar>::min()) return false;
+        if(n0.dot(n1) < min_cos * n0.norm() * l1) return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+SurfaceMesh::Halfedge SurfaceMeshDecimator::best_collapse(Vertex v, double& cost){
+    Halfedge best;
+    if(locked[v.idx()] || mesh.is_deleted(v)) return best;
+    for(Halfedge h: mesh.halfedges(v)){
+        double c;
+        if(collapse_cost(h, c, best.is_valid() ? cost : std::numeric_limits<double>::max())){
+            best = h;
+            cost = c;
+        }
+    }
+    return best;
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMeshDecimator::update(Vertex v){
+    double cost = 0;
+    target[v.idx()] = best_collapse(v, cost);
+    if(target[v.idx()].is_valid())
+        heap.update(v.idx(), cost);
+    else
+        heap.remove(v.idx());
+}
+
+//-----------------------------------------------------------------------------
+
+Size SurfaceMeshDecimator::exec(Size target_faces){
+    if(!mesh.is_triangle_mesh()){
+        std::cerr << "[SurfaceMeshDecimator] The mesh has to be a triangle mesh\n";
+        return 0;
+    }
+    if(!initialized) initialize();
+
+    Size n_collapses = 0;
+    while(mesh.n_faces() > target_faces && mesh.n_vertices() > min_vertices && !heap.empty()){
+        if(heap.top_priority() > max_error) break;
+        const Vertex v0(heap.pop());
+
+        // the neighborhood of the target may have changed since it was chosen
+        const Halfedge h = target[v0.idx()];
+        double cost;
+        if(!collapse_cost(h, cost)){
+            update(v0);
+            continue;
+        }
+
+        const Vertex v1 = mesh.to_vertex(h);
+        quadrics[v1] += quadrics[v0];
+        if(on_collapse) on_collapse(h);
+        mesh.collapse(h);
+        error_ = std::max(error_, cost);
+        ++n_collapses;
+
+        // the costs changed in the one-ring of v1 only
+        update(v1);
+        for(Vertex w: mesh.vertices(v1))
+            update(w);
+    }
+    return n_collapses;
+}
+
+//=============================================================================
+} // namespace OpenGP
+//=============================================================================
@@ -0,0 +1,134 @@
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Library General Public License Version 2
+// as published by the Free Software Foundation.
+//
+// This file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with OpenGP.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+#include <OpenGP/headeronly.h>
+#include <OpenGP/SurfaceMesh/Algorithm.h>
+#include <OpenGP/util/mutable_heap.h>
+#include <functional>
+#include <limits>
+#include <vector>
+
+//=============================================================================
+namespace OpenGP {
+//=============================================================================
+
+/// Error quadric of Garland & Heckbert: sum of squared distances to a set of
+/// planes, a symmetric 4x4 matrix stored as its 10 coefficients (in double,
+/// sums over large patches lose too much in float).
+class Quadric{
+public:
+    Quadric(){ for(int i=0; i<10; ++i) q_[i] = 0; }
+
+    /// squared distance to the plane n.x + d = 0 (|n| = 1), times \c weight
+    Quadric(const Vec3& n, Scalar d, Scalar weight){
+        const double a = n[0], b = n[1], c = n[2], e = d, w = weight;
+        q_[0] = w*a*a; q_[1] = w*a*b; q_[2] = w*a*c; q_[3] = w*a*e;
+        q_[4] = w*b*b; q_[5] = w*b*c; q_[6] = w*b*e;
+        q_[7] = w*c*c; q_[8] = w*c*e;
+        q_[9] = w*e*e;
+    }
+
+    Quadric& operator+=(const Quadric& rhs){
+        for(int i=0; i<10; ++i) q_[i] += rhs.q_[i];
+        return *this;
+    }
+
+    Quadric operator+(const Quadric& rhs) const { return Quadric(*this) += rhs; }
+
+    /// the error at \c p
+    double operator()(const Vec3& p) const {
+        const double x = p[0], y = p[1], z = p[2];
+        return q_[0]*x*x + 2*q_[1]*x*y + 2*q_[2]*x*z + 2*q_[3]*x
+             + q_[4]*y*y + 2*q_[5]*y*z + 2*q_[6]*y
+             + q_[7]*z*z + 2*q_[8]*z
+             + q_[9];
+    }
+
+private:
+    double q_[10];
+};
+
+//-----------------------------------------------------------------------------
+
+/// Quadric error decimation of a triangle mesh by halfedge collapses (the
+/// removed vertex moves onto a neighbor, no new positions are created).
+///
+/// Every vertex keeps its cheapest legal outgoing collapse in a mutable
+/// heap; after a collapse only the one-ring of the remaining vertex is
+/// re-evaluated. A collapse is legal if SurfaceMesh::is_collapse_ok()
+/// allows it, no remaining face turns by more than max_normal_deviation and
+/// the removed vertex is not locked: vertices on "e:feature" edges are
+/// always locked, boundary vertices if lock_boundary (otherwise they only
+/// slide along the boundary).
+///
+/// The mesh keeps its deleted elements, call garbage_collection() afterwards.
+class SurfaceMeshDecimator : public SurfaceMeshAlgorithm{
+public:
+    HEADERONLY_INLINE explicit SurfaceMeshDecimator(SurfaceMesh& mesh);
+    HEADERONLY_INLINE ~SurfaceMeshDecimator();
+
+    /// Collapses the cheapest edges until the mesh has \c target_faces faces
+    /// (or min_vertices vertices), or the next collapse would exceed
+    /// max_error, or none is legal anymore.
+    /// Returns the number of collapses.
+    HEADERONLY_INLINE Size exec(Size target_faces);
+
+    /// largest quadric error of a performed collapse
+    double error() const { return error_; }
+
+/// @{ parameters
+public:
+    /// stop before a collapse with a larger (squared distance) error
+    double max_error = std::numeric_limits<double>::max();
+    /// stop when this many vertices are left
+    Size min_vertices = 0;
+    /// boundary vertices are not removed
+    bool lock_boundary = true;
+    /// largest rotation of a face normal by a collapse (degrees)
+    Scalar max_normal_deviation = 60;
+    /// threads for the initialization (0 = all cores)
+    unsigned int n_threads = 0;
+    /// called with every halfedge right before it is collapsed (e.g. to record a ProgressiveMesh)
+    std::function<void(Halfedge)> on_collapse;
+/// @}
+
+private:
+    /// quadrics, locks and the cheapest collapse of every vertex, in a heap
+    HEADERONLY_INLINE void initialize();
+    /// cheapest legal collapse out of \c v, invalid if there is none
+    HEADERONLY_INLINE Halfedge best_collapse(Vertex v, double& cost);
+    /// cost of collapsing halfedge \c h (from_vertex into to_vertex), false
+    /// if it is not legal or not cheaper than \c bound
+    HEADERONLY_INLINE bool collapse_cost(Halfedge h, double& cost, double bound=std::numeric_limits<double>::max());
+    /// puts \c v back in the heap with its current best collapse (or removes it)
+    HEADERONLY_INLINE void update(Vertex v);
+
+    SurfaceMesh& mesh;
+    VertexProperty<Vec3> points;
+    VertexProperty<Quadric> quadrics;
+    EdgeProperty<bool> efeature;
+    std::vector<char> locked;
+    std::vector<Halfedge> target;       ///< cheapest collapse of each vertex
+    Mutable_heap<double> heap;
+    Scalar min_cos = 0;
+    double error_ = 0;
+    bool initialized = false;
+};
+
+//=============================================================================
+} // namespace OpenGP
+//=============================================================================
+
+#ifdef HEADERONLY
+    #include "decimate.cpp"
+#endif
@@ -0,0 +1,149 @@
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Library General Public License Version 2
+// as published by the Free Software Foundation.
+//
+// This file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with OpenGP.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <OpenGP/SurfaceMesh/geodesics.h>
+#include <OpenGP/util/parallel.h>
+#include <iostream>
+#include <limits>
+
+//=============================================================================
+namespace OpenGP {
+//=============================================================================
+
+SurfaceMeshHeatGeodesics::SurfaceMeshHeatGeodesics(SurfaceMesh& mesh) : mesh(mesh), version(0){}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceMeshHeatGeodesics::update(){
+    if(!mesh.is_triangle_mesh() || mesh.n_vertices() != mesh.vertices_size()){
+        std::cerr << "[SurfaceMeshHeatGeodesics] The mesh has to be a garbage collected triangle mesh\n";
+        return false;
+    }
+    initialized = false;
+
+    const Index nH = mesh.halfedges_size();
+    const Index nF = mesh.faces_size();
+    const Vec3* points = mesh.get_vertex_property<Vec3>("v:point").data();
+
+    ///--- gradients of the hat functions: (n x e) / 2A for the edge e opposite to the vertex
+    gradient.assign(nH, Eigen::Vector3d::Zero());
+    farea.assign(nF, 0.0);
+    double edge_length = parallel_reduce(0, nF, 0.0, [&](Index begin, Index end, double& sum){
+        for(Index i=begin; i<end; ++i){
+            Halfedge h[3];
+            h[0] = mesh.halfedge(Face(i));
+            h[1] = mesh.next_halfedge(h[0]);
+            h[2] = mesh.next_halfedge(h[1]);
+            Eigen::Vector3d p[3];
+            for(int k=0; k<3; ++k)
+                p[k] = points[mesh.from_vertex(h[k]).idx()].cast<double>();
+            const Eigen::Vector3d n = (p[1]-p[0]).cross(p[2]-p[0]);
+            const double area2 = n.norm();
+            farea[i] = 0.5 * area2;
+            for(int k=0; k<3; ++k){
+                if(area2 > std::numeric_limits<double>::min())
+                    gradient[h[k].idx()] = n.cross(p[(k+2)%3] - p[(k+1)%3]) / (area2*area2);
+                sum += (p[(k+1)%3] - p[k]).norm();
+            }
+        }
+    }, [](double a, double b){ return a+b; }, 1024, n_threads);
+    edge_length /= 3 * std::max<Index>(nF, 1);
+
+    ///--- the two systems
+    SparseMatrix L, M;
+    SurfaceMeshLaplacian::cotan(mesh, L, n_threads);
+    SurfaceMeshLaplacian::mass(mesh, M, n_threads);
+    const double t = time_factor * edge_length * edge_length;
+
+    // -L is only semidefinite (constants are in its kernel): a tiny shift
+    // makes it definite, the constant it adds is removed with the offset
+    SparseMatrix A = M - t * L;
+    SparseMatrix P = -L;
+    const double shift = 1e-10 * P.diagonal().mean();
+    for(Index i=0; i<P.outerSize(); ++i)
+        P.coeffRef(i, i) += shift;
+
+    if(!heat.compute(mesh, A) || !poisson.compute(mesh, P)){
+        std::cerr << "[SurfaceMeshHeatGeodesics] Factorization failed\n";
+        return false;
+    }
+    version = mesh.topology_version();
+    initialized = true;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceMeshHeatGeodesics::compute(const std::vector<Sources>& source_sets, Eigen::MatrixXd& distances){
+    if((!initialized || version != mesh.topology_version()) && !update())
+        return false;
+
+    const Index nV = mesh.vertices_size();
+    const Index nF = mesh.faces_size();
+    const Index n_sets = source_sets.size();
+
+    ///--- heat flow from the sources
+    Eigen::MatrixXd u = Eigen::MatrixXd::Zero(nV, n_sets);
+    for(Index s=0; s<n_sets; ++s)
+        for(Vertex v: source_sets[s])
+            u(v.idx(), s) = 1;
+    u = heat.solve(u);
+
+    ///--- unit vector field X = -grad u / |grad u| per face,
+    ///    its integrated divergence gathered per vertex
+    std::vector<Eigen::Vector3d> X(nF);
+    Eigen::MatrixXd b(nV, n_sets);
+    for(Index s=0; s<n_sets; ++s){
+        parallel_for_faces(mesh, [&](Face f){
+            Eigen::Vector3d g = Eigen::Vector3d::Zero();
+            for(Halfedge h: mesh.halfedges(f))
+                g += u(mesh.from_vertex(h).idx(), s) * gradient[h.idx()];
+            const double norm = g.norm();
+            X[f.idx()] = (norm > 0) ? Eigen::Vector3d(-g / norm) : Eigen::Vector3d::Zero();
+        }, 1024, n_threads);
+        parallel_for_vertices(mesh, [&](Vertex v){
+            double div = 0;
+            for(Halfedge h: mesh.halfedges(v))
+                if(!mesh.is_boundary(h))
+                    div += farea[mesh.face(h).idx()] * gradient[h.idx()].dot(X[mesh.face(h).idx()]);
+            b(v.idx(), s) = div;
+        }, 1024, n_threads);
+    }
+
+    ///--- the distance has this gradient: -L phi = div X, zero at the sources
+    distances = poisson.solve(b);
+    for(Index s=0; s<n_sets; ++s){
+        double offset = std::numeric_limits<double>::max();
+        for(Vertex v: source_sets[s])
+            offset = std::min(offset, distances(v.idx(), s));
+        if(!source_sets[s].empty())
+            distances.col(s).array() -= offset;
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceMeshHeatGeodesics::compute(const Sources& sources){
+    Eigen::MatrixXd distances;
+    if(!compute(std::vector<Sources>(1, sources), distances))
+        return false;
+
+    VertexProperty<Scalar> geodesic = mesh.vertex_property<Scalar>("v:geodesic");
+    for(Vertex v: mesh.vertices())
+        geodesic[v] = Scalar(distances(v.idx(), 0));
+    return true;
+}
+
+//=============================================================================
+} // namespace OpenGP
+//=============================================================================
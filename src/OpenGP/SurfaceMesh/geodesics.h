@@ -0,0 +1,75 @@
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Library General Public License Version 2
+// as published by the Free Software Foundation.
+//
+// This file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with OpenGP.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+#include <OpenGP/headeronly.h>
+#include <OpenGP/SurfaceMesh/Algorithm.h>
+#include <OpenGP/SurfaceMesh/laplacian.h>
+#include <vector>
+
+//=============================================================================
+namespace OpenGP {
+//=============================================================================
+
+/// Geodesic distances on a triangle mesh with the heat method (Crane et al.
+/// 2013): heat diffused from the sources for a short time t gives the
+/// direction of the distance gradient, a Poisson equation then recovers the
+/// distance from it.
+///
+/// The two systems, M - t L for the heat and -L for the Poisson equation,
+/// are factorized on the first query after a change of the connectivity
+/// (see SurfaceMeshFactorization); later queries only cost the
+/// back-substitutions and two parallel passes over the faces. Call update()
+/// after moving vertices. The mesh has to be garbage collected.
+class SurfaceMeshHeatGeodesics : public SurfaceMeshAlgorithm{
+public:
+    typedef std::vector<Vertex> Sources;
+
+    HEADERONLY_INLINE explicit SurfaceMeshHeatGeodesics(SurfaceMesh& mesh);
+
+    /// Distances to the nearest of \c sources, written to the "v:geodesic"
+    /// property. Returns false if the systems could not be factorized.
+    HEADERONLY_INLINE bool compute(const Sources& sources);
+
+    /// Distances for several source sets at once, one column of \c distances
+    /// per set (the solves share the factorizations and run as one block).
+    HEADERONLY_INLINE bool compute(const std::vector<Sources>& source_sets, Eigen::MatrixXd& distances);
+
+    /// rebuilds the systems for new vertex positions (the symbolic analysis is kept)
+    HEADERONLY_INLINE bool update();
+
+    /// heat diffusion time in units of the squared mean edge length: 1 as in
+    /// the paper, larger values give smoother distances
+    Scalar time_factor = 1;
+
+    /// number of threads of the parallel passes, 0 uses all cores
+    unsigned int n_threads = 0;
+
+private:
+    typedef SurfaceMeshLaplacian::SparseMatrix SparseMatrix;
+
+    SurfaceMesh& mesh;
+    size_t version;               ///< topology_version() of the systems
+    bool initialized = false;
+    std::vector<Eigen::Vector3d> gradient; ///< per halfedge h: gradient in face(h) of the hat function of from_vertex(h)
+    std::vector<double> farea;
+    SurfaceMeshFactorization heat;
+    SurfaceMeshFactorization poisson;
+};
+
+//=============================================================================
+} // namespace OpenGP
+//=============================================================================
+
+#ifdef HEADERONLY
+    #include "geodesics.cpp"
+#endif
@@ -0,0 +1,236 @@
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Library General Public License Version 2
+// as published by the Free Software Foundation.
+//
+// This file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with OpenGP.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <OpenGP/SurfaceMesh/geometry.h>
+#include <OpenGP/SurfaceMesh/SurfaceMesh.h>
+#include <OpenGP/SurfaceMesh/normals.h>
+#include <OpenGP/util/parallel.h>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+//=============================================================================
+namespace OpenGP {
+//=============================================================================
+
+void SurfaceMeshGeometry::update_edge_lengths(SurfaceMesh& mesh, unsigned int n_threads){
+    typedef SurfaceMesh::Halfedge Halfedge;
+    typedef SurfaceMesh::Edge Edge;
+
+    const Index nE = mesh.edges_size();
+    const SurfaceMesh& cmesh = mesh;
+    const Vec3* points = mesh.get_vertex_property<Vec3>("v:point").data();
+    SurfaceMesh::Edge_property<Scalar> elengths = mesh.edge_property<Scalar>("e:length");
+    Scalar* elength = nE ? &elengths.vector()[0] : NULL;
+    const bool garbage = (mesh.n_edges() != mesh.edges_size());
+
+    parallel_for_chunks(0, nE, [&](Index begin, Index end){
+        for(Index i=begin; i<end; ++i){
+            if(garbage && cmesh.is_deleted(Edge(i))){ elength[i] = 0; continue; }
+            const Vec3& a = points[cmesh.to_vertex(Halfedge(2*i)).idx()];
+            const Vec3& b = points[cmesh.to_vertex(Halfedge(2*i+1)).idx()];
+            elength[i] = (a-b).norm();
+        }
+    }, n_threads);
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMeshGeometry::update_face_areas(SurfaceMesh& mesh, unsigned int n_threads){
+    typedef SurfaceMesh::Halfedge Halfedge;
+    typedef SurfaceMesh::Face Face;
+
+    const Index nF = mesh.faces_size();
+    const SurfaceMesh& cmesh = mesh;
+    const Vec3* points = mesh.get_vertex_property<Vec3>("v:point").data();
+    SurfaceMesh::Face_property<Scalar> fareas = mesh.face_property<Scalar>("f:area");
+    Scalar* farea = nF ? &fareas.vector()[0] : NULL;
+    const bool garbage = (mesh.n_faces() != mesh.faces_size());
+
+    parallel_for_chunks(0, nF, [&](Index begin, Index end){
+        for(Index i=begin; i<end; ++i){
+            Face f(i);
+            if(garbage && cmesh.is_deleted(f)){ farea[i] = 0; continue; }
+
+            Halfedge h0 = cmesh.halfedge(f);
+            Halfedge h1 = cmesh.next_halfedge(h0);
+            Halfedge h2 = cmesh.next_halfedge(h1);
+            const Vec3& p0 = points[cmesh.to_vertex(h0).idx()];
+            const Vec3& p1 = points[cmesh.to_vertex(h1).idx()];
+            const Vec3& p2 = points[cmesh.to_vertex(h2).idx()];
+
+            if(cmesh.next_halfedge(h2) == h0){ // face is a triangle
+                farea[i] = Scalar(0.5) * (p1-p0).cross(p2-p0).norm();
+            } else { // face is a general polygon
+                Vec3 vector_area(0,0,0);
+                Halfedge h = h0;
+                do{
+                    Halfedge hn = cmesh.next_halfedge(h);
+                    vector_area += points[cmesh.to_vertex(h).idx()].cross(points[cmesh.to_vertex(hn).idx()]);
+                    h = hn;
+                } while(h != h0);
+                farea[i] = Scalar(0.5) * vector_area.norm();
+            }
+        }
+    }, n_threads);
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMeshGeometry::update_vertex_areas(SurfaceMesh& mesh, unsigned int n_threads){
+    typedef SurfaceMesh::Vertex Vertex;
+    typedef SurfaceMesh::Halfedge Halfedge;
+    typedef SurfaceMesh::Face Face;
+
+    const Index nV = mesh.vertices_size();
+    const Index nH = mesh.halfedges_size();
+    const Index nF = mesh.faces_size();
+    const SurfaceMesh& cmesh = mesh;
+    const Vec3* points = mesh.get_vertex_property<Vec3>("v:point").data();
+    const Scalar eps = std::numeric_limits<Scalar>::min();
+
+    ///--- pass 1: the share of its face for the corner at the start of each halfedge
+    std::vector<Scalar> hcorner(nH, Scalar(0));
+    parallel_for_chunks(0, nF, [&](Index begin, Index end){
+        for(Index i=begin; i<end; ++i){
+            Face f(i);
+            if(cmesh.is_deleted(f)) continue;
+
+            Halfedge h0 = cmesh.halfedge(f);
+            Halfedge h1 = cmesh.next_halfedge(h0);
+            Halfedge h2 = cmesh.next_halfedge(h1);
+
+            if(cmesh.next_halfedge(h2) == h0){ // triangle: mixed Voronoi areas
+                const Halfedge h[3] = { h0, h1, h2 };
+                for(int k=0; k<3; ++k){
+                    // corner p, the next corners q and r
+                    const Vec3& p = points[cmesh.to_vertex(h[(k+2)%3]).idx()];
+                    const Vec3& q = points[cmesh.to_vertex(h[k]).idx()];
+                    const Vec3& r = points[cmesh.to_vertex(h[(k+1)%3]).idx()];
+                    const Vec3 pq = q-p, pr = r-p, qr = r-q;
+                    const Scalar area = Scalar(0.5) * pq.cross(pr).norm();
+                    Scalar a = 0;
+                    if(area > eps){
+                        const Scalar dp =  pq.dot(pr);
+                        const Scalar dq = -pq.dot(qr);
+                        const Scalar dr =  pr.dot(qr);
+                        if(dp < 0)
+                            a = Scalar(0.5) * area;
+                        else if(dq < 0 || dr < 0)
+                            a = Scalar(0.25) * area;
+                        else // cot(q) = dq / (2 area), cot(r) = dr / (2 area)
+                            a = (pr.squaredNorm()*dq + pq.squaredNorm()*dr) / (16*area);
+                    }
+                    hcorner[h[k].idx()] = a;
+                }
+            } else { // polygon: equal shares of the vector area
+                Vec3 vector_area(0,0,0);
+                int n = 0;
+                Halfedge h = h0;
+                do{
+                    Halfedge hn = cmesh.next_halfedge(h);
+                    vector_area += points[cmesh.to_vertex(h).idx()].cross(points[cmesh.to_vertex(hn).idx()]);
+                    ++n;
+                    h = hn;
+                } while(h != h0);
+                const Scalar a = Scalar(0.5) * vector_area.norm() / n;
+                do{
+                    hcorner[h.idx()] = a;
+                    h = cmesh.next_halfedge(h);
+                } while(h != h0);
+            }
+        }
+    }, n_threads);
+
+    ///--- pass 2: each vertex gathers its corners
+    SurfaceMesh::Vertex_property<Scalar> vareas = mesh.vertex_property<Scalar>("v:area");
+    Scalar* varea = nV ? &vareas.vector()[0] : NULL;
+    parallel_for_chunks(0, nV, [&](Index begin, Index end){
+        for(Index i=begin; i<end; ++i){
+            Scalar a = 0;
+            Halfedge h = cmesh.halfedge(Vertex(i));
+            if(!cmesh.is_deleted(Vertex(i)) && h.is_valid()){
+                const Halfedge hend = h;
+                do{
+                    a += hcorner[h.idx()];
+                    h = cmesh.cw_rotated_halfedge(h);
+                } while(h != hend);
+            }
+            varea[i] = a;
+        }
+    }, n_threads);
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMeshGeometry::update_dihedral_angles(SurfaceMesh& mesh, unsigned int n_threads){
+    typedef SurfaceMesh::Halfedge Halfedge;
+    typedef SurfaceMesh::Edge Edge;
+
+    SurfaceMeshNormals::update_face_normals(mesh, n_threads);
+
+    const Index nE = mesh.edges_size();
+    const SurfaceMesh& cmesh = mesh;
+    const Vec3* points = mesh.get_vertex_property<Vec3>("v:point").data();
+    const Vec3* fnormal = mesh.get_face_property<Vec3>("f:normal").data();
+    SurfaceMesh::Edge_property<Scalar> edihedrals = mesh.edge_property<Scalar>("e:dihedral");
+    Scalar* edihedral = nE ? &edihedrals.vector()[0] : NULL;
+
+    parallel_for_chunks(0, nE, [&](Index begin, Index end){
+        for(Index i=begin; i<end; ++i){
+            Halfedge h0(2*i), h1(2*i+1);
+            if(cmesh.is_deleted(Edge(i)) || cmesh.is_boundary(h0) || cmesh.is_boundary(h1)){
+                edihedral[i] = 0;
+                continue;
+            }
+            const Vec3& n0 = fnormal[cmesh.face(h0).idx()];
+            const Vec3& n1 = fnormal[cmesh.face(h1).idx()];
+            const Vec3 d = points[cmesh.to_vertex(h0).idx()] - points[cmesh.to_vertex(h1).idx()];
+            // the cosine is clamped against rounding, only the sign of the sine matters
+            const Scalar c = std::min(Scalar(1), std::max(Scalar(-1), n0.dot(n1)));
+            const Scalar a = std::acos(c);
+            edihedral[i] = (n0.cross(n1).dot(d) >= 0) ? a : -a;
+        }
+    }, n_threads);
+}
+
+//-----------------------------------------------------------------------------
+
+Box3 SurfaceMeshGeometry::bounding_box(const SurfaceMesh& mesh, unsigned int n_threads){
+    typedef SurfaceMesh::Vertex Vertex;
+
+    const Index nV = mesh.vertices_size();
+    const Vec3* points = mesh.get_vertex_property<Vec3>("v:point").data();
+
+    Box3 bbox;
+    bbox.setNull();
+    std::mutex mutex;
+    parallel_for_chunks(0, nV, [&](Index begin, Index end){
+        Vec3 lo = Vec3::Constant( std::numeric_limits<Scalar>::max());
+        Vec3 hi = Vec3::Constant(-std::numeric_limits<Scalar>::max());
+        for(Index i=begin; i<end; ++i){
+            if(mesh.is_deleted(Vertex(i))) continue;
+            lo = lo.cwiseMin(points[i]);
+            hi = hi.cwiseMax(points[i]);
+        }
+        if(lo.x() > hi.x()) return; // no vertex in the chunk
+        std::lock_guard<std::mutex> lock(mutex);
+        bbox.extend(lo);
+        bbox.extend(hi);
+    }, n_threads);
+    return bbox;
+}
+
+//=============================================================================
+} // namespace OpenGP
+//=============================================================================
@@ -0,0 +1,61 @@
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Library General Public License Version 2
+// as published by the Free Software Foundation.
+//
+// This file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with OpenGP.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+#include <OpenGP/headeronly.h>
+#include <OpenGP/types.h>
+
+//=============================================================================
+namespace OpenGP {
+//=============================================================================
+
+/// forward declaration
+class SurfaceMesh;
+
+/// Batch geometry kernels: each quantity is computed for all elements in one
+/// multithreaded pass over the raw point array and the connectivity, instead
+/// of one call per handle (SurfaceMesh::edge_length, compute_face_normal...).
+///
+/// Every output element is written by exactly one thread and per-vertex sums
+/// gather their corners in circulation order, so results do not depend on
+/// the number of threads (n_threads=0 uses all cores). Deleted elements are
+/// set to 0.
+class SurfaceMeshGeometry{
+public:
+    /// computes the "e:length" property
+    static HEADERONLY_INLINE void update_edge_lengths(SurfaceMesh& mesh, unsigned int n_threads=0);
+
+    /// computes the "f:area" property (polygons: area of the vector area)
+    static HEADERONLY_INLINE void update_face_areas(SurfaceMesh& mesh, unsigned int n_threads=0);
+
+    /// computes the "v:area" property: mixed Voronoi area of the triangles
+    /// (Meyer et al. 2003), polygons give an equal share to each corner.
+    /// The areas of all vertices sum to the surface area.
+    static HEADERONLY_INLINE void update_vertex_areas(SurfaceMesh& mesh, unsigned int n_threads=0);
+
+    /// computes the "e:dihedral" property: angle in [-pi,pi] between the
+    /// normals of the two faces of an edge, with the sign of
+    /// (n0 x n1) . (edge vector of halfedge 0), 0 at the boundary.
+    /// Updates "f:normal" on the way.
+    static HEADERONLY_INLINE void update_dihedral_angles(SurfaceMesh& mesh, unsigned int n_threads=0);
+
+    /// bounding box of the (non deleted) vertices
+    static HEADERONLY_INLINE Box3 bounding_box(const SurfaceMesh& mesh, unsigned int n_threads=0);
+};
+
+//=============================================================================
+} // namespace OpenGP
+//=============================================================================
+
+#ifdef HEADERONLY
+    #include "geometry.cpp"
+#endif
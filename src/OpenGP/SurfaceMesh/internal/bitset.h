@@ -0,0 +1,316 @@
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Library General Public License Version 2
+// as published by the Free Software Foundation.
+//
+// This file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with OpenGP.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+#include <OpenGP/util/memory_resource.h>
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+//=============================================================================
+namespace OpenGP {
+//=============================================================================
+
+
+/// index of the lowest set bit of a non-zero word
+inline int bitset_lowest_bit(uint64_t w)
+{
+    assert(w != 0);
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(w);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long i; _BitScanForward64(&i, w); return (int)i;
+#else
+    int i = 0; while (!(w & 1)) { w >>= 1; ++i; } return i;
+#endif
+}
+
+/// index of the highest set bit of a non-zero word
+inline int bitset_highest_bit(uint64_t w)
+{
+    assert(w != 0);
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(w);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long i; _BitScanReverse64(&i, w); return (int)i;
+#else
+    int i = 63; while (!(w >> 63)) { w <<= 1; --i; } return i;
+#endif
+}
+
+/// number of set bits of a word
+inline int bitset_popcount(uint64_t w)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(w);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    return (int)__popcnt64(w);
+#else
+    int n = 0; for (; w; w &= w-1) ++n; return n;
+#endif
+}
+
+
+/// Atomic (relaxed) w |= m and w &= m: threads writing bits of the same word,
+/// e.g. neighbouring elements in a parallel loop, do not lose updates.
+inline void bitset_atomic_or(uint64_t* w, uint64_t m)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __atomic_fetch_or(w, m, __ATOMIC_RELAXED);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    _InterlockedOr64(reinterpret_cast<volatile __int64*>(w), (__int64)m);
+#else
+    *w |= m;
+#endif
+}
+
+inline void bitset_atomic_and(uint64_t* w, uint64_t m)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __atomic_fetch_and(w, m, __ATOMIC_RELAXED);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    _InterlockedAnd64(reinterpret_cast<volatile __int64*>(w), (__int64)m);
+#else
+    *w &= m;
+#endif
+}
+
+/// relaxed atomic load of a word another thread may be writing bits of
+inline uint64_t bitset_atomic_load(const uint64_t* w)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __atomic_load_n(w, __ATOMIC_RELAXED);
+#else
+    return *static_cast<const volatile uint64_t*>(w);
+#endif
+}
+
+
+//== CLASS DEFINITION =========================================================
+
+
+/// Storage of bool properties: a std::vector<bool> look-alike whose 64-bit
+/// words are accessible, so that runs of equal bits can be skipped a word at
+/// a time (e.g. deleted elements in the mesh iterators).
+/// Bits past size() in the last word are always zero. Single bits can be
+/// read and written from parallel loops (see reference), resizing can not.
+class Bitset
+{
+public:
+
+    typedef bool                        value_type;
+    typedef Resource_allocator<bool>    allocator_type;
+    typedef uint64_t                    word_type;
+
+    /// proxy to a single bit
+    class reference
+    {
+    public:
+        reference(word_type* w, word_type m) : word_(w), mask_(m) {}
+        operator bool() const { return (bitset_atomic_load(word_) & mask_) != 0; }
+        /// atomic, so that bits of the same word can be written concurrently
+        /// (only words whose bit changes pay for the atomic operation)
+        reference& operator=(bool b)
+        {
+            if (bool(*this) == b) return *this;
+            if (b) bitset_atomic_or(word_, mask_); else bitset_atomic_and(word_, ~mask_);
+            return *this;
+        }
+        reference& operator=(const reference& rhs) { return operator=(bool(rhs)); }
+    private:
+        word_type* word_;
+        word_type  mask_;
+    };
+    typedef bool const_reference;
+
+    /// read-only iterator over the bits
+    class const_iterator
+    {
+    public:
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef bool            value_type;
+        typedef std::ptrdiff_t  difference_type;
+        typedef const bool*     pointer;
+        typedef bool            reference;
+
+        const_iterator(const Bitset* b=NULL, size_t i=0) : bits_(b), i_(i) {}
+        bool operator*() const { return (*bits_)[i_]; }
+        const_iterator& operator++() { ++i_; return *this; }
+        const_iterator& operator--() { --i_; return *this; }
+        const_iterator& operator+=(std::ptrdiff_t n) { i_ += n; return *this; }
+        const_iterator operator+(std::ptrdiff_t n) const { return const_iterator(bits_, i_+n); }
+        std::ptrdiff_t operator-(const const_iterator& rhs) const { return std::ptrdiff_t(i_) - std::ptrdiff_t(rhs.i_); }
+        bool operator==(const const_iterator& rhs) const { return i_ == rhs.i_; }
+        bool operator!=(const const_iterator& rhs) const { return i_ != rhs.i_; }
+    private:
+        const Bitset* bits_;
+        size_t i_;
+    };
+
+
+public:
+
+    explicit Bitset(const allocator_type& alloc=allocator_type()) : words_(word_allocator(alloc)), size_(0) {}
+
+    Bitset(const Bitset& rhs) : words_(rhs.words_), size_(rhs.size_) {}
+
+    Bitset& operator=(const Bitset& rhs)
+    {
+        words_ = rhs.words_;
+        size_ = rhs.size_;
+        return *this;
+    }
+
+    Bitset& operator=(Bitset&& rhs)
+    {
+        words_ = std::move(rhs.words_);
+        size_ = rhs.size_;
+        rhs.size_ = 0;
+        return *this;
+    }
+
+    void swap(Bitset& rhs)
+    {
+        words_.swap(rhs.words_);
+        std::swap(size_, rhs.size_);
+    }
+
+    allocator_type get_allocator() const { return allocator_type(words_.get_allocator()); }
+
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    size_t capacity() const { return 64*words_.capacity(); }
+    void reserve(size_t n) { words_.reserve(n_words(n)); }
+
+    void resize(size_t n, bool value=false)
+    {
+        if (n > size_ && value)
+        {
+            // fill the tail of the current last word, whole new words are set below
+            if (size_ % 64) words_.back() |= ~word_type(0) << (size_ % 64);
+        }
+        words_.resize(n_words(n), value ? ~word_type(0) : word_type(0));
+        size_ = n;
+        clear_tail();
+    }
+
+    void push_back(bool value)
+    {
+        if (size_ % 64 == 0) words_.push_back(0);
+        ++size_;
+        if (value) words_.back() |= word_type(1) << ((size_-1) % 64);
+    }
+
+    void clear() { words_.clear(); size_ = 0; }
+
+    template <class Iterator> void assign(Iterator first, Iterator last)
+    {
+        clear();
+        for (; first != last; ++first) push_back(bool(*first));
+    }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size_); }
+
+
+    reference operator[](size_t i)
+    {
+        assert(i < size_);
+        return reference(&words_[i/64], word_type(1) << (i%64));
+    }
+
+    bool operator[](size_t i) const
+    {
+        assert(i < size_);
+        return (bitset_atomic_load(&words_[i/64]) >> (i%64)) & 1;
+    }
+
+
+public: //------------------------------------------------------ word access
+
+    /// number of 64-bit words holding n bits
+    static size_t n_words(size_t n) { return (n + 63) / 64; }
+
+    /// the words, bit i is bit i%64 of word i/64
+    const word_type* words() const { return words_.empty() ? NULL : &words_[0]; }
+
+    /// number of set bits
+    size_t count() const
+    {
+        size_t n = 0;
+        for (size_t w=0; w<words_.size(); ++w)
+            n += bitset_popcount(words_[w]);
+        return n;
+    }
+
+    /// first index >= i whose bit equals \c value, size() if there is none
+    size_t find_next(size_t i, bool value) const
+    {
+        if (i >= size_) return size_;
+        const word_type flip = value ? 0 : ~word_type(0);
+        size_t w = i/64;
+        word_type bits = (words_[w] ^ flip) & (~word_type(0) << (i%64));
+        while (!bits)
+        {
+            if (++w == words_.size()) return size_;
+            bits = words_[w] ^ flip;
+        }
+        const size_t j = 64*w + bitset_lowest_bit(bits);
+        return (j < size_) ? j : size_;
+    }
+
+    /// last index <= i whose bit equals \c value, -1 if there is none
+    std::ptrdiff_t find_prev(std::ptrdiff_t i, bool value) const
+    {
+        if (i < 0 || size_ == 0) return -1;
+        if (size_t(i) >= size_) i = std::ptrdiff_t(size_) - 1;
+        const word_type flip = value ? 0 : ~word_type(0);
+        std::ptrdiff_t w = i/64;
+        word_type bits = (words_[w] ^ flip) & (~word_type(0) >> (63 - i%64));
+        while (!bits)
+        {
+            if (--w < 0) return -1;
+            bits = words_[w] ^ flip;
+        }
+        return 64*w + bitset_highest_bit(bits);
+    }
+
+
+private:
+
+    static Resource_allocator<word_type> word_allocator(const allocator_type& alloc)
+    {
+        return Resource_allocator<word_type>(alloc.resource());
+    }
+
+    /// keeps the bits past size() zero, so that words can be used as they are
+    void clear_tail()
+    {
+        if (size_ % 64) words_.back() &= ~(~word_type(0) << (size_ % 64));
+    }
+
+
+private:
+    std::vector<word_type, Resource_allocator<word_type> > words_;
+    size_t size_;
+};
+
+
+//=============================================================================
+} // namespace OpenGP
+//=============================================================================
@@ -0,0 +1,176 @@
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Library General Public License Version 2
+// as published by the Free Software Foundation.
+//
+// This file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with OpenGP.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+#include <cstddef>
+#include <vector>
+#include <OpenGP/types.h>
+#include <OpenGP/SurfaceMesh/internal/properties.h>
+
+//=============================================================================
+namespace OpenGP {
+//=============================================================================
+
+
+//== CLASS DEFINITION =========================================================
+
+
+/// Undo log of the element writes of a SurfaceMesh (see
+/// SurfaceMesh::begin_journal): record() saves the old value of an element
+/// before it is overwritten, rollback() restores the values saved since a
+/// position of the log. Every array has its own typed log; writes to
+/// different arrays commute, so each log is simply undone newest first.
+class Journal
+{
+public:
+
+    Journal() : enabled_(false), epoch_(0), position_(0), last_(NULL) {}
+    ~Journal() { clear(); }
+
+    bool enabled() const { return enabled_; }
+
+    /// turns the recording on or off, both forget what was recorded
+    void enable(bool enable)
+    {
+        clear();
+        enabled_ = enable;
+    }
+
+    /// forgets what was recorded: earlier positions become invalid
+    void clear()
+    {
+        for (size_t i=0; i<logs_.size(); ++i)
+            delete logs_[i];
+        logs_.clear();
+        last_ = NULL;
+        position_ = 0;
+        ++epoch_;
+    }
+
+    /// number of writes recorded since the last clear()
+    size_t position() const { return position_; }
+
+    /// changes every time the log is cleared
+    size_t epoch() const { return epoch_; }
+
+    /// saves element \c i of \c array, which is about to be written
+    template <class T> void record(Property_array<T>* array, Index i)
+    {
+        Log<T>* log = find<T>(array);
+        if (!log)
+        {
+            log = new Log<T>(array);
+            logs_.push_back(log);
+        }
+        last_ = log;
+        const Property_array<T>& values = *array;
+        log->entries.push_back(typename Log<T>::Entry(position_++, i, values[i]));
+    }
+
+    /// calls fn(i, old value) for the writes of \c array recorded since
+    /// \c position, e.g. to find the elements a rollback will touch
+    template <class T, class Function> void for_each_since(Property_array<T>* array, size_t position, Function fn) const
+    {
+        const Log<T>* log = find<T>(array);
+        if (!log) return;
+        for (size_t k=log->entries.size(); k>0 && log->entries[k-1].position>=position; --k)
+            fn(log->entries[k-1].index, log->entries[k-1].value);
+    }
+
+    /// restores the elements written since \c position
+    void rollback(size_t position)
+    {
+        for (size_t i=0; i<logs_.size(); ++i)
+            logs_[i]->undo(position);
+        position_ = position;
+    }
+
+    /// drops the log of \c array (e.g. before the array is deleted)
+    void forget(const Base_property_array* array)
+    {
+        for (size_t i=0; i<logs_.size(); ++i)
+        {
+            if (logs_[i]->array() == array)
+            {
+                if (last_ == logs_[i]) last_ = NULL;
+                delete logs_[i];
+                logs_.erase(logs_.begin()+i);
+                return;
+            }
+        }
+    }
+
+
+private:
+
+    struct Base_log
+    {
+        virtual ~Base_log() {}
+        virtual const Base_property_array* array() const = 0;
+        /// restores the values saved at \c position or later, newest first
+        virtual void undo(size_t position) = 0;
+    };
+
+    template <class T>
+    struct Log : public Base_log
+    {
+        struct Entry
+        {
+            Entry(size_t p, Index i, const T& v) : position(p), index(i), value(v) {}
+            size_t position;
+            Index  index;
+            T      value;
+        };
+
+        explicit Log(Property_array<T>* a) : values(a) {}
+
+        const Base_property_array* array() const { return values; }
+
+        void undo(size_t position)
+        {
+            while (!entries.empty() && entries.back().position >= position)
+            {
+                (*values)[entries.back().index] = entries.back().value;
+                entries.pop_back();
+            }
+        }
+
+        Property_array<T>*  values;
+        std::vector<Entry>  entries;
+    };
+
+    /// the log of \c array, NULL if nothing was recorded for it (a handful of
+    /// arrays are journaled at once, consecutive writes mostly hit the same one)
+    template <class T> Log<T>* find(const Property_array<T>* array) const
+    {
+        if (last_ && last_->array() == array) return static_cast<Log<T>*>(last_);
+        for (size_t i=0; i<logs_.size(); ++i)
+            if (logs_[i]->array() == array) return static_cast<Log<T>*>(logs_[i]);
+        return NULL;
+    }
+
+
+private:
+    Journal(const Journal&);
+    Journal& operator=(const Journal&);
+
+    bool                    enabled_;
+    size_t                  epoch_;
+    size_t                  position_;
+    std::vector<Base_log*>  logs_;
+    Base_log*               last_; ///< log of the last write
+};
+
+
+//=============================================================================
+} // namespace OpenGP
+//=============================================================================
@@ -11,22 +11,127 @@
 // License along with OpenGP.  If not, see <http://www.gnu.org/licenses/>.
 
 #pragma once
+#include <cassert>
 #include <vector>
 #include <string>
 #include <algorithm>
 #include <typeinfo>
 #include <iostream>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <OpenGP/util/parallel.h>
+#include <OpenGP/util/memory_resource.h>
+#include <OpenGP/SurfaceMesh/internal/bitset.h>
 
 //=============================================================================
 namespace OpenGP {
 //=============================================================================
 
+/// An interned property name. Every distinct name gets a small integer id
+/// (shared by all containers of the process), which property containers use
+/// for constant time lookup. Keys are cheap to copy and can be \c static:
+/// \code
+/// static const Property_key<Vec3> FNORMAL("f:normal");
+/// auto normals = mesh.face_property(FNORMAL);
+/// \endcode
+class Base_property_key
+{
+public:
+
+    explicit Base_property_key(const std::string& name) : id_(intern(name)), name_(name) {}
+
+    /// the interned id of the name
+    int id() const { return id_; }
+
+    /// the name
+    const std::string& name() const { return name_; }
+
+
+    /// Return the id of \c name, the name is registered if needed.
+    static int intern(const std::string& name)
+    {
+        const int id = find(name);
+        if (id >= 0) return id;
+
+        // registering is rare: copy the table and publish the copy, readers never wait
+        std::lock_guard<std::mutex> lock(registry_mutex());
+        const Table* table = current().load(std::memory_order_acquire);
+        Table::const_iterator it = table->find(name);
+        if (it != table->end()) return it->second;
+        std::unique_ptr<Table> next(new Table(*table));
+        const int new_id = (int) next->size();
+        (*next)[name] = new_id;
+        current().store(next.get(), std::memory_order_release);
+        tables().push_back(std::move(next));
+        return new_id;
+    }
+
+    /// Return the id of \c name, or -1 if no property was ever given this name.
+    /// Lock-free: lookups read an immutable snapshot of the table.
+    static int find(const std::string& name)
+    {
+        const Table* table = current().load(std::memory_order_acquire);
+        Table::const_iterator it = table->find(name);
+        return (it != table->end()) ? it->second : -1;
+    }
+
+
+private:
+
+    typedef std::unordered_map<std::string, int> Table;
+
+    /// the latest snapshot of the table
+    static std::atomic<const Table*>& current()
+    {
+        static const Table empty;
+        static std::atomic<const Table*> table(&empty);
+        return table;
+    }
+
+    /// every snapshot ever published, readers may still hold old ones
+    static std::vector< std::unique_ptr<Table> >& tables()
+    {
+        static std::vector< std::unique_ptr<Table> > all;
+        return all;
+    }
+
+    static std::mutex& registry_mutex()
+    {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+
+private:
+    int id_;
+    std::string name_;
+};
+
+
+/// A property name together with the type of the property.
+template <class T>
+class Property_key : public Base_property_key
+{
+public:
+
+    typedef T value_type;
+
+    explicit Property_key(const std::string& name) : Base_property_key(name) {}
+};
+
+
+
+//== CLASS DEFINITION =========================================================
+
+
 class Base_property_array
 {
 public:
 
     /// Default constructor
-    Base_property_array(const std::string& name) : name_(name) {}
+    Base_property_array(const std::string& name) : name_(name), key_(Base_property_key::intern(name)) {}
 
     /// Destructor.
     virtual ~Base_property_array() {}
@@ -46,19 +151,43 @@ public:
     /// Let two elements swap their storage place.
     virtual void swap(size_t i0, size_t i1) = 0;
 
+    /// Reorder the elements: element i becomes the former element order[i].
+    /// (order may be shorter than the array, which then shrinks)
+    virtual void permute(const std::vector<Index>& order) = 0;
+
+    /// Keep only the elements kept[0] < kept[1] < ..., in place: element i
+    /// becomes the former element kept[i] and the array shrinks to kept.size().
+    virtual void compact(const std::vector<Index>& kept) = 0;
+
+    /// Move the storage to the memory resource \c resource.
+    virtual void set_resource(Memory_resource* resource) = 0;
+
+    /// Whether the elements are shared with a copy made by shared_clone().
+    virtual bool is_shared() const = 0;
+
+    /// Copy the elements if they are shared, so that writing them leaves the copies alone.
+    virtual void unshare() = 0;
+
     /// Return a deep copy of self.
     virtual Base_property_array* clone () const = 0;
 
+    /// Return a copy of self sharing the elements (see Property_container::share()).
+    virtual Base_property_array* shared_clone () const = 0;
+
     /// Return the type_info of the property
     virtual const std::type_info& type() = 0;
 
     /// Return the name of the property
     const std::string& name() const { return name_; }
 
+    /// Return the interned id of the name
+    int key() const { return key_; }
+
 
 protected:
 
     std::string name_;
+    int key_;
 };
 
 
@@ -66,51 +195,130 @@ protected:
 //== CLASS DEFINITION =========================================================
 
 
+/// The storage of a property array: a std::vector drawing from a memory
+/// resource, bool properties are packed in a Bitset.
+template <class T> struct Property_storage { typedef std::vector<T, Resource_allocator<T> > type; };
+template <> struct Property_storage<bool> { typedef Bitset type; };
+
+
 template <class T>
 class Property_array : public Base_property_array
 {
 public:
 
     typedef T                                       value_type;
-    typedef std::vector<value_type>                 vector_type;
+    typedef Resource_allocator<value_type>          allocator_type;
+    typedef typename Property_storage<T>::type      vector_type;
     typedef typename vector_type::reference         reference;
     typedef typename vector_type::const_reference   const_reference;
 
-    Property_array(const std::string& name, T t=T()) : Base_property_array(name), value_(t) {}
+    Property_array(const std::string& name, T t=T(), Memory_resource* resource=new_delete_resource())
+        : Base_property_array(name), data_(std::make_shared<vector_type>(allocator_type(resource))), value_(t) {}
+
+    /// Assignment performs a deep copy, drawn from the memory resource of \c rhs
+    Property_array& operator=(const Property_array& rhs)
+    {
+        if (this != &rhs)
+        {
+            name_  = rhs.name_;
+            key_   = rhs.key_;
+            value_ = rhs.value_;
+            data_  = std::make_shared<vector_type>(*rhs.data_);
+        }
+        return *this;
+    }
 
 
 public: // virtual interface of Base_property_array
 
     virtual void reserve(size_t n)
     {
-        data_.reserve(n);
+        write().reserve(n);
     }
 
     virtual void resize(size_t n)
     {
-        data_.resize(n, value_);
+        write().resize(n, value_);
     }
 
     virtual void push_back()
     {
-        data_.push_back(value_);
+        write().push_back(value_);
     }
 
     virtual void free_memory()
     {
-        vector_type(data_).swap(data_);
+        vector_type& data = write();
+        vector_type(data).swap(data);
     }
 
     virtual void swap(size_t i0, size_t i1)
     {
-        T d(data_[i0]);
-        data_[i0]=data_[i1];
-        data_[i1]=d;
+        vector_type& data = write();
+        T d(data[i0]);
+        data[i0]=data[i1];
+        data[i1]=d;
+    }
+
+    virtual void permute(const std::vector<Index>& order)
+    {
+        // reads the (possibly shared) elements, the result is not shared
+        const vector_type& vec = *data_;
+        std::shared_ptr<vector_type> data = std::make_shared<vector_type>(vec.get_allocator());
+        data->reserve(order.size());
+        for (size_t i=0; i<order.size(); ++i)
+            data->push_back(vec[order[i]]);
+        data_ = data;
+    }
+
+    virtual void compact(const std::vector<Index>& kept)
+    {
+        // gathering into new storage is cheaper than copying shared elements first
+        if (is_shared()) { permute(kept); return; }
+
+        // kept[i] >= i, a single forward pass never overwrites an unread element
+        vector_type& data = write();
+        for (size_t i=0; i<kept.size(); ++i)
+            if ((size_t)kept[i] != i)
+                data[i] = data[kept[i]];
+        data.resize(kept.size(), value_);
+    }
+
+    virtual void set_resource(Memory_resource* resource)
+    {
+        const vector_type& vec = *data_;
+        if (resource == vec.get_allocator().resource()) return;
+        std::shared_ptr<vector_type> data = std::make_shared<vector_type>(allocator_type(resource));
+        data->reserve(vec.capacity());
+        data->assign(vec.begin(), vec.end());
+        data_ = data;
+    }
+
+    virtual bool is_shared() const
+    {
+        return data_.use_count() > 1;
+    }
+
+    virtual void unshare()
+    {
+        // the copies keep the shared elements. Not shared anymore: the last
+        // reads of the copies happen before the writes that follow
+        if (is_shared())
+            data_ = std::make_shared<vector_type>(*data_);
+        else
+            std::atomic_thread_fence(std::memory_order_acquire);
     }
 
     virtual Base_property_array* clone() const
     {
-        Property_array<T>* p = new Property_array<T>(name_, value_);
+        Property_array<T>* p = new Property_array<T>(name_, value_, resource());
+        p->data_ = std::make_shared<vector_type>(*data_);
+        return p;
+    }
+
+    virtual Base_property_array* shared_clone() const
+    {
+        Property_array<T>* p = new Property_array<T>(name_, value_, resource());
         p->data_ = data_;
         return p;
     }
@@ -123,36 +331,61 @@ public:
     /// Get pointer to array (does not work for T==bool)
     const T* data() const
     {
-        return &data_[0];
+        return &vector()[0];
+    }
+
+
+    /// Get reference to the underlying vector, for writing: shared elements
+    /// are copied first (see unshare()).
+    vector_type& vector()
+    {
+        return write();
     }
 
+    /// Get const reference to the underlying vector, never copies.
+    const vector_type& vector() const
+    {
+        return *data_;
+    }
 
-    /// Get reference to the underlying vector
-    std::vector<T>& vector()
+    /// Return the memory resource holding the elements
+    Memory_resource* resource() const
     {
-        return data_;
+        return vector().get_allocator().resource();
     }
 
 
-    /// Access the i'th element. No range check is performed!
-    reference operator[](int _idx)
+    /// Access the i'th element. Does not check for shared elements, they are
+    /// copied when the handle is obtained (see Property_container::get()).
+    /// No range check is performed!
+    reference operator[](Index _idx)
     {
-        assert( size_t(_idx) < data_.size() );
-        return data_[_idx];
+        assert( size_t(_idx) < data_->size() );
+        return (*data_)[_idx];
     }
 
     /// Const access to the i'th element. No range check is performed!
-    const_reference operator[](int _idx) const
+    const_reference operator[](Index _idx) const
     {
-        assert( size_t(_idx) < data_.size());
-        return data_[_idx];
+        assert( size_t(_idx) < data_->size());
+        return (*data_)[_idx];
     }
 
 
 
 private:
-    vector_type data_;
-    value_type  value_;
+
+    /// the elements, ready to be written
+    vector_type& write()
+    {
+        unshare();
+        return *data_;
+    }
+
+
+private:
+    std::shared_ptr<vector_type>  data_; ///< shared with the copies made by shared_clone()
+    value_type                    value_;
 };
 
 
@@ -177,6 +410,7 @@ public:
 
     typedef typename Property_array<T>::reference reference;
     typedef typename Property_array<T>::const_reference const_reference;
+    typedef typename Property_array<T>::vector_type vector_type;
 
     friend class Property_container;
     friend class SurfaceMesh;
@@ -196,31 +430,35 @@ public:
         return parray_ != NULL;
     }
 
-    reference operator[](int i)
+    reference operator[](Index i)
     {
         assert(parray_ != NULL);
         return (*parray_)[i];
     }
 
-    const_reference operator[](int i) const
+    const_reference operator[](Index i) const
     {
-        assert(parray_ != NULL);
-        return (*parray_)[i];
+        return array()[i];
     }
 
     const T* data() const
     {
-        assert(parray_ != NULL);
-        return parray_->data();
+        return array().data();
     }
 
 
-    std::vector<T>& vector()
+    /// Get reference to the underlying vector, copies shared elements first
+    vector_type& vector()
     {
         assert(parray_ != NULL);
         return parray_->vector();
     }
 
+    const vector_type& vector() const
+    {
+        return array().vector();
+    }
+
 
 private:
 
@@ -251,28 +489,35 @@ class Property_container
 public:
 
     // default constructor
-    Property_container() : size_(0) {}
+    Property_container() : size_(0), capacity_(0), resource_(new_delete_resource()), n_name_lookups_(0), n_key_lookups_(0) {}
 
     // destructor (deletes all property arrays)
     virtual ~Property_container() { clear(); }
 
-    // copy constructor: performs deep copy of property arrays
-    Property_container(const Property_container& _rhs) { operator=(_rhs); }
+    // copy constructor: performs a deep copy of the property arrays, and copies the memory resource
+    Property_container(const Property_container& _rhs)
+        : size_(0), capacity_(0), resource_(_rhs.resource_), n_name_lookups_(0), n_key_lookups_(0) { operator=(_rhs); }
 
-    // assignment: performs deep copy of property arrays
+    // assignment: performs a deep copy of the property arrays. The copies are
+    // drawn from the memory resources of the arrays of \c _rhs, not from the
+    // resource of this container (which only serves new arrays).
     Property_container& operator=(const Property_container& _rhs)
     {
-        if (this != &_rhs)
-        {
-            clear();
-            parrays_.resize(_rhs.n_properties());
-            size_ = _rhs.size();
-            for (unsigned int i=0; i<parrays_.size(); ++i)
-                parrays_[i] = _rhs.parrays_[i]->clone();
-        }
+        if (this != &_rhs) copy(_rhs, false);
         return *this;
     }
 
+    // assignment sharing the elements of the arrays with \c _rhs (copy-on-write):
+    // O(#arrays). An array is copied when either container hands out a handle
+    // for it from get() or get_or_add() on a non-const container, its vector()
+    // for writing, or changes its size. Handles obtained before the sharing
+    // write into the shared elements, fetch them again. Both containers can
+    // be read concurrently. The resources of \c _rhs have to outlive the copies.
+    void share(const Property_container& _rhs)
+    {
+        if (this != &_rhs) copy(_rhs, true);
+    }
+
     // returns the current size of the property arrays
     size_t size() const { return size_; }
 
@@ -291,33 +536,57 @@ public:
 
     // add a property with name \c name and default value \c t
     template <class T> Property<T> add(const std::string& name, const T t=T())
+    {
+        return add<T>(Property_key<T>(name), t);
+    }
+
+    // add a property with key \c key and default value \c t
+    template <class T> Property<T> add(const Property_key<T>& key, const T t=T())
     {
         // if a property with this name already exists, return an invalid property
-        for (unsigned int i=0; i<parrays_.size(); ++i)
+        if (find(key.id()))
         {
-            if (parrays_[i]->name() == name)
-            {
-                std::cerr << "[Property_container] A property with name \""
-                          << name << "\" already exists. Returning invalid property.\n";
-                return Property<T>();
-            }
+            std::cerr << "[Property_container] A property with name \""
+                      << key.name() << "\" already exists. Returning invalid property.\n";
+            return Property<T>();
         }
 
         // otherwise add the property
-        Property_array<T>* p = new Property_array<T>(name, t);
+        Property_array<T>* p = new Property_array<T>(key.name(), t, resource_);
+        p->reserve(capacity_);
         p->resize(size_);
         parrays_.push_back(p);
+        slot(key.id()) = p;
         return Property<T>(p);
     }
 
 
     // get a property by its name. returns invalid property if it does not exist.
+    // the elements are not copied if they are shared (see share()), the
+    // property is for reading.
     template <class T> Property<T> get(const std::string& name) const
     {
-        for (unsigned int i=0; i<parrays_.size(); ++i)
-            if (parrays_[i]->name() == name)
-                return Property<T>(dynamic_cast<Property_array<T>*>(parrays_[i]));
-        return Property<T>();
+        n_name_lookups_.fetch_add(1, std::memory_order_relaxed);
+        return Property<T>(dynamic_cast<Property_array<T>*>(find(Base_property_key::find(name))));
+    }
+
+    // get a property by its key (constant time). returns invalid property if it does not exist.
+    template <class T> Property<T> get(const Property_key<T>& key) const
+    {
+        n_key_lookups_.fetch_add(1, std::memory_order_relaxed);
+        return Property<T>(dynamic_cast<Property_array<T>*>(find(key.id())));
+    }
+
+    // get a property by its name for writing: shared elements are copied first
+    template <class T> Property<T> get(const std::string& name)
+    {
+        return writable(static_cast<const Property_container*>(this)->get<T>(name));
+    }
+
+    // get a property by its key for writing: shared elements are copied first
+    template <class T> Property<T> get(const Property_key<T>& key)
+    {
+        return writable(static_cast<const Property_container*>(this)->get<T>(key));
     }
 
 
@@ -329,14 +598,33 @@ public:
         return p;
     }
 
+    // returns a property if it exists, otherwise it creates it first.
+    template <class T> Property<T> get_or_add(const Property_key<T>& key, const T t=T())
+    {
+        Property<T> p = get<T>(key);
+        if (!p) p = add<T>(key, t);
+        return p;
+    }
+
 
     // get the type of property by its name. returns typeid(void) if it does not exist.
-    const std::type_info& get_type(const std::string& name)
+    const std::type_info& get_type(const std::string& name) const
     {
-        for (unsigned int i=0; i<parrays_.size(); ++i)
-            if (parrays_[i]->name() == name)
-                return parrays_[i]->type();
-        return typeid(void);
+        n_name_lookups_.fetch_add(1, std::memory_order_relaxed);
+        Base_property_array* p = find(Base_property_key::find(name));
+        return p ? p->type() : typeid(void);
+    }
+
+
+    // number of lookups by name (string hashing, avoid them in loops) and by key
+    size_t n_name_lookups() const { return n_name_lookups_.load(); }
+    size_t n_key_lookups() const { return n_key_lookups_.load(); }
+
+    // reset the lookup counters
+    void reset_lookup_counters()
+    {
+        n_name_lookups_ = 0;
+        n_key_lookups_ = 0;
     }
 
 
@@ -348,6 +636,7 @@ public:
         {
             if (*it == h.parray_)
             {
+                slot((*it)->key()) = NULL;
                 delete *it;
                 parrays_.erase(it);
                 h.reset();
@@ -363,15 +652,18 @@ public:
         for (unsigned int i=0; i<parrays_.size(); ++i)
             delete parrays_[i];
         parrays_.clear();
-        size_ = 0;
+        by_key_.clear();
+        size_ = capacity_ = 0;
     }
 
 
-    // reserve memory for n entries in all arrays
-    void reserve(size_t n) const
+    // reserve memory for n entries in all arrays (also in the ones added later)
+    void reserve(size_t n)
     {
+        if (n <= capacity_) return;
         for (unsigned int i=0; i<parrays_.size(); ++i)
             parrays_[i]->reserve(n);
+        capacity_ = n;
     }
 
     // resize all arrays to size n
@@ -380,23 +672,46 @@ public:
         for (unsigned int i=0; i<parrays_.size(); ++i)
             parrays_[i]->resize(n);
         size_ = n;
+        capacity_ = std::max(capacity_, n);
     }
 
     // free unused space in all arrays
-    void free_memory() const
+    void free_memory()
     {
         for (unsigned int i=0; i<parrays_.size(); ++i)
             parrays_[i]->free_memory();
+        capacity_ = size_;
     }
 
     // add a new element to each vector
     void push_back()
     {
+        // all arrays grow together, geometrically
+        if (size_ == capacity_) reserve(std::max(size_t(16), 2*capacity_));
         for (unsigned int i=0; i<parrays_.size(); ++i)
             parrays_[i]->push_back();
         ++size_;
     }
 
+    // add n new elements to each vector (a single call per array)
+    void push_back(size_t n)
+    {
+        if (size_+n > capacity_) reserve(std::max(size_+n, 2*capacity_));
+        resize(size_+n);
+    }
+
+
+    // the memory resource of the arrays
+    Memory_resource* resource() const { return resource_; }
+
+    // move all arrays (and the ones added later) to the memory resource \c resource
+    void set_resource(Memory_resource* resource)
+    {
+        resource_ = resource ? resource : new_delete_resource();
+        for (unsigned int i=0; i<parrays_.size(); ++i)
+            parrays_[i]->set_resource(resource_);
+    }
+
     // swap elements i0 and i1 in all arrays
     void swap(size_t i0, size_t i1) const
     {
@@ -404,10 +719,64 @@ public:
             parrays_[i]->swap(i0, i1);
     }
 
+    // reorder all arrays: element i becomes the former element order[i]
+    void permute(const std::vector<Index>& order)
+    {
+        for (unsigned int i=0; i<parrays_.size(); ++i)
+            parrays_[i]->permute(order);
+        size_ = capacity_ = order.size();
+    }
+
+    // keep only the elements kept[0] < kept[1] < ... in all arrays (arrays are compacted concurrently)
+    void compact(const std::vector<Index>& kept, unsigned int n_threads=0)
+    {
+        parallel_for_tasks((int)parrays_.size(), [&](int i){ parrays_[i]->compact(kept); }, n_threads);
+        size_ = kept.size();
+    }
+
+
+private:
+
+    // replace the arrays by (deep or shared) copies of the arrays of \c _rhs
+    void copy(const Property_container& _rhs, bool shared)
+    {
+        clear();
+        parrays_.resize(_rhs.n_properties());
+        size_ = _rhs.size();
+        for (unsigned int i=0; i<parrays_.size(); ++i)
+        {
+            parrays_[i] = shared ? _rhs.parrays_[i]->shared_clone() : _rhs.parrays_[i]->clone();
+            slot(parrays_[i]->key()) = parrays_[i];
+        }
+    }
+
+    template <class T> static Property<T> writable(Property<T> p)
+    {
+        if (p) p.parray_->unshare();
+        return p;
+    }
+
+    // the array stored under key id, NULL if there is none
+    Base_property_array* find(int id) const
+    {
+        return (id >= 0 && id < (int)by_key_.size()) ? by_key_[id] : NULL;
+    }
+
+    Base_property_array*& slot(int id)
+    {
+        if (id >= (int)by_key_.size()) by_key_.resize(id+1, NULL);
+        return by_key_[id];
+    }
+
 
 private:
     std::vector<Base_property_array*>  parrays_;
+    std::vector<Base_property_array*>  by_key_; ///< indexed by the interned key id
     size_t  size_;
+    size_t  capacity_; ///< all arrays have at least this capacity
+    Memory_resource*  resource_;
+    mutable std::atomic<size_t>  n_name_lookups_;
+    mutable std::atomic<size_t>  n_key_lookups_;
 };
 
 //=============================================================================
@@ -0,0 +1,60 @@
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Library General Public License Version 2
+// as published by the Free Software Foundation.
+//
+// This file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with OpenGP.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+#include <cstdint>
+#include <string>
+#include <typeinfo>
+#include <OpenGP/SurfaceMesh/SurfaceMesh.h>
+
+//=============================================================================
+namespace OpenGP {
+namespace internal {
+//=============================================================================
+
+/// The property value types whose arrays can be stored as raw bytes (in a
+/// mapped file or a binary mesh file), each with the tag naming it there.
+/// Calls visitor.apply<T>(tag) for the type T with tag \c tag or type_info
+/// \c type, false if there is none. bool is not raw (see Bitset).
+template <class Visitor>
+bool visit_raw_type(const std::string& tag, const std::type_info& type, Visitor& visitor){
+#define OPENGP_RAW_TYPE(T, name) \
+    if(tag == name || type == typeid(T)) return visitor.template apply<T>(name);
+    OPENGP_RAW_TYPE(SurfaceMesh::Vertex_connectivity,   "vconn")
+    OPENGP_RAW_TYPE(SurfaceMesh::Halfedge_connectivity, "hconn")
+    OPENGP_RAW_TYPE(SurfaceMesh::Face_connectivity,     "fconn")
+    OPENGP_RAW_TYPE(SurfaceMesh::Vertex,                "vertex")
+    OPENGP_RAW_TYPE(SurfaceMesh::Halfedge,              "halfedge")
+    OPENGP_RAW_TYPE(SurfaceMesh::Edge,                  "edge")
+    OPENGP_RAW_TYPE(SurfaceMesh::Face,                  "face")
+    OPENGP_RAW_TYPE(Vec3,                               "vec3")
+    OPENGP_RAW_TYPE(Vec2,                               "vec2")
+    OPENGP_RAW_TYPE(Scalar,                             "scalar")
+    OPENGP_RAW_TYPE(float,                              "float")
+    OPENGP_RAW_TYPE(double,                             "double")
+    OPENGP_RAW_TYPE(Index,                              "index")
+    OPENGP_RAW_TYPE(int,                                "int")
+    OPENGP_RAW_TYPE(unsigned int,                       "uint")
+    OPENGP_RAW_TYPE(int8_t,                             "int8")
+    OPENGP_RAW_TYPE(uint8_t,                            "uint8")
+    OPENGP_RAW_TYPE(int16_t,                            "int16")
+    OPENGP_RAW_TYPE(uint16_t,                           "uint16")
+    OPENGP_RAW_TYPE(int64_t,                            "int64")
+    OPENGP_RAW_TYPE(uint64_t,                           "uint64")
+#undef OPENGP_RAW_TYPE
+    return false;
+}
+
+//=============================================================================
+} // namespace internal
+} // namespace OpenGP
+//=============================================================================
@@ -0,0 +1,168 @@
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Library General Public License Version 2
+// as published by the Free Software Foundation.
+//
+// This file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with OpenGP.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include <OpenGP/SurfaceMesh/internal/bitset.h>
+#include <OpenGP/util/parallel.h>
+
+//=============================================================================
+namespace OpenGP {
+//=============================================================================
+
+
+//== CLASS DEFINITION =========================================================
+
+
+/// Triangle index buffer maintained by SurfaceMesh (see
+/// SurfaceMesh::enable_triangle_buffer): face f owns the indices [3f,3f+3).
+///
+/// Topology changes only mark faces as stale (touch()), they are indexed
+/// again by the next update(). Faces whose indices actually changed stay
+/// dirty until clear_dirty(), so that a consumer can re-upload just them.
+class Triangle_buffer
+{
+public:
+
+    Triangle_buffer() : enabled_(false), all_stale_(true) {}
+
+    bool enabled() const { return enabled_; }
+
+    /// turns the tracking on or off, turning it off frees the buffer
+    void enable(bool enable)
+    {
+        enabled_ = enable;
+        std::vector<uint32_t>().swap(indices_);
+        std::vector<Index>().swap(stale_);
+        dirty_ = Bitset();
+        all_stale_ = true;
+    }
+
+    /// face \c f has to be indexed again (negative ids are ignored)
+    void touch(Index f)
+    {
+        if (all_stale_ || f < 0) return;
+        stale_.push_back(f);
+        // past this point rebuilding everything is cheaper than the list
+        if (stale_.size() > std::max(size_t(1024), indices_.size()/3))
+            invalidate();
+    }
+
+    /// all faces have to be indexed again (e.g. after the elements moved)
+    void invalidate()
+    {
+        all_stale_ = true;
+        std::vector<Index>().swap(stale_);
+    }
+
+    /// whether update() has anything to do
+    bool stale() const { return all_stale_ || !stale_.empty(); }
+
+    /// Brings the buffer up to date for \c n_faces face slots,
+    /// index_face(f, out) writes the three indices of face f to out[0..2].
+    template <class Function>
+    void update(Index n_faces, Function index_face)
+    {
+        const Index n_old = (Index) (indices_.size() / 3);
+        indices_.resize(3*size_t(n_faces));
+        dirty_.resize(n_faces, false);
+
+        // new slots are always dirty, they were never seen by a consumer
+        for (Index f=n_old; f<n_faces; ++f)
+        {
+            index_face(f, &indices_[3*size_t(f)]);
+            dirty_[f] = true;
+        }
+
+        if (all_stale_)
+        {
+            // chunks of whole 64-bit words, so that threads never share a word of dirty_
+            const Index n_words = (Index) Bitset::n_words(std::min(n_old, n_faces));
+            parallel_for_chunks(0, n_words, [&](Index wbegin, Index wend)
+            {
+                const Index fend = std::min(64*wend, std::min(n_old, n_faces));
+                for (Index f=64*wbegin; f<fend; ++f)
+                    reindex(f, index_face);
+            });
+        }
+        else
+        {
+            for (size_t i=0; i<stale_.size(); ++i)
+                if (stale_[i] < std::min(n_old, n_faces))
+                    reindex(stale_[i], index_face);
+        }
+
+        all_stale_ = false;
+        stale_.clear();
+    }
+
+    /// 3 indices per face slot, valid after update(). 32 bit like GPU index
+    /// buffers, also with a 64 bit Index (at most 2^32 vertices then).
+    const std::vector<uint32_t>& indices() const { return indices_; }
+
+    /// face ranges [begin,end) whose indices changed since clear_dirty()
+    std::vector< std::pair<Index,Index> > dirty_ranges() const
+    {
+        std::vector< std::pair<Index,Index> > ranges;
+        size_t begin = dirty_.find_next(0, true);
+        while (begin < dirty_.size())
+        {
+            size_t end = dirty_.find_next(begin, false);
+            ranges.push_back(std::make_pair(Index(begin), Index(end)));
+            begin = dirty_.find_next(end, true);
+        }
+        return ranges;
+    }
+
+    /// number of dirty faces
+    size_t n_dirty() const { return dirty_.count(); }
+
+    /// the consumer is up to date with the current indices
+    void clear_dirty()
+    {
+        const size_t n = dirty_.size();
+        dirty_.clear();
+        dirty_.resize(n, false);
+    }
+
+
+private:
+
+    template <class Function>
+    void reindex(Index f, Function& index_face)
+    {
+        uint32_t t[3];
+        index_face(f, t);
+        uint32_t* slot = &indices_[3*size_t(f)];
+        if (t[0] != slot[0] || t[1] != slot[1] || t[2] != slot[2])
+        {
+            slot[0] = t[0]; slot[1] = t[1]; slot[2] = t[2];
+            dirty_[f] = true;
+        }
+    }
+
+
+private:
+    bool                   enabled_;
+    bool                   all_stale_;
+    std::vector<uint32_t>  indices_;
+    std::vector<Index>     stale_;
+    Bitset                 dirty_;
+};
+
+
+//=============================================================================
+} // namespace OpenGP
+//=============================================================================
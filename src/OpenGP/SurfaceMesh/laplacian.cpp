@@ -0,0 +1,153 @@
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Library General Public License Version 2
+// as published by the Free Software Foundation.
+//
+// This file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with OpenGP.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <OpenGP/SurfaceMesh/laplacian.h>
+#include <OpenGP/SurfaceMesh/SurfaceMesh.h>
+#include <OpenGP/SurfaceMesh/geometry.h>
+#include <OpenGP/util/parallel.h>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+//=============================================================================
+namespace OpenGP {
+//=============================================================================
+
+void SurfaceMeshLaplacian::cotan(const SurfaceMesh& mesh, SparseMatrix& L, unsigned int n_threads){
+    typedef SurfaceMesh::Vertex Vertex;
+    typedef SurfaceMesh::Halfedge Halfedge;
+    typedef SurfaceMesh::Face Face;
+
+    assert(mesh.n_vertices() == mesh.vertices_size());
+    assert(mesh.is_triangle_mesh());
+
+    const Index nV = mesh.vertices_size();
+    const Index nH = mesh.halfedges_size();
+    const Index nF = mesh.faces_size();
+    const Vec3* points = mesh.get_vertex_property<Vec3>("v:point").data();
+
+    ///--- pass 1: half the cotangent of the angle opposite to each halfedge
+    std::vector<double> hcot(nH, 0.0);
+    parallel_for_chunks(0, nF, [&](Index begin, Index end){
+        for(Index i=begin; i<end; ++i){
+            if(mesh.is_deleted(Face(i))) continue;
+            Halfedge h[3];
+            h[0] = mesh.halfedge(Face(i));
+            h[1] = mesh.next_halfedge(h[0]);
+            h[2] = mesh.next_halfedge(h[1]);
+            for(int k=0; k<3; ++k){
+                // halfedge h[k] from p to q, the opposite corner r
+                const Eigen::Vector3d p = points[mesh.to_vertex(h[(k+2)%3]).idx()].cast<double>();
+                const Eigen::Vector3d q = points[mesh.to_vertex(h[k]).idx()].cast<double>();
+                const Eigen::Vector3d r = points[mesh.to_vertex(h[(k+1)%3]).idx()].cast<double>();
+                const Eigen::Vector3d rp = p-r, rq = q-r;
+                const double area2 = rp.cross(rq).norm();
+                hcot[h[k].idx()] = (area2 > std::numeric_limits<double>::min()) ? 0.5 * rp.dot(rq) / area2 : 0.0;
+            }
+        }
+    }, n_threads);
+
+    ///--- pass 2: the size of every column (the one-ring and the diagonal)
+    L.resize(nV, nV);
+    Index* outer = L.outerIndexPtr();
+    parallel_for_chunks(0, nV, [&](Index begin, Index end){
+        for(Index i=begin; i<end; ++i)
+            outer[i+1] = mesh.valence(Vertex(i)) + 1;
+    }, n_threads);
+    outer[0] = 0;
+    for(Index i=0; i<nV; ++i)
+        outer[i+1] += outer[i];
+
+    ///--- pass 3: each vertex writes its column, sorted by row
+    L.resizeNonZeros(outer[nV]);
+    Index* inner = L.innerIndexPtr();
+    double* value = L.valuePtr();
+    parallel_for_chunks(0, nV, [&](Index begin, Index end){
+        std::vector< std::pair<Index,double> > column;
+        for(Index i=begin; i<end; ++i){
+            column.clear();
+            double diagonal = 0;
+            for(Halfedge h: mesh.halfedges(Vertex(i))){
+                const double w = hcot[h.idx()] + hcot[mesh.opposite_halfedge(h).idx()];
+                column.push_back(std::make_pair(mesh.to_vertex(h).idx(), w));
+                diagonal -= w;
+            }
+            column.push_back(std::make_pair(i, diagonal));
+            std::sort(column.begin(), column.end());
+            for(size_t k=0; k<column.size(); ++k){
+                inner[outer[i]+k] = column[k].first;
+                value[outer[i]+k] = column[k].second;
+            }
+        }
+    }, n_threads);
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMeshLaplacian::mass(SurfaceMesh& mesh, SparseMatrix& M, unsigned int n_threads){
+    assert(mesh.n_vertices() == mesh.vertices_size());
+
+    SurfaceMeshGeometry::update_vertex_areas(mesh, n_threads);
+    const Scalar* varea = mesh.get_vertex_property<Scalar>("v:area").data();
+
+    const Index nV = mesh.vertices_size();
+    M.resize(nV, nV);
+    M.resizeNonZeros(nV);
+    for(Index i=0; i<nV; ++i){
+        M.outerIndexPtr()[i] = i;
+        M.innerIndexPtr()[i] = i;
+        M.valuePtr()[i] = varea[i];
+    }
+    M.outerIndexPtr()[nV] = nV;
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceMeshFactorization::compute(const SurfaceMesh& mesh, const SparseMatrix& A){
+    assert(A.isCompressed());
+
+    ///--- symbolic analysis: only for a new connectivity
+    const Index nnz = A.nonZeros();
+    if(!analyzed_ || mesh_ != &mesh || version_ != mesh.topology_version() || nnz_ != nnz){
+        solver_.analyzePattern(A);
+        ++n_analyses_;
+        mesh_ = &mesh;
+        version_ = mesh.topology_version();
+        nnz_ = nnz;
+        analyzed_ = true;
+        factorized_ = false;
+    }
+
+    ///--- numeric factorization: only for new values
+    const double* values = A.valuePtr();
+    if(!factorized_ || memcmp(values_.data(), values, nnz*sizeof(double)) != 0){
+        solver_.factorize(A);
+        ++n_factorizations_;
+        values_.assign(values, values + nnz);
+        factorized_ = true;
+    }
+    return solver_.info() == Eigen::Success;
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMeshFactorization::clear(){
+    mesh_ = NULL;
+    analyzed_ = false;
+    factorized_ = false;
+    values_.clear();
+}
+
+//=============================================================================
+} // namespace OpenGP
+//=============================================================================
@@ -0,0 +1,104 @@
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Library General Public License Version 2
+// as published by the Free Software Foundation.
+//
+// This file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with OpenGP.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+#include <OpenGP/headeronly.h>
+#include <OpenGP/types.h>
+#include <Eigen/Sparse>
+#include <Eigen/SparseCholesky>
+#include <vector>
+
+//=============================================================================
+namespace OpenGP {
+//=============================================================================
+
+/// forward declaration
+class SurfaceMesh;
+
+/// Discrete Laplace operators of a triangle mesh, one row and column per
+/// vertex index. The matrices are assembled in parallel straight into the
+/// compressed storage: a first pass sizes the columns from the valences, a
+/// second one writes the sorted one-ring of every vertex, no triplets are
+/// built. The entries are double: the factorizations need the precision.
+///
+/// The mesh has to be garbage collected (the rows of deleted vertices would
+/// be empty and the systems singular). n_threads=0 uses all cores.
+class SurfaceMeshLaplacian{
+public:
+    typedef Eigen::SparseMatrix<double, Eigen::ColMajor, Index> SparseMatrix;
+
+    /// Cotangent Laplacian L: L(i,j) = (cot(a_ij) + cot(b_ij)) / 2 for the
+    /// angles opposite to edge ij, L(i,i) = -sum_j L(i,j). Symmetric and
+    /// negative semidefinite, the diagonal is stored explicitly.
+    static HEADERONLY_INLINE void cotan(const SurfaceMesh& mesh, SparseMatrix& L, unsigned int n_threads=0);
+
+    /// Lumped mass matrix: the diagonal of mixed Voronoi areas (the "v:area"
+    /// property of SurfaceMeshGeometry::update_vertex_areas, updated here)
+    static HEADERONLY_INLINE void mass(SurfaceMesh& mesh, SparseMatrix& M, unsigned int n_threads=0);
+};
+
+/** Cache of the sparse Cholesky (LDLT) factorization of a matrix built on
+ the vertices of a mesh, e.g. M - t L, for repeated solves.
+
+ compute() redoes the symbolic analysis (fill reducing ordering, elimination
+ tree) only when the topology_version() of the mesh changed, and the numeric
+ factorization only when the values of the matrix changed. Solving for new
+ right-hand sides costs two triangular solves; moving the vertices and
+ rebuilding the matrix costs a numeric factorization only.
+
+ Use one cache per system: matrices of different sparsity patterns on the
+ same connectivity would be mistaken for each other. */
+class SurfaceMeshFactorization{
+public:
+    typedef SurfaceMeshLaplacian::SparseMatrix SparseMatrix;
+    typedef Eigen::SimplicialLDLT<SparseMatrix> Solver;
+
+    /// factorizes \c A (if needed), returns false if it is not positive definite
+    HEADERONLY_INLINE bool compute(const SurfaceMesh& mesh, const SparseMatrix& A);
+
+    /// solution of A x = b for the matrix of the last compute()
+    template <class Rhs>
+    Eigen::Matrix<double, Eigen::Dynamic, Rhs::ColsAtCompileTime> solve(const Eigen::MatrixBase<Rhs>& b) const
+    {
+        assert(factorized_);
+        return solver_.solve(b);
+    }
+
+    /// the underlying solver
+    const Solver& solver() const { return solver_; }
+
+    /// forgets the factorization (the next compute() starts over)
+    HEADERONLY_INLINE void clear();
+
+    /// number of symbolic analyses and of numeric factorizations done so far
+    size_t n_analyses() const { return n_analyses_; }
+    size_t n_factorizations() const { return n_factorizations_; }
+
+private:
+    Solver solver_;
+    const SurfaceMesh* mesh_ = NULL;
+    size_t version_ = 0;
+    bool analyzed_ = false;
+    bool factorized_ = false;
+    Index nnz_ = 0;
+    std::vector<double> values_; ///< of the factorized matrix
+    size_t n_analyses_ = 0;
+    size_t n_factorizations_ = 0;
+};
+
+//=============================================================================
+} // namespace OpenGP
+//=============================================================================
+
+#ifdef HEADERONLY
+    #include "laplacian.cpp"
+#endif
@@ -0,0 +1,261 @@
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Library General Public License Version 2
+// as published by the Free Software Foundation.
+//
+// This file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with OpenGP.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <OpenGP/SurfaceMesh/mapped_storage.h>
+#include <OpenGP/SurfaceMesh/internal/raw_types.h>
+#include <fstream>
+#include <iostream>
+#include <typeinfo>
+
+//=============================================================================
+namespace OpenGP {
+//=============================================================================
+
+namespace {
+
+/// moves the array into the resource
+struct Map_visitor{
+    Property_container& props;
+    const std::string& name;
+    Memory_resource* resource;
+    std::string type;
+
+    template <class T> bool apply(const char* tag){
+        typedef typename Property<T>::vector_type vector_type;
+        type = tag;
+        Property<T> p = props.get<T>(name);
+        if(!p) return false;
+        vector_type& v = p.vector();
+        if(v.get_allocator().resource() == resource) return true;
+        vector_type data((Resource_allocator<T>(resource)));
+        data.reserve(v.capacity());
+        data.assign(v.begin(), v.end());
+        v.swap(data);
+        return true;
+    }
+};
+
+/// file offset of the array (-1 if it is not in the resource)
+struct Offset_visitor{
+    const Property_container& props;
+    const std::string& name;
+    const Mapped_file_resource& resource;
+    int64_t offset;
+    size_t element_size;
+
+    template <class T> bool apply(const char* /*tag*/){
+        const Property<T> p = props.get<T>(name);
+        if(!p) return false;
+        offset = resource.offset(p.vector().data());
+        element_size = sizeof(T);
+        return true;
+    }
+};
+
+/// attaches the array to n elements of the file, without reading them
+struct Adopt_visitor{
+    Property_container& props;
+    const std::string& name;
+    Mapped_file_resource& resource;
+    size_t element_size;
+    int64_t offset;
+    size_t n;
+
+    template <class T> bool apply(const char* /*tag*/){
+        typedef typename Property<T>::vector_type vector_type;
+        if(element_size != sizeof(T)) return false;
+        Property<T> p = props.get_or_add<T>(name);
+        if(!p) return false;
+        vector_type data((Resource_allocator<T>(&resource)));
+        if(n > 0){
+            resource.begin_adopt(offset);
+            try{
+                data.reserve(n);
+                data.resize(n);
+            } catch(const std::bad_alloc&){
+                resource.end_adopt();
+                return false;
+            }
+            resource.end_adopt();
+        }
+        p.vector().swap(data);
+        return true;
+    }
+};
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+std::vector<std::string> SurfaceMeshMappedStorage::default_properties(){
+    std::vector<std::string> names;
+    names.push_back("v:point");
+    names.push_back("v:connectivity");
+    names.push_back("h:connectivity");
+    names.push_back("f:connectivity");
+    return names;
+}
+
+//-----------------------------------------------------------------------------
+
+Property_container* SurfaceMeshMappedStorage::container(SurfaceMesh& mesh, const std::string& name){
+    if(name.size() < 3 || name[1] != ':') return NULL;
+    switch(name[0]){
+        case 'v': return &mesh.vprops_;
+        case 'h': return &mesh.hprops_;
+        case 'e': return &mesh.eprops_;
+        case 'f': return &mesh.fprops_;
+        default:  return NULL;
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceMeshMappedStorage::map(SurfaceMesh& mesh, const std::vector<std::string>& properties){
+    if(!data_.is_open() && !data_.open(path_, true)){
+        std::cerr << "[SurfaceMesh] Could not create the mapped file " << path_ << std::endl;
+        return false;
+    }
+
+    for(size_t i=0; i<properties.size(); ++i){
+        const std::string& name = properties[i];
+        Property_container* props = container(mesh, name);
+        if(!props || name.find_first_of(" \t\n") != std::string::npos){
+            std::cerr << "[SurfaceMesh] Can not map the property \"" << name << "\" (unknown element type)" << std::endl;
+            return false;
+        }
+        Map_visitor visitor = { *props, name, &data_, std::string() };
+        const std::type_info& type = props->get_type(name);
+        if(type == typeid(void) || !internal::visit_raw_type(std::string(), type, visitor)){
+            std::cerr << "[SurfaceMesh] Can not map the property \"" << name << "\" (missing or not a raw type)" << std::endl;
+            return false;
+        }
+
+        bool known = false;
+        for(size_t j=0; j<entries_.size(); ++j)
+            known = known || (entries_[j].name == name);
+        if(!known){
+            Entry entry = { name, visitor.type };
+            entries_.push_back(entry);
+        }
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceMeshMappedStorage::sync(const SurfaceMesh& mesh){
+    if(!data_.is_open()){
+        std::cerr << "[SurfaceMesh] No mapped file to sync, call map() first" << std::endl;
+        return false;
+    }
+    if(mesh.garbage()){
+        std::cerr << "[SurfaceMesh] The mapped mesh has deleted elements, call garbage_collection() first" << std::endl;
+        return false;
+    }
+
+    // the data first: a manifest always describes data that is on disk
+    if(!data_.sync()){
+        std::cerr << "[SurfaceMesh] Could not flush " << path_ << std::endl;
+        return false;
+    }
+
+    std::ofstream out((path_ + ".manifest").c_str());
+    if(!out){
+        std::cerr << "[SurfaceMesh] Could not write " << path_ << ".manifest" << std::endl;
+        return false;
+    }
+    out << "OpenGP-mapped 1\n";
+    out << "index " << sizeof(Index) << "\n";
+    out << "sizes " << mesh.vertices_size() << " " << mesh.halfedges_size() << " "
+        << mesh.edges_size() << " " << mesh.faces_size() << "\n";
+
+    // the containers are only read
+    SurfaceMesh& m = const_cast<SurfaceMesh&>(mesh);
+    for(size_t i=0; i<entries_.size(); ++i){
+        const Property_container* props = container(m, entries_[i].name);
+        Offset_visitor visitor = { *props, entries_[i].name, data_, -1, 0 };
+        if(!internal::visit_raw_type(entries_[i].type, typeid(void), visitor)){
+            std::cerr << "[SurfaceMesh] The mapped property \"" << entries_[i].name << "\" was removed" << std::endl;
+            return false;
+        }
+        if(visitor.offset < 0 && props->size() > 0){
+            std::cerr << "[SurfaceMesh] The property \"" << entries_[i].name << "\" is not mapped anymore" << std::endl;
+            return false;
+        }
+        out << entries_[i].name << " " << entries_[i].type << " " << visitor.element_size << " "
+            << visitor.offset << " " << props->size() << "\n";
+    }
+
+    out.close();
+    return bool(out);
+}
+
+//-----------------------------------------------------------------------------
+
+bool SurfaceMeshMappedStorage::open(SurfaceMesh& mesh){
+    std::ifstream in((path_ + ".manifest").c_str());
+    std::string magic, key;
+    int version = 0;
+    size_t index_size = 0;
+    Size sizes[4] = {0, 0, 0, 0};
+    in >> magic >> version;
+    in >> key >> index_size;
+    in >> key >> sizes[0] >> sizes[1] >> sizes[2] >> sizes[3];
+    if(!in || magic != "OpenGP-mapped" || version != 1){
+        std::cerr << "[SurfaceMesh] Could not read " << path_ << ".manifest" << std::endl;
+        return false;
+    }
+    if(index_size != sizeof(Index)){
+        std::cerr << "[SurfaceMesh] " << path_ << " was saved with " << 8*index_size
+                  << " bit indices (see OPENGP_INDEX_TYPE)" << std::endl;
+        return false;
+    }
+
+    mesh.clear();
+    if(!data_.open(path_, false)){
+        std::cerr << "[SurfaceMesh] Could not open the mapped file " << path_ << std::endl;
+        return false;
+    }
+    entries_.clear();
+
+    Entry entry;
+    size_t element_size;
+    int64_t offset;
+    size_t n;
+    while(in >> entry.name >> entry.type >> element_size >> offset >> n){
+        Property_container* props = container(mesh, entry.name);
+        bool ok = (props != NULL);
+        if(ok){
+            Adopt_visitor visitor = { *props, entry.name, data_, element_size, offset, n };
+            ok = internal::visit_raw_type(entry.type, typeid(void), visitor);
+        }
+        if(!ok){
+            std::cerr << "[SurfaceMesh] Could not map the property \"" << entry.name << "\" of " << path_ << std::endl;
+            mesh.clear();
+            return false;
+        }
+        entries_.push_back(entry);
+    }
+
+    // the mapped arrays already have their size, the others are filled
+    mesh.vprops_.resize(sizes[0]);
+    mesh.hprops_.resize(sizes[1]);
+    mesh.eprops_.resize(sizes[2]);
+    mesh.fprops_.resize(sizes[3]);
+    mesh.topology_rebuilt();
+    return true;
+}
+
+//=============================================================================
+} // namespace OpenGP
+//=============================================================================
@@ -0,0 +1,87 @@
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Library General Public License Version 2
+// as published by the Free Software Foundation.
+//
+// This file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with OpenGP.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+#include <OpenGP/headeronly.h>
+#include <OpenGP/SurfaceMesh/SurfaceMesh.h>
+#include <OpenGP/util/memory_resource.h>
+#include <string>
+#include <vector>
+
+//=============================================================================
+namespace OpenGP {
+//=============================================================================
+
+/// Out-of-core storage of selected property arrays of a SurfaceMesh: the
+/// arrays live in page-aligned regions of a memory-mapped data file (see
+/// Mapped_file_resource), so the OS pages them in and out and the mesh can be
+/// larger than RAM. Everything else keeps working on them: circulators,
+/// properties, add_*, garbage_collection, permute...
+///
+/// After sync(), a manifest (\c path + ".manifest") records the element
+/// counts and where every mapped array is in the file; open() then attaches
+/// the arrays to their pages without reading or parsing anything.
+///
+/// Only properties of raw types can be mapped (connectivity, handles, Vec2,
+/// Vec3, scalars and integers, see internal::visit_raw_type); bool properties are
+/// bitsets and stay in memory. Property names must start with "v:", "h:",
+/// "e:" or "f:". The storage backs one mesh at a time and has to outlive it
+/// (as any Memory_resource), and its copies as well: they share the mapped
+/// arrays until they are written.
+/// Only available on POSIX systems.
+class SurfaceMeshMappedStorage{
+public:
+    /// data file \c path, manifest \c path + ".manifest"
+    explicit SurfaceMeshMappedStorage(const std::string& path) : path_(path){}
+
+    /// "v:point" and the connectivity
+    static HEADERONLY_INLINE std::vector<std::string> default_properties();
+
+    /// Moves the \c properties of \c mesh into the data file (created anew the
+    /// first time), arrays added to the mesh later stay in memory.
+    HEADERONLY_INLINE bool map(SurfaceMesh& mesh, const std::vector<std::string>& properties=default_properties());
+
+    /// Flushes the mapped arrays to the data file and writes the manifest. The
+    /// mesh must not have garbage (see SurfaceMesh::garbage_collection): the
+    /// deletion flags are not stored.
+    HEADERONLY_INLINE bool sync(const SurfaceMesh& mesh);
+
+    /// Replaces \c mesh by the one saved by the last sync(), its arrays mapped
+    /// from the data file without reading them (the properties that were not
+    /// mapped are reset to their default value).
+    HEADERONLY_INLINE bool open(SurfaceMesh& mesh);
+
+    /// the resource of the mapped arrays
+    Mapped_file_resource& resource(){ return data_; }
+
+private:
+    /// a mapped property and the tag of its type in the manifest
+    struct Entry{
+        std::string name;
+        std::string type;
+    };
+
+    /// the container holding the property \c name, NULL if the prefix is unknown
+    static HEADERONLY_INLINE Property_container* container(SurfaceMesh& mesh, const std::string& name);
+
+    std::string path_;
+    Mapped_file_resource data_;
+    std::vector<Entry> entries_;
+};
+
+//=============================================================================
+} // namespace OpenGP
+//=============================================================================
+
+#ifdef HEADERONLY
+    #include "mapped_storage.cpp"
+#endif
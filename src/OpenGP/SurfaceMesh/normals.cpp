@@ -0,0 +1,158 @@
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Library General Public License Version 2
+// as published by the Free Software Foundation.
+//
+// This file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with OpenGP.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <OpenGP/SurfaceMesh/normals.h>
+#include <OpenGP/SurfaceMesh/SurfaceMesh.h>
+#include <OpenGP/util/parallel.h>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+//=============================================================================
+namespace OpenGP {
+//=============================================================================
+
+void SurfaceMeshNormals::update_face_normals(SurfaceMesh& mesh, unsigned int n_threads){
+    compute(mesh, true, false, ANGLE_WEIGHTS, n_threads);
+}
+
+void SurfaceMeshNormals::update_vertex_normals(SurfaceMesh& mesh, Weighting weighting, unsigned int n_threads){
+    compute(mesh, false, true, weighting, n_threads);
+}
+
+void SurfaceMeshNormals::update_normals(SurfaceMesh& mesh, Weighting weighting, unsigned int n_threads){
+    compute(mesh, true, true, weighting, n_threads);
+}
+
+//-----------------------------------------------------------------------------
+
+void SurfaceMeshNormals::compute(SurfaceMesh& mesh, bool face_normals, bool vertex_normals,
+                                 Weighting weighting, unsigned int n_threads)
+{
+    typedef SurfaceMesh::Vertex Vertex;
+    typedef SurfaceMesh::Halfedge Halfedge;
+    typedef SurfaceMesh::Face Face;
+
+    const Index nV = mesh.vertices_size();
+    const Index nH = mesh.halfedges_size();
+    const Index nF = mesh.faces_size();
+    const SurfaceMesh& cmesh = mesh;
+    const Vec3* points = mesh.get_vertex_property<Vec3>("v:point").data();
+    const Scalar eps = std::numeric_limits<Scalar>::min();
+
+    ///--- unit face normals go straight into "f:normal" if it was asked for
+    std::vector<Vec3> scratch_normals;
+    Vec3* fnormal = NULL;
+    if(face_normals){
+        SurfaceMesh::Face_property<Vec3> fnormals = mesh.face_property<Vec3>("f:normal");
+        fnormal = nF ? &fnormals.vector()[0] : NULL;
+    } else {
+        scratch_normals.resize(nF);
+        fnormal = nF ? &scratch_normals[0] : NULL;
+    }
+
+    const bool need_area  = vertex_normals && (weighting == AREA_WEIGHTS);
+    const bool need_angle = vertex_normals && (weighting == ANGLE_WEIGHTS);
+    std::vector<Scalar> farea(need_area ? nF : 0);
+    std::vector<Scalar> hangle(need_angle ? nH : 0);
+
+    ///--- pass 1: every face normal and every corner angle is computed once
+    parallel_for_chunks(0, nF, [&](Index begin, Index end){
+        for(Index i=begin; i<end; ++i){
+            Face f(i);
+            if(cmesh.is_deleted(f)) continue;
+
+            Halfedge h0 = cmesh.halfedge(f);
+            Halfedge h1 = cmesh.next_halfedge(h0);
+            Halfedge h2 = cmesh.next_halfedge(h1);
+            const Vec3& p0 = points[cmesh.to_vertex(h0).idx()];
+            const Vec3& p1 = points[cmesh.to_vertex(h1).idx()];
+            const Vec3& p2 = points[cmesh.to_vertex(h2).idx()];
+
+            Scalar area = 0;
+            Vec3 n;
+            if(cmesh.next_halfedge(h2) == h0){ // face is a triangle
+                n = (p2-p1).cross(p0-p1);
+                area = Scalar(0.5) * n.norm();
+            } else { // face is a general polygon (same as SurfaceMesh::compute_face_normal)
+                n = Vec3(0,0,0);
+                Vec3 vector_area(0,0,0);
+                Halfedge h = h0;
+                do{
+                    Halfedge hn = cmesh.next_halfedge(h);
+                    Halfedge hnn = cmesh.next_halfedge(hn);
+                    const Vec3& a = points[cmesh.to_vertex(h).idx()];
+                    const Vec3& b = points[cmesh.to_vertex(hn).idx()];
+                    const Vec3& c = points[cmesh.to_vertex(hnn).idx()];
+                    n += (c-b).cross(a-b);
+                    vector_area += a.cross(b);
+                    h = hn;
+                } while(h != h0);
+                area = Scalar(0.5) * vector_area.norm();
+            }
+
+            Scalar length = n.norm();
+            fnormal[i] = (length > eps) ? Vec3(n/length) : Vec3(0,0,0);
+            if(need_area)
+                farea[i] = area;
+
+            if(need_angle){
+                Halfedge h = h0;
+                do{
+                    Halfedge hp = cmesh.prev_halfedge(h);
+                    const Vec3& p = points[cmesh.to_vertex(hp).idx()];
+                    Vec3 d1 = points[cmesh.to_vertex(h).idx()] - p;
+                    Vec3 d2 = points[cmesh.to_vertex(cmesh.prev_halfedge(hp)).idx()] - p;
+                    hangle[h.idx()] = std::atan2(d1.cross(d2).norm(), d1.dot(d2));
+                    h = cmesh.next_halfedge(h);
+                } while(h != h0);
+            }
+        }
+    }, n_threads);
+
+    if(!vertex_normals) return;
+
+    ///--- pass 2: each vertex gathers its corners (in a fixed order => deterministic)
+    SurfaceMesh::Vertex_property<Vec3> vnormals = mesh.vertex_property<Vec3>("v:normal");
+    Vec3* vnormal = nV ? &vnormals.vector()[0] : NULL;
+    parallel_for_chunks(0, nV, [&](Index begin, Index end){
+        for(Index i=begin; i<end; ++i){
+            Vertex v(i);
+            if(cmesh.is_deleted(v)) continue;
+
+            Vec3 n(0,0,0);
+            Halfedge h = cmesh.halfedge(v);
+            if(h.is_valid()){
+                const Halfedge hend = h;
+                do{
+                    if(!cmesh.is_boundary(h)){
+                        Index f = cmesh.face(h).idx();
+                        switch(weighting){
+                            case UNIFORM_WEIGHTS: n += fnormal[f]; break;
+                            case AREA_WEIGHTS:    n += farea[f] * fnormal[f]; break;
+                            case ANGLE_WEIGHTS:   n += hangle[h.idx()] * fnormal[f]; break;
+                        }
+                    }
+                    h = cmesh.cw_rotated_halfedge(h);
+                } while(h != hend);
+
+                Scalar length = n.norm();
+                if(length > eps) n /= length;
+            }
+            vnormal[i] = n;
+        }
+    }, n_threads);
+}
+
+//=============================================================================
+} // namespace OpenGP
+//=============================================================================
@@ -0,0 +1,59 @@
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Library General Public License Version 2
+// as published by the Free Software Foundation.
+//
+// This file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with OpenGP.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+#include <OpenGP/headeronly.h>
+
+//=============================================================================
+namespace OpenGP {
+//=============================================================================
+
+/// forward declaration (SurfaceMesh.cpp uses this class)
+class SurfaceMesh;
+
+/// Multithreaded computation of face and vertex normals.
+///
+/// Every face normal and every corner angle is computed exactly once (in
+/// parallel over the faces), then each vertex gathers the contributions of
+/// its incident corners (in parallel over the vertices). Since every vertex
+/// sums its corners in the same circulation order, results do not depend on
+/// the number of threads.
+class SurfaceMeshNormals{
+public:
+    /// How the face normals are weighted when averaged at a vertex
+    enum Weighting{
+        UNIFORM_WEIGHTS, ///< every incident face counts the same
+        AREA_WEIGHTS,    ///< faces are weighted by their area
+        ANGLE_WEIGHTS    ///< faces are weighted by the angle of their corner at the vertex
+    };
+
+    /// computes the "f:normal" property (n_threads=0 uses all cores)
+    static HEADERONLY_INLINE void update_face_normals(SurfaceMesh& mesh, unsigned int n_threads=0);
+
+    /// computes the "v:normal" property (n_threads=0 uses all cores)
+    static HEADERONLY_INLINE void update_vertex_normals(SurfaceMesh& mesh, Weighting weighting=ANGLE_WEIGHTS, unsigned int n_threads=0);
+
+    /// computes both "f:normal" and "v:normal", sharing the per-face pass
+    static HEADERONLY_INLINE void update_normals(SurfaceMesh& mesh, Weighting weighting=ANGLE_WEIGHTS, unsigned int n_threads=0);
+
+private:
+    static HEADERONLY_INLINE void compute(SurfaceMesh& mesh, bool face_normals, bool vertex_normals,
+                                          Weighting weighting, unsigned int n_threads);
+};
+
+//=============================================================================
+} // namespace OpenGP
+//=============================================================================
+
+#ifdef HEADERONLY
+    #include "normals.cpp"
+#endif
@@ -0,0 +1,110 @@
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Library General Public License Version 2
+// as published by the Free Software Foundation.
+//
+// This file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with OpenGP.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+#include <OpenGP/SurfaceMesh/SurfaceMesh.h>
+#include <OpenGP/util/parallel.h>
+
+//=============================================================================
+namespace OpenGP {
+//=============================================================================
+
+/// \name Parallel loops over the elements of a SurfaceMesh
+///
+/// fn is called for every non deleted element, on the threads of
+/// Thread_pool::instance(). The elements are handed out in chunks of \c grain
+/// consecutive indices, idle threads take the next chunk, so uneven work
+/// balances itself. n_threads=0 uses all cores.
+///
+/// What fn may do concurrently:
+///  - read the connectivity, and the properties this loop does not write,
+///    of any element;
+///  - write the properties of the element it was called for, bool properties
+///    included (Bitset writes single bits atomically); the first write to an
+///    array shared with a copy of the mesh detaches it safely (see
+///    SurfaceMesh::operator=).
+///
+/// What it may not do: read a property of another element that the loop
+/// writes (e.g. the neighbors' values of the property being computed),
+/// write properties of other elements, add or remove properties, or change
+/// the topology (add_*, delete_*, flip, split, collapse,
+/// garbage_collection...). Get the property handles before the loop, not
+/// inside fn, and read through const handles.
+//@{
+
+/// fn(Handle) for every non deleted element of [0,n), see parallel_for_vertices
+template <class Handle, class Function>
+void parallel_for_elements(const SurfaceMesh& mesh, Index n, Function fn, Index grain=1024, unsigned int n_threads=0){
+    parallel_for_grain(0, n, [&](Index begin, Index end){
+        for(Index i=begin; i<end; ++i)
+            if(!mesh.is_deleted(Handle(i))) fn(Handle(i));
+    }, grain, n_threads);
+}
+
+/// calls fn(SurfaceMesh::Vertex) for every vertex, concurrently
+template <class Function>
+void parallel_for_vertices(const SurfaceMesh& mesh, Function fn, Index grain=1024, unsigned int n_threads=0){
+    parallel_for_elements<SurfaceMesh::Vertex>(mesh, mesh.vertices_size(), fn, grain, n_threads);
+}
+
+/// calls fn(SurfaceMesh::Edge) for every edge, concurrently
+template <class Function>
+void parallel_for_edges(const SurfaceMesh& mesh, Function fn, Index grain=1024, unsigned int n_threads=0){
+    parallel_for_elements<SurfaceMesh::Edge>(mesh, mesh.edges_size(), fn, grain, n_threads);
+}
+
+/// calls fn(SurfaceMesh::Face) for every face, concurrently
+template <class Function>
+void parallel_for_faces(const SurfaceMesh& mesh, Function fn, Index grain=1024, unsigned int n_threads=0){
+    parallel_for_elements<SurfaceMesh::Face>(mesh, mesh.faces_size(), fn, grain, n_threads);
+}
+
+/// Reduction over the non deleted elements of [0,n): each chunk accumulates
+/// with fn(T& value, Handle) into its own copy of \c identity, the chunk
+/// values are merged in index order with combine(T, T). The result does not
+/// depend on the number of threads.
+template <class Handle, class T, class Function, class Combine>
+T parallel_reduce_elements(const SurfaceMesh& mesh, Index n, const T& identity, Function fn, Combine combine,
+                           Index grain=1024, unsigned int n_threads=0){
+    return parallel_reduce(0, n, identity, [&](Index begin, Index end, T& value){
+        for(Index i=begin; i<end; ++i)
+            if(!mesh.is_deleted(Handle(i))) fn(value, Handle(i));
+    }, combine, grain, n_threads);
+}
+
+/// e.g. the total vertex area:
+/// parallel_reduce_vertices(mesh, Scalar(0), [&](Scalar& a, Vertex v){ a += varea[v]; }, std::plus<Scalar>())
+template <class T, class Function, class Combine>
+T parallel_reduce_vertices(const SurfaceMesh& mesh, const T& identity, Function fn, Combine combine,
+                           Index grain=1024, unsigned int n_threads=0){
+    return parallel_reduce_elements<SurfaceMesh::Vertex>(mesh, mesh.vertices_size(), identity, fn, combine, grain, n_threads);
+}
+
+/// reduction over the edges, see parallel_reduce_vertices
+template <class T, class Function, class Combine>
+T parallel_reduce_edges(const SurfaceMesh& mesh, const T& identity, Function fn, Combine combine,
+                        Index grain=1024, unsigned int n_threads=0){
+    return parallel_reduce_elements<SurfaceMesh::Edge>(mesh, mesh.edges_size(), identity, fn, combine, grain, n_threads);
+}
+
+/// reduction over the faces, see parallel_reduce_vertices
+template <class T, class Function, class Combine>
+T parallel_reduce_faces(const SurfaceMesh& mesh, const T& identity, Function fn, Combine combine,
+                        Index grain=1024, unsigned int n_threads=0){
+    return parallel_reduce_elements<SurfaceMesh::Face>(mesh, mesh.faces_size(), identity, fn, combine, grain, n_threads);
+}
+
+//@}
+
+//=============================================================================
+} // namespace OpenGP
+//=============================================================================
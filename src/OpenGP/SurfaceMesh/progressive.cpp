@@ -0,0 +1,269 @@
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Library General Public License Version 2
+// as published by the Free Software Foundation.
+//
+// This file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with OpenGP.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <OpenGP/SurfaceMesh/progressive.h>
+#include <OpenGP/SurfaceMesh/decimate.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+//=============================================================================
+namespace OpenGP {
+//=============================================================================
+
+namespace {
+
+const char pm_magic[8] = { 'O', 'G', 'P', '-', 'P', 'M', '1', '\n' };
+
+/// bytes of a split in the file: three int32 indices, three floats
+const long pm_split_size = 24;
+
+/// bytes before the splits: magic, counts, base points and triangles
+long pm_header_size(uint32_t n_vertices, uint32_t n_faces){
+    return long(sizeof(pm_magic)) + 3*4 + 12*long(n_vertices) + 12*long(n_faces);
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+
+bool ProgressiveMesh::build(const SurfaceMesh& input, Size base_vertices){
+    typedef SurfaceMesh::Halfedge Halfedge;
+
+    SurfaceMesh mesh = input;
+    if(!mesh.is_triangle_mesh()){
+        std::cerr << "[ProgressiveMesh] The mesh has to be a triangle mesh\n";
+        return false;
+    }
+    mesh.garbage_collection();
+
+    ///--- decimate, remembering the collapses (in the current indices)
+    struct Collapse{ Index v0, v1, vl, vr; Vec3 position; };
+    std::vector<Collapse> collapses;
+    {
+        SurfaceMeshDecimator decimator(mesh);
+        decimator.min_vertices = base_vertices;
+        decimator.on_collapse = [&](Halfedge h){
+            const Halfedge o = mesh.opposite_halfedge(h);
+            Collapse c;
+            c.v0 = mesh.from_vertex(h).idx();
+            c.v1 = mesh.to_vertex(h).idx();
+            c.vl = mesh.is_boundary(h) ? -1 : mesh.to_vertex(mesh.next_halfedge(h)).idx();
+            c.vr = mesh.is_boundary(o) ? -1 : mesh.to_vertex(mesh.next_halfedge(o)).idx();
+            c.position = mesh.position(mesh.from_vertex(h));
+            collapses.push_back(c);
+        };
+        decimator.exec(0);
+    }
+
+    ///--- the base keeps its vertices in order, then come the collapsed
+    ///    vertices, the last collapsed first
+    SurfaceMesh::Garbage_collection_map map;
+    const Index n_old = mesh.vertices_size();
+    mesh.garbage_collection(&map);
+    const Index n_base = mesh.vertices_size();
+    const Index n_splits = (Index) collapses.size();
+
+    std::vector<Index> index(n_old, -1);
+    for(Index i=0; i<n_old; ++i)
+        index[i] = map.vertices[i].idx();
+    for(Index k=0; k<n_splits; ++k)
+        index[collapses[k].v0] = n_base + (n_splits-1-k);
+
+    splits_.resize(n_splits);
+    for(Index k=0; k<n_splits; ++k){
+        const Collapse& c = collapses[k];
+        Split& s = splits_[n_splits-1-k];
+        s.v1 = index[c.v1];
+        s.vl = (c.vl >= 0) ? index[c.vl] : -1;
+        s.vr = (c.vr >= 0) ? index[c.vr] : -1;
+        s.position = c.position;
+    }
+
+    base_ = mesh;
+    n_file_splits_ = 0;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+bool ProgressiveMesh::set_n_vertices(SurfaceMesh& mesh, Size n_vertices) const{
+    typedef SurfaceMesh::Vertex Vertex;
+    typedef SurfaceMesh::Halfedge Halfedge;
+
+    const Index n_base = n_base_vertices();
+    const Index current = (Index) mesh.n_vertices() - n_base;
+    const Index target = (Index) std::max(std::min(n_vertices, n_max_vertices()), n_base_vertices()) - n_base;
+    if(current < 0 || current > (Index)splits_.size()){
+        std::cerr << "[ProgressiveMesh] The mesh is not a level of this progressive mesh\n";
+        return false;
+    }
+
+    ///--- refine: the new vertex takes the slot left by an earlier coarsening, or is appended
+    for(Index i=current; i<target; ++i){
+        const Split& s = splits_[i];
+        Vertex v0(n_base + i);
+        if(v0.idx() < (Index)mesh.vertices_size()){
+            if(!mesh.is_isolated(v0)){
+                std::cerr << "[ProgressiveMesh] The mesh is not a level of this progressive mesh\n";
+                return false;
+            }
+            mesh.position(v0) = s.position;
+        }
+        else
+            v0 = mesh.add_vertex(s.position);
+        if(!mesh.vertex_split(v0, Vertex(s.v1), Vertex(s.vl), Vertex(s.vr)).is_valid()){
+            std::cerr << "[ProgressiveMesh] Split " << i << " does not fit the mesh\n";
+            return false;
+        }
+    }
+
+    ///--- coarsen: collapse the last new vertex back into its origin
+    for(Index i=current-1; i>=target; --i){
+        const Halfedge h = mesh.find_halfedge(Vertex(n_base + i), Vertex(splits_[i].v1));
+        if(!h.is_valid()){
+            std::cerr << "[ProgressiveMesh] The mesh is not a level of this progressive mesh\n";
+            return false;
+        }
+        mesh.collapse(h);
+    }
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+bool ProgressiveMesh::write(const std::string& filename) const{
+    typedef SurfaceMesh::Vertex Vertex;
+
+    const Size n_vertices = base_.n_vertices(), n_faces = base_.n_faces();
+    if(n_max_vertices() > Size(INT32_MAX) || n_faces > Size(INT32_MAX)){
+        std::cerr << "[ProgressiveMesh] Too many vertices for the 32 bit indices of the file format\n";
+        return false;
+    }
+
+    FILE* out = fopen(filename.c_str(), "wb");
+    if(!out) return false;
+
+    const uint32_t counts[3] = { uint32_t(n_vertices), uint32_t(n_faces), uint32_t(splits_.size()) };
+    fwrite(pm_magic, 1, sizeof(pm_magic), out);
+    fwrite(counts, 4, 3, out);
+
+    std::vector<float> points; points.reserve(3*n_vertices);
+    for(Vertex v: base_.vertices())
+        for(int k=0; k<3; ++k) points.push_back(float(base_.position(v)[k]));
+    std::vector<int32_t> triangles; triangles.reserve(3*n_faces);
+    for(SurfaceMesh::Face f: base_.faces())
+        for(Vertex v: base_.vertices(f)) triangles.push_back(int32_t(v.idx()));
+    fwrite(points.data(), 4, points.size(), out);
+    fwrite(triangles.data(), 4, triangles.size(), out);
+
+    for(size_t i=0; i<splits_.size(); ++i){
+        const Split& s = splits_[i];
+        int32_t indices[3] = { int32_t(s.v1), int32_t(s.vl), int32_t(s.vr) };
+        float position[3] = { float(s.position[0]), float(s.position[1]), float(s.position[2]) };
+        fwrite(indices, 4, 3, out);
+        fwrite(position, 4, 3, out);
+    }
+
+    const bool ok = !ferror(out);
+    fclose(out);
+    return ok;
+}
+
+//-----------------------------------------------------------------------------
+
+bool ProgressiveMesh::read(const std::string& filename, Size max_splits){
+    FILE* in = fopen(filename.c_str(), "rb");
+    if(!in) return false;
+
+    char magic[sizeof(pm_magic)];
+    uint32_t counts[3];
+    if(fread(magic, 1, sizeof(magic), in) != sizeof(magic) || memcmp(magic, pm_magic, sizeof(magic)) != 0
+       || fread(counts, 4, 3, in) != 3){
+        std::cerr << "[ProgressiveMesh] " << filename << " is not a progressive mesh\n";
+        fclose(in);
+        return false;
+    }
+
+    std::vector<float> points(3*size_t(counts[0]));
+    std::vector<int32_t> triangles(3*size_t(counts[1]));
+    bool ok = fread(points.data(), 4, points.size(), in) == points.size()
+           && fread(triangles.data(), 4, triangles.size(), in) == triangles.size();
+    fclose(in);
+    if(!ok){
+        std::cerr << "[ProgressiveMesh] " << filename << " is truncated\n";
+        return false;
+    }
+
+    std::vector<Vec3> positions(counts[0]);
+    for(size_t i=0; i<positions.size(); ++i)
+        positions[i] = Vec3(points[3*i], points[3*i+1], points[3*i+2]);
+    std::vector<Size> indices(triangles.begin(), triangles.end());
+    std::vector<unsigned int> face_sizes(counts[1], 3);
+    if(!base_.build_from_indices(positions, face_sizes, indices) || base_.n_faces() != counts[1]){
+        std::cerr << "[ProgressiveMesh] The base mesh of " << filename << " is invalid\n";
+        return false;
+    }
+
+    splits_.clear();
+    n_file_splits_ = counts[2];
+    if(max_splits > 0 && n_file_splits_ > 0 && read_splits(filename, max_splits) == 0)
+        return false;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+
+Size ProgressiveMesh::read_splits(const std::string& filename, Size n){
+    n = std::min(n, n_file_splits_ - Size(splits_.size()));
+    if(n == 0) return 0;
+
+    FILE* in = fopen(filename.c_str(), "rb");
+    if(!in) return 0;
+    const long offset = pm_header_size(base_.n_vertices(), base_.n_faces()) + pm_split_size*long(splits_.size());
+    std::vector<char> buffer(pm_split_size*n);
+    if(fseek(in, offset, SEEK_SET) != 0) n = 0;
+    n = std::min(n, Size(fread(buffer.data(), pm_split_size, n, in)));
+    fclose(in);
+
+    ///--- split i may only refer to the vertices existing before it, [0,n_base+i)
+    std::vector<Split> splits(n);
+    for(Size i=0; i<n; ++i){
+        int32_t indices[3];
+        float position[3];
+        memcpy(indices, &buffer[pm_split_size*i], 12);
+        memcpy(position, &buffer[pm_split_size*i + 12], 12);
+        const int64_t n_vertices = int64_t(n_max_vertices()) + int64_t(i);
+        const bool ok = indices[0] >= 0 && indices[0] < n_vertices
+                     && indices[1] >= -1 && indices[1] < n_vertices && indices[1] != indices[0]
+                     && indices[2] >= -1 && indices[2] < n_vertices && indices[2] != indices[0]
+                     && indices[1] != indices[2];
+        if(!ok){
+            std::cerr << "[ProgressiveMesh] Invalid vertex split " << splits_.size() + i << " in " << filename << "\n";
+            n_file_splits_ = Size(splits_.size());
+            return 0;
+        }
+        Split& s = splits[i];
+        s.v1 = indices[0];
+        s.vl = indices[1];
+        s.vr = indices[2];
+        s.position = Vec3(position[0], position[1], position[2]);
+    }
+    splits_.insert(splits_.end(), splits.begin(), splits.end());
+    return n;
+}
+
+//=============================================================================
+} // namespace OpenGP
+//=============================================================================
@@ -0,0 +1,93 @@
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Library General Public License Version 2
+// as published by the Free Software Foundation.
+//
+// This file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with OpenGP.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+#include <OpenGP/headeronly.h>
+#include <OpenGP/SurfaceMesh/SurfaceMesh.h>
+#include <limits>
+#include <string>
+#include <vector>
+
+//=============================================================================
+namespace OpenGP {
+//=============================================================================
+
+/// Progressive mesh (Hoppe 1996): a coarse base mesh and the vertex splits
+/// (see SurfaceMesh::vertex_split) that refine it back to the original, in
+/// the reverse order of the collapses of the decimation (SurfaceMeshDecimator).
+///
+/// The vertices are numbered so that every level is a prefix: the base mesh
+/// has the vertices [0,n_base), split i creates vertex n_base+i. A mesh with
+/// the first k splits applied has the vertices [0,n_base+k).
+///
+/// The file format is binary: the base mesh (float positions, triangles)
+/// followed by the splits, 24 bytes each, so a client can read the base and
+/// then more and more splits (see read() and read_splits()).
+class ProgressiveMesh{
+public:
+    /// split of vertex v1 creating vertex n_base+i at \c position, with the
+    /// faces (new,v1,vl) and (v1,new,vr) (vl or vr is -1 on the boundary)
+    struct Split{
+        Index v1, vl, vr;
+        Vec3 position;
+    };
+
+    /// Decimates a copy of the triangle mesh \c mesh down to \c base_vertices
+    /// vertices (or as far as legal collapses go) and records the splits.
+    HEADERONLY_INLINE bool build(const SurfaceMesh& mesh, Size base_vertices);
+
+    /// the coarsest mesh, starting point of set_n_vertices()
+    const SurfaceMesh& base() const { return base_; }
+
+    /// the vertex splits, in refinement order
+    const std::vector<Split>& splits() const { return splits_; }
+
+    /// number of vertices of the base mesh
+    Size n_base_vertices() const { return base_.n_vertices(); }
+
+    /// number of vertices of the finest mesh (with the splits loaded so far)
+    Size n_max_vertices() const { return n_base_vertices() + splits_.size(); }
+
+    /** Refines or coarsens \c mesh, a copy of base() only changed by this
+     function, to \c n_vertices vertices (clamped to the available range),
+     in O(#splits applied or undone). Coarsening leaves deleted elements
+     behind; they are always the last vertices, so garbage_collection()
+     keeps the vertex indices. Returns false if \c mesh does not match; the
+     splits before the mismatch stay applied. */
+    HEADERONLY_INLINE bool set_n_vertices(SurfaceMesh& mesh, Size n_vertices) const;
+
+    /// writes the base mesh and all splits
+    HEADERONLY_INLINE bool write(const std::string& filename) const;
+
+    /// reads the base mesh and the first \c max_splits splits, false if
+    /// the base mesh or the splits are invalid
+    HEADERONLY_INLINE bool read(const std::string& filename, Size max_splits=std::numeric_limits<Size>::max());
+
+    /// appends the next (at most) \c n splits of the file read before,
+    /// returns the number of splits read. Splits referring to vertices that
+    /// do not exist yet, or with both vl and vr -1, are rejected: none of the \c n is appended, 0 is
+    /// returned and no further splits are read from the file.
+    HEADERONLY_INLINE Size read_splits(const std::string& filename, Size n);
+
+private:
+    SurfaceMesh base_;
+    std::vector<Split> splits_;
+    Size n_file_splits_ = 0; ///< splits in the file read last
+};
+
+//=============================================================================
+} // namespace OpenGP
+//=============================================================================
+
+#ifdef HEADERONLY
+    #include "progressive.cpp"
+#endif
@@ -12,6 +12,7 @@
 
 #include "remesh.h"
 #include "OpenGP/SurfaceMesh/SurfaceMesh.h"
+#include "OpenGP/SurfaceMesh/geometry.h"
 
 //=============================================================================
 namespace OpenGP {
@@ -32,43 +33,6 @@ template <class T> static inline T rad_to_deg(const T& _angle) {
     return 180*(_angle/M_PI);
 }
 
-static inline Scalar sane_aarg(Scalar _aarg) {
-    if (_aarg < -1)
-        _aarg = -1;
-    else if (_aarg >  1)
-        _aarg = 1;
-    return _aarg;
-}
-
-static inline Scalar angle(Scalar _cos_angle, Scalar _sin_angle) {
-    //sanity checks - otherwise acos will return NAN
-    _cos_angle = sane_aarg(_cos_angle);
-    return (Scalar) _sin_angle >= 0 ? acos(_cos_angle) : -acos(_cos_angle);
-}
-
-
-// Helper function
-static Scalar calc_dihedral_angle(SurfaceMesh & mesh, SurfaceMesh::Halfedge _heh) {
-    if (mesh.is_boundary(mesh.edge(_heh))) {
-        //the dihedral angle at a boundary edge is 0
-        return 0;
-    }
-
-    auto normal = mesh.face_property<Vec3>("f:normal");
-    auto points = mesh.vertex_property<Vec3>("v:point");
-
-    const Vec3& n0 = normal[mesh.face(_heh)];
-    const Vec3& n1 = normal[mesh.face(mesh.opposite_halfedge(_heh))];
-
-    Vec3 he = points[mesh.to_vertex(_heh)] - points[mesh.from_vertex(_heh)];
-
-    Scalar da_cos = dot(n0, n1);
-
-    //should be normalized, but we need only the sign
-    Scalar da_sin_sign = dot(n0.cross(n1), he);
-    return angle(da_cos, da_sin_sign);
-}
-
 static Scalar distPointTriangleSquared( const Vec3& _p,const Vec3& _v0,const Vec3& _v1,const Vec3& _v2,Vec3& _nearestPoint ) {
     Vec3 v0v1 = _v1 - _v0;
     Vec3 v0v2 = _v2 - _v0;
@@ -373,6 +337,10 @@ void IsotropicRemesher::equalizeValences(){
     SurfaceMesh::Edge_iterator e_it;
     SurfaceMesh::Edge_iterator e_end = mesh->edges_end();
 
+    // rejected flips are rolled back exactly (flipping again would rotate the edge)
+    const bool journaled = mesh->has_journal();
+    if (!journaled) mesh->begin_journal();
+
     for (e_it = mesh->edges_begin(); e_it != e_end; ++e_it) {
 
         if ( !mesh->is_flip_ok(*e_it) ) continue;
@@ -393,6 +361,7 @@ void IsotropicRemesher::equalizeValences(){
                                            +abs((int)(mesh->valence(b) - targetValence(b)))
                                            +abs((int)(mesh->valence(c) - targetValence(c)))
                                            +abs((int)(mesh->valence(d) - targetValence(d)));
+                const SurfaceMesh::Checkpoint checkpoint = mesh->checkpoint();
                 mesh->flip(*e_it);
 
                 const int deviation_post = abs((int)(mesh->valence(a) - targetValence(a)))
@@ -401,10 +370,13 @@ void IsotropicRemesher::equalizeValences(){
                                            +abs((int)(mesh->valence(d) - targetValence(d)));
 
                 if (deviation_pre <= deviation_post)
-                    mesh->flip(*e_it);
+                    mesh->rollback(checkpoint);
+                if (!journaled) mesh->clear_journal();
             }
         }
     }
+
+    if (!journaled) mesh->end_journal();
 }
 
 ///returns 4 for boundary vertices and 6 otherwise
@@ -446,13 +418,14 @@ void IsotropicRemesher::tangentialRelaxation() {
     SurfaceMesh::Vertex_iterator v_end = mesh->vertices_end();
 
     //first compute barycenters
+    SurfaceMesh::Adjacency adjacency = mesh->build_adjacency(SurfaceMesh::Adjacency::VERTEX_VERTEX);
     for (v_it = mesh->vertices_begin(); v_it != v_end; ++v_it) {
 
         Vec3 tmp(0,0,0);
         unsigned int N = 0;
 
-        for( SurfaceMesh::Halfedge hvit: mesh->halfedges(*v_it) ) {
-            tmp += points[ mesh->to_vertex(hvit) ];
+        for( SurfaceMesh::Vertex vvit: adjacency.vertices(*v_it) ) {
+            tmp += points[vvit];
             N++;
         }
 
@@ -548,12 +521,16 @@ void IsotropicRemesher::phase_analyze(){
     // Conver to radians
     Scalar TH = deg_to_rad(sharp_feature_deg);
 
-    ///--- Identify feature edges
+    ///--- Identify feature edges (all dihedral angles in one pass)
+    const bool had_dihedral = mesh->get_edge_property<Scalar>("e:dihedral");
+    SurfaceMeshGeometry::update_dihedral_angles(*mesh);
+    auto dihedral = mesh->edge_property<Scalar>("e:dihedral");
     for(SurfaceMesh::Edge e: mesh->edges()) {
-        Scalar dihedral = calc_dihedral_angle(*mesh, mesh->halfedge(e,0));
-        if(std::abs(dihedral)>TH)
+        if(std::abs(dihedral[e])>TH)
             efeature[e] = true;
     }
+    if(!had_dihedral)
+        mesh->remove_edge_property(dihedral);
 
     ///--- Mark short edges as features
     if(keep_short_edges){
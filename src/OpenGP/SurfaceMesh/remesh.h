@@ -48,12 +48,12 @@ private:
 public:
     IsotropicRemesher(SurfaceMesh& _mesh){
         this->mesh = &_mesh;
+        if(reproject_to_surface)
+            copy.share(*mesh); ///< the custom properties are shared until written
+
         efeature = mesh->edge_property<bool>("e:feature", false);
         points = mesh->vertex_property<Vec3>(VPOINT);
 
-        if(reproject_to_surface)
-            copy = *mesh; ///< deep copy
-
 #ifdef WITH_CGAL
         VerticesMatrixMap vertices = vertices_matrix(*mesh);
         TrianglesMatrix faces = faces_matrix(*mesh);
@@ -68,6 +68,9 @@ public:
 
 /// @{ core methods
 public:
+    /// Side effects besides the remeshing: "f:normal" is recomputed, and an
+    /// "e:dihedral" property the mesh already had holds the angles before
+    /// the remeshing (see SurfaceMeshGeometry::update_dihedral_angles).
     void execute();
 protected:
     void phase_analyze();
@@ -0,0 +1,189 @@
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Library General Public License Version 2
+// as published by the Free Software Foundation.
+//
+// This file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with OpenGP.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <OpenGP/SurfaceMesh/reorder.h>
+#include <OpenGP/util/parallel.h>
+#include <algorithm>
+#include <utility>
+
+//=============================================================================
+namespace OpenGP {
+//=============================================================================
+
+void SurfaceMeshReorder::exec(SurfaceMesh& mesh, Curve curve){
+    std::vector<Index> forder = face_order(mesh, curve);
+    std::vector<Index> eorder = edge_order(mesh, forder);
+    mesh.permute(vertex_order(mesh, curve), forder, eorder);
+}
+
+//-----------------------------------------------------------------------------
+
+std::vector<Index> SurfaceMeshReorder::vertex_order(const SurfaceMesh& mesh, Curve curve){
+    std::vector<Vec3> points(mesh.vertices_size());
+    for(Index i=0; i<(Index)points.size(); ++i)
+        points[i] = mesh.position(Vertex(i));
+    return sort(points, curve);
+}
+
+//-----------------------------------------------------------------------------
+
+std::vector<Index> SurfaceMeshReorder::face_order(const SurfaceMesh& mesh, Curve curve){
+    ///--- deleted faces have stale halfedges, only the live ones are sorted
+    std::vector<Index> live;
+    live.reserve(mesh.n_faces());
+    for(Index i=0; i<(Index)mesh.faces_size(); ++i)
+        if(!mesh.is_deleted(Face(i))) live.push_back(i);
+
+    std::vector<Vec3> centroids(live.size());
+    parallel_for_chunks(0, (Index)centroids.size(), [&](Index begin, Index end){
+        for(Index i=begin; i<end; ++i){
+            Vec3 c(0,0,0);
+            int n = 0;
+            for(Vertex v : mesh.vertices(Face(live[i]))){
+                c += mesh.position(v);
+                ++n;
+            }
+            centroids[i] = (n>0) ? Vec3(c/Scalar(n)) : c;
+        }
+    });
+
+    std::vector<Index> order = sort(centroids, curve);
+    for(Index& i : order) i = live[i];
+
+    ///--- deleted faces keep their relative order at the end
+    for(Index i=0; i<(Index)mesh.faces_size(); ++i)
+        if(mesh.is_deleted(Face(i))) order.push_back(i);
+    return order;
+}
+
+//-----------------------------------------------------------------------------
+
+std::vector<Index> SurfaceMeshReorder::edge_order(const SurfaceMesh& mesh, const std::vector<Index>& face_order){
+    const Index nE = mesh.edges_size();
+    const Index nF = mesh.faces_size();
+    std::vector<Index> order;
+    order.reserve(nE);
+    std::vector<bool> visited(nE, false);
+
+    for(Index i=0; i<nF; ++i){
+        Face f(face_order.empty() ? i : face_order[i]);
+        if(mesh.is_deleted(f)) continue;
+        Halfedge h = mesh.halfedge(f);
+        if(!h.is_valid()) continue;
+        Halfedge hend = h;
+        do{
+            Index e = mesh.edge(h).idx();
+            if(!visited[e]){
+                visited[e] = true;
+                order.push_back(e);
+            }
+            h = mesh.next_halfedge(h);
+        } while(h != hend);
+    }
+
+    ///--- edges without faces (deleted) keep their relative order at the end
+    for(Index e=0; e<nE; ++e)
+        if(!visited[e]) order.push_back(e);
+    return order;
+}
+
+//-----------------------------------------------------------------------------
+
+uint64_t SurfaceMeshReorder::morton_code(uint32_t x, uint32_t y, uint32_t z){
+    /// spreads the lower 21 bits of v so that there are two zeros between bits
+    auto spread = [](uint64_t v){
+        v &= 0x1fffff;
+        v = (v | v << 32) & 0x1f00000000ffffULL;
+        v = (v | v << 16) & 0x1f0000ff0000ffULL;
+        v = (v | v << 8)  & 0x100f00f00f00f00fULL;
+        v = (v | v << 4)  & 0x10c30c30c30c30c3ULL;
+        v = (v | v << 2)  & 0x1249249249249249ULL;
+        return v;
+    };
+    return (spread(x) << 2) | (spread(y) << 1) | spread(z);
+}
+
+//-----------------------------------------------------------------------------
+
+uint64_t SurfaceMeshReorder::hilbert_code(uint32_t x, uint32_t y, uint32_t z){
+    /// J. Skilling, "Programming the Hilbert curve" (AxestoTranspose)
+    const int bits = 21;
+    uint32_t X[3] = {x, y, z};
+    const uint32_t M = 1u << (bits-1);
+
+    ///--- inverse undo
+    for(uint32_t Q=M; Q>1; Q>>=1){
+        uint32_t P = Q-1;
+        for(int i=0; i<3; ++i){
+            if(X[i] & Q){
+                X[0] ^= P;
+            } else {
+                uint32_t t = (X[0] ^ X[i]) & P;
+                X[0] ^= t;
+                X[i] ^= t;
+            }
+        }
+    }
+
+    ///--- Gray encode
+    X[1] ^= X[0];
+    X[2] ^= X[1];
+    uint32_t t = 0;
+    for(uint32_t Q=M; Q>1; Q>>=1)
+        if(X[2] & Q) t ^= Q-1;
+    for(int i=0; i<3; ++i)
+        X[i] ^= t;
+
+    ///--- the transposed code, interleaved, is the Hilbert index
+    return morton_code(X[0], X[1], X[2]);
+}
+
+//-----------------------------------------------------------------------------
+
+std::vector<Index> SurfaceMeshReorder::sort(const std::vector<Vec3>& points, Curve curve){
+    const Index n = (Index) points.size();
+    std::vector<Index> order(n);
+    if(n==0) return order;
+
+    ///--- quantize in the bounding cube (uniform scale preserves the locality)
+    Vec3 pmin = points[0], pmax = points[0];
+    for(Index i=1; i<n; ++i){
+        pmin = pmin.cwiseMin(points[i]);
+        pmax = pmax.cwiseMax(points[i]);
+    }
+    Scalar extent = (pmax-pmin).maxCoeff();
+    const double cells = double((1u<<21) - 1);
+    const double scale = (extent > 0) ? cells / double(extent) : 0.0;
+
+    std::vector< std::pair<uint64_t,Index> > codes(n);
+    parallel_for_chunks(0, n, [&](Index begin, Index end){
+        for(Index i=begin; i<end; ++i){
+            uint32_t q[3];
+            for(int k=0; k<3; ++k){
+                double c = (double(points[i][k]) - double(pmin[k])) * scale;
+                q[k] = (uint32_t) std::min(std::max(c, 0.0), cells);
+            }
+            uint64_t code = (curve==MORTON_CURVE) ? morton_code(q[0], q[1], q[2])
+                                                  : hilbert_code(q[0], q[1], q[2]);
+            codes[i] = std::make_pair(code, i);
+        }
+    });
+    std::sort(codes.begin(), codes.end());
+
+    for(Index i=0; i<n; ++i)
+        order[i] = codes[i].second;
+    return order;
+}
+
+//=============================================================================
+} // namespace OpenGP
+//=============================================================================
@@ -0,0 +1,68 @@
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Library General Public License Version 2
+// as published by the Free Software Foundation.
+//
+// This file is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Library General Public License for more details.
+//
+// You should have received a copy of the GNU Library General Public
+// License along with OpenGP.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+#include <OpenGP/headeronly.h>
+#include <OpenGP/SurfaceMesh/Algorithm.h>
+#include <cstdint>
+#include <vector>
+
+//=============================================================================
+namespace OpenGP {
+//=============================================================================
+
+/// Reorders the elements of a mesh along a space filling curve, so that
+/// elements close in space are close in memory (better cache locality for
+/// circulators and smaller index deltas for GPU uploads).
+///
+/// Vertices are sorted by the curve code of their position, faces by the code
+/// of their centroid and edges by their first appearance in the sorted faces.
+/// All properties are preserved (see SurfaceMesh::permute).
+class SurfaceMeshReorder : public SurfaceMeshAlgorithm{
+public:
+    enum Curve{
+        MORTON_CURVE,  ///< Z-order, cheapest to compute
+        HILBERT_CURVE  ///< no jumps between consecutive cells, best locality
+    };
+
+    /// reorders vertices, edges and faces of the mesh
+    static HEADERONLY_INLINE void exec(SurfaceMesh& mesh, Curve curve=HILBERT_CURVE);
+
+    /// vertex order for SurfaceMesh::permute
+    static HEADERONLY_INLINE std::vector<Index> vertex_order(const SurfaceMesh& mesh, Curve curve=HILBERT_CURVE);
+
+    /// face order for SurfaceMesh::permute (deleted faces go last)
+    static HEADERONLY_INLINE std::vector<Index> face_order(const SurfaceMesh& mesh, Curve curve=HILBERT_CURVE);
+
+    /// edge order for SurfaceMesh::permute: the edges in the order they are
+    /// first met when visiting the faces in \c face_order (empty: current order)
+    static HEADERONLY_INLINE std::vector<Index> edge_order(const SurfaceMesh& mesh,
+                                                           const std::vector<Index>& face_order=std::vector<Index>());
+
+    /// Morton code of a point with 21-bit integer coordinates
+    static HEADERONLY_INLINE uint64_t morton_code(uint32_t x, uint32_t y, uint32_t z);
+
+    /// Hilbert code of a point with 21-bit integer coordinates
+    static HEADERONLY_INLINE uint64_t hilbert_code(uint32_t x, uint32_t y, uint32_t z);
+
+private:
+    /// sorts the points along the curve, returns the sorted indices
+    static HEADERONLY_INLINE std::vector<Index> sort(const std::vector<Vec3>& points, Curve curve);
+};
+
+//=============================================================================
+} // namespace OpenGP
+//=============================================================================
+
+#ifdef HEADERONLY
+    #include "reorder.cpp"
+#endif
@@ -6,6 +6,8 @@
 
 #define _USE_MATH_DEFINES
 #include <math.h>
+#include <cstdint>
+#include <type_traits>
 
 #include <Eigen/Dense>
 #include <Eigen/Geometry>
@@ -17,11 +19,22 @@ namespace OpenGP {
 /// Customizable (yet global) scalar type
 /// WARNING: OpenGL behavior undefined if type is changed!
 #ifdef OPENGP_SCALAR_TYPE
-    typedef OPENGP_SCALAR_TYPE Scalar
+    typedef OPENGP_SCALAR_TYPE Scalar;
 #else
     typedef float Scalar;
 #endif
 
+/// Customizable (yet global) index type of the mesh elements (handles,
+/// element counts, index buffers of the readers). 32 bit by default, define
+/// OPENGP_INDEX_TYPE as a 64 bit signed integer (e.g. int64_t) to process
+/// meshes with more than 2^31 halfedges. Must be signed: -1 is the invalid index.
+#ifdef OPENGP_INDEX_TYPE
+    typedef OPENGP_INDEX_TYPE Index;
+#else
+    typedef int Index;
+#endif
+typedef std::make_unsigned<Index>::type Size; ///< element counts
+
 typedef	unsigned char uchar;
 typedef	unsigned int uint;
 
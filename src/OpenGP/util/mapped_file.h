@@ -0,0 +1,88 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#pragma once
+#include <cstdio>
+#include <string>
+#include <vector>
+#if defined(__unix__) || defined(__APPLE__)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+//=============================================================================
+namespace OpenGP {
+//=============================================================================
+
+/// Read-only view of a whole file, for the readers of large meshes: the file
+/// is memory mapped (the pages are read on demand, by whichever thread
+/// touches them first), or read into memory where mmap is not available.
+class Mapped_file{
+public:
+    Mapped_file() : data_(NULL), size_(0){}
+    explicit Mapped_file(const std::string& path) : data_(NULL), size_(0){ open(path); }
+    ~Mapped_file(){ close(); }
+
+    Mapped_file(const Mapped_file&) = delete;
+    Mapped_file& operator=(const Mapped_file&) = delete;
+
+    /// maps \c path, returns false if it can not be read
+    bool open(const std::string& path){
+        close();
+#if defined(__unix__) || defined(__APPLE__)
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if(fd < 0) return false;
+        struct stat st;
+        if(fstat(fd, &st) != 0){ ::close(fd); return false; }
+        size_ = size_t(st.st_size);
+        if(size_ > 0){
+            void* p = mmap(NULL, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(p == MAP_FAILED){ ::close(fd); size_ = 0; return false; }
+            data_ = static_cast<const char*>(p);
+            madvise(p, size_, MADV_SEQUENTIAL);
+        }
+        ::close(fd); // the mapping stays valid
+        return true;
+#else
+        FILE* in = fopen(path.c_str(), "rb");
+        if(!in) return false;
+        fseek(in, 0, SEEK_END);
+        buffer_.resize(size_t(ftell(in)));
+        fseek(in, 0, SEEK_SET);
+        const bool ok = fread(buffer_.data(), 1, buffer_.size(), in) == buffer_.size();
+        fclose(in);
+        if(!ok){ buffer_.clear(); return false; }
+        data_ = buffer_.data();
+        size_ = buffer_.size();
+        return true;
+#endif
+    }
+
+    void close(){
+#if defined(__unix__) || defined(__APPLE__)
+        if(data_) munmap(const_cast<char*>(data_), size_);
+#else
+        buffer_.clear();
+#endif
+        data_ = NULL;
+        size_ = 0;
+    }
+
+    const char* data() const { return data_; }
+    const char* end() const { return data_ + size_; }
+    size_t size() const { return size_; }
+
+private:
+    const char* data_;
+    size_t size_;
+#if !(defined(__unix__) || defined(__APPLE__))
+    std::vector<char> buffer_;
+#endif
+};
+
+//=============================================================================
+} // namespace OpenGP
+//=============================================================================
@@ -0,0 +1,465 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#if defined(__unix__) || defined(__APPLE__)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+//=============================================================================
+namespace OpenGP {
+//=============================================================================
+
+/// Where the storage of property arrays comes from (a minimal, C++11 version
+/// of std::pmr::memory_resource). Resources are not owned by the containers
+/// using them, they have to outlive them.
+class Memory_resource{
+public:
+    Memory_resource() : adopting_(false){}
+    virtual ~Memory_resource(){}
+    virtual void* allocate(size_t bytes, size_t alignment) = 0;
+    virtual void deallocate(void* p, size_t bytes, size_t alignment) = 0;
+
+    /// true while the resource hands out memory that already holds elements
+    /// (see Mapped_file_resource::begin_adopt): default construction leaves it alone
+    bool adopting() const { return adopting_; }
+
+protected:
+    bool adopting_;
+};
+
+//-----------------------------------------------------------------------------
+
+/// Plain operator new/delete (the default resource)
+class New_delete_resource : public Memory_resource{
+public:
+    void* allocate(size_t bytes, size_t /*alignment*/){ return ::operator new(bytes); }
+    void deallocate(void* p, size_t /*bytes*/, size_t /*alignment*/){ ::operator delete(p); }
+};
+
+inline Memory_resource* new_delete_resource(){
+    static New_delete_resource resource;
+    return &resource;
+}
+
+//-----------------------------------------------------------------------------
+
+/// Monotonic arena: allocations are carved out of large blocks and only
+/// released when the arena is destroyed (or release() is called). Good for
+/// meshes that are built once and then only read, e.g. by the file readers.
+class Arena_resource : public Memory_resource{
+public:
+    explicit Arena_resource(size_t block_size=(size_t(1)<<24), Memory_resource* upstream=new_delete_resource())
+        : block_size_(block_size), upstream_(upstream), current_(NULL), left_(0){}
+    ~Arena_resource(){ release(); }
+
+    void* allocate(size_t bytes, size_t alignment){
+        size_t pad = current_ ? (alignment - size_t(current_) % alignment) % alignment : 0;
+        if(!current_ || pad + bytes > left_){
+            size_t size = std::max(block_size_, bytes + alignment);
+            blocks_.push_back(Block(upstream_->allocate(size, alignment), size));
+            current_ = static_cast<char*>(blocks_.back().first);
+            left_ = size;
+            pad = (alignment - size_t(current_) % alignment) % alignment;
+        }
+        void* p = current_ + pad;
+        current_ += pad + bytes;
+        left_ -= pad + bytes;
+        return p;
+    }
+
+    void deallocate(void* /*p*/, size_t /*bytes*/, size_t /*alignment*/){}
+
+    /// frees all the blocks, everything allocated from the arena becomes invalid
+    void release(){
+        for(size_t i=0; i<blocks_.size(); ++i)
+            upstream_->deallocate(blocks_[i].first, blocks_[i].second, 1);
+        blocks_.clear();
+        current_ = NULL;
+        left_ = 0;
+    }
+
+    /// bytes obtained from the upstream resource
+    size_t bytes_reserved() const{
+        size_t n = 0;
+        for(size_t i=0; i<blocks_.size(); ++i) n += blocks_[i].second;
+        return n;
+    }
+
+private:
+    typedef std::pair<void*, size_t> Block;
+    Arena_resource(const Arena_resource&);
+    Arena_resource& operator=(const Arena_resource&);
+
+    size_t block_size_;
+    Memory_resource* upstream_;
+    std::vector<Block> blocks_;
+    char* current_;
+    size_t left_;
+};
+
+//-----------------------------------------------------------------------------
+
+/// Large allocations are aligned to 2MB pages and (on Linux) marked for
+/// transparent huge pages, which cuts TLB misses on big property arrays.
+/// Small allocations go to operator new.
+class Huge_page_resource : public Memory_resource{
+public:
+    static const size_t page_size = size_t(1) << 21;
+
+    void* allocate(size_t bytes, size_t alignment){
+#if defined(__unix__) || defined(__APPLE__)
+        if(bytes >= page_size){
+            void* p = NULL;
+            if(posix_memalign(&p, std::max(alignment, page_size), bytes) != 0)
+                throw std::bad_alloc();
+    #ifdef MADV_HUGEPAGE
+            madvise(p, bytes, MADV_HUGEPAGE);
+    #endif
+            return p;
+        }
+#endif
+        return ::operator new(bytes);
+    }
+
+    void deallocate(void* p, size_t bytes, size_t /*alignment*/){
+#if defined(__unix__) || defined(__APPLE__)
+        if(bytes >= page_size){
+            free(p);
+            return;
+        }
+#endif
+        ::operator delete(p);
+    }
+};
+
+//-----------------------------------------------------------------------------
+
+/// Allocations are page-aligned regions of one file, mapped shared: the data
+/// lives in the file and the OS pages it in and out, so property arrays can
+/// be larger than RAM. Freed regions are reused by later allocations (first
+/// fit), new regions extend the file (sparse, reads as zeros). The file
+/// outlives the resource; region offsets (see offset()) let the data be
+/// mapped again later without reading it, see begin_adopt().
+/// Only available on POSIX systems: elsewhere is_open() stays false.
+class Mapped_file_resource : public Memory_resource{
+public:
+    Mapped_file_resource() : fd_(-1), file_size_(0), adopt_offset_(-1){}
+    ~Mapped_file_resource(){ close(); }
+
+    /// size of the regions' granularity (and alignment)
+    static size_t page_size(){
+#if defined(__unix__) || defined(__APPLE__)
+        static const size_t size = size_t(sysconf(_SC_PAGESIZE));
+        return size;
+#else
+        return 4096;
+#endif
+    }
+
+    /// Opens (or creates) the backing file, \c truncate discards its contents
+    bool open(const std::string& path, bool truncate){
+        close();
+#if defined(__unix__) || defined(__APPLE__)
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | (truncate ? O_TRUNC : 0), 0644);
+        if(fd_ < 0) return false;
+        off_t end = lseek(fd_, 0, SEEK_END);
+        file_size_ = (end > 0) ? int64_t(end) : 0;
+        path_ = path;
+        return true;
+#else
+        (void) path; (void) truncate;
+        return false;
+#endif
+    }
+
+    /// Unmaps the remaining regions (arrays still using them become invalid) and closes the file
+    void close(){
+#if defined(__unix__) || defined(__APPLE__)
+        for(std::map<const void*, Region>::iterator it=regions_.begin(); it!=regions_.end(); ++it)
+            munmap(const_cast<void*>(it->first), it->second.second);
+        if(fd_ >= 0) ::close(fd_);
+#endif
+        regions_.clear();
+        offsets_.clear();
+        fd_ = -1;
+        file_size_ = 0;
+        path_.clear();
+    }
+
+    bool is_open() const { return fd_ >= 0; }
+    const std::string& path() const { return path_; }
+
+    /// size of the backing file in bytes
+    int64_t file_size() const { return file_size_; }
+
+    void* allocate(size_t bytes, size_t /*alignment*/){
+#if defined(__unix__) || defined(__APPLE__)
+        if(fd_ < 0) throw std::bad_alloc();
+        const size_t size = page_size() * std::max<size_t>(1, (bytes + page_size() - 1) / page_size());
+
+        int64_t offset;
+        if(adopt_offset_ >= 0){
+            // the region must already be in the file
+            offset = adopt_offset_;
+            adopt_offset_ = -1;
+            if(offset % int64_t(page_size()) != 0 || offset + int64_t(bytes) > file_size_)
+                throw std::bad_alloc();
+        } else {
+            offset = find_gap(size);
+            if(offset + int64_t(size) > file_size_){
+                if(ftruncate(fd_, off_t(offset + size)) != 0) throw std::bad_alloc();
+                file_size_ = offset + size;
+            }
+        }
+
+        void* p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, off_t(offset));
+        if(p == MAP_FAILED) throw std::bad_alloc();
+        regions_[p] = Region(offset, size);
+        offsets_[offset] = size;
+        return p;
+#else
+        (void) bytes;
+        throw std::bad_alloc();
+#endif
+    }
+
+    void deallocate(void* p, size_t /*bytes*/, size_t /*alignment*/){
+        std::map<const void*, Region>::iterator it = regions_.find(p);
+        if(it == regions_.end()) return;
+#if defined(__unix__) || defined(__APPLE__)
+        munmap(p, it->second.second);
+#endif
+        offsets_.erase(it->second.first);
+        regions_.erase(it);
+    }
+
+    /// file offset of the region allocated at \c p, -1 if there is none
+    int64_t offset(const void* p) const{
+        std::map<const void*, Region>::const_iterator it = regions_.find(p);
+        return (it != regions_.end()) ? it->second.first : -1;
+    }
+
+    /// The next allocation maps the existing region of the file at \c offset
+    /// (e.g. recorded by offset() in an earlier session) instead of a free one,
+    /// and until end_adopt() default construction does not write the memory.
+    /// A std::vector adopts n elements with reserve(n) then resize(n).
+    void begin_adopt(int64_t offset){
+        adopt_offset_ = offset;
+        adopting_ = true;
+    }
+
+    void end_adopt(){
+        adopt_offset_ = -1;
+        adopting_ = false;
+    }
+
+    /// Writes the modified pages to the file and drops the free space at its end
+    bool sync(){
+#if defined(__unix__) || defined(__APPLE__)
+        if(fd_ < 0) return false;
+        bool ok = true;
+        for(std::map<const void*, Region>::iterator it=regions_.begin(); it!=regions_.end(); ++it)
+            ok = (msync(const_cast<void*>(it->first), it->second.second, MS_SYNC) == 0) && ok;
+        const int64_t end = offsets_.empty() ? 0 : offsets_.rbegin()->first + int64_t(offsets_.rbegin()->second);
+        if(end < file_size_ && ftruncate(fd_, off_t(end)) == 0)
+            file_size_ = end;
+        return ok;
+#else
+        return false;
+#endif
+    }
+
+private:
+    typedef std::pair<int64_t, size_t> Region; ///< offset and size of a mapping
+
+    /// first free range of the file with \c size bytes (possibly past its end)
+    int64_t find_gap(size_t size) const{
+        int64_t begin = 0;
+        for(std::map<int64_t, size_t>::const_iterator it=offsets_.begin(); it!=offsets_.end(); ++it){
+            if(begin + int64_t(size) <= it->first) return begin;
+            begin = it->first + int64_t(it->second);
+        }
+        return begin;
+    }
+
+    Mapped_file_resource(const Mapped_file_resource&);
+    Mapped_file_resource& operator=(const Mapped_file_resource&);
+
+    int fd_;
+    std::string path_;
+    int64_t file_size_;
+    int64_t adopt_offset_;
+    std::map<const void*, Region> regions_; ///< by address
+    std::map<int64_t, size_t> offsets_;     ///< sizes of the regions in use, by file offset
+};
+
+//-----------------------------------------------------------------------------
+
+/// Private (copy-on-write) mappings of regions of a file that is only read,
+/// e.g. a mesh file whose arrays are stored page-aligned: adopted arrays (see
+/// begin_adopt()) are paged in from the file when they are first touched, and
+/// pages that are written become private copies, the file never changes.
+/// Other allocations, e.g. an array growing past its mapping, go to the
+/// upstream resource. Only available on POSIX systems: elsewhere is_open()
+/// stays false.
+class Mapped_image_resource : public Memory_resource{
+public:
+    explicit Mapped_image_resource(Memory_resource* upstream=new_delete_resource())
+        : upstream_(upstream), fd_(-1), file_size_(0), adopt_offset_(-1){}
+    ~Mapped_image_resource(){ close(); }
+
+    /// Opens \c path for reading
+    bool open(const std::string& path){
+        close();
+#if defined(__unix__) || defined(__APPLE__)
+        fd_ = ::open(path.c_str(), O_RDONLY);
+        if(fd_ < 0) return false;
+        off_t end = lseek(fd_, 0, SEEK_END);
+        file_size_ = (end > 0) ? int64_t(end) : 0;
+        return true;
+#else
+        (void) path;
+        return false;
+#endif
+    }
+
+    /// Unmaps the remaining regions (arrays still using them become invalid) and closes the file
+    void close(){
+#if defined(__unix__) || defined(__APPLE__)
+        for(std::map<const void*, size_t>::iterator it=regions_.begin(); it!=regions_.end(); ++it)
+            munmap(const_cast<void*>(it->first), it->second);
+        if(fd_ >= 0) ::close(fd_);
+#endif
+        regions_.clear();
+        fd_ = -1;
+        file_size_ = 0;
+    }
+
+    bool is_open() const { return fd_ >= 0; }
+
+    /// size of the file in bytes
+    int64_t file_size() const { return file_size_; }
+
+    /// size of the pages, file offsets of adopted regions are multiples of it
+    static size_t page_size(){ return Mapped_file_resource::page_size(); }
+
+    void* allocate(size_t bytes, size_t alignment){
+        if(adopt_offset_ < 0) return upstream_->allocate(bytes, alignment);
+#if defined(__unix__) || defined(__APPLE__)
+        const int64_t offset = adopt_offset_;
+        adopt_offset_ = -1;
+        if(fd_ < 0 || offset % int64_t(page_size()) != 0 || offset + int64_t(bytes) > file_size_)
+            throw std::bad_alloc();
+        const size_t size = std::max<size_t>(bytes, 1);
+        void* p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd_, off_t(offset));
+        if(p == MAP_FAILED) throw std::bad_alloc();
+        regions_[p] = size;
+        return p;
+#else
+        throw std::bad_alloc();
+#endif
+    }
+
+    void deallocate(void* p, size_t bytes, size_t alignment){
+        std::map<const void*, size_t>::iterator it = regions_.find(p);
+        if(it == regions_.end()){
+            upstream_->deallocate(p, bytes, alignment);
+            return;
+        }
+#if defined(__unix__) || defined(__APPLE__)
+        munmap(p, it->second);
+#endif
+        regions_.erase(it);
+    }
+
+    /// The next allocation maps the region of the file at \c offset, and until
+    /// end_adopt() default construction does not write the memory, see
+    /// Mapped_file_resource::begin_adopt()
+    void begin_adopt(int64_t offset){
+        adopt_offset_ = offset;
+        adopting_ = true;
+    }
+
+    void end_adopt(){
+        adopt_offset_ = -1;
+        adopting_ = false;
+    }
+
+    /// number of bytes currently mapped from the file
+    size_t bytes_mapped() const{
+        size_t n = 0;
+        for(std::map<const void*, size_t>::const_iterator it=regions_.begin(); it!=regions_.end(); ++it)
+            n += it->second;
+        return n;
+    }
+
+private:
+    Mapped_image_resource(const Mapped_image_resource&);
+    Mapped_image_resource& operator=(const Mapped_image_resource&);
+
+    Memory_resource* upstream_;
+    int fd_;
+    int64_t file_size_;
+    int64_t adopt_offset_;
+    std::map<const void*, size_t> regions_; ///< sizes of the mappings, by address
+};
+
+//-----------------------------------------------------------------------------
+
+/// STL allocator drawing from a Memory_resource. Copy assignment keeps the
+/// resource of the destination, moves and swaps carry the resource along.
+template <class T>
+class Resource_allocator{
+public:
+    typedef T value_type;
+    typedef std::false_type propagate_on_container_copy_assignment;
+    typedef std::true_type  propagate_on_container_move_assignment;
+    typedef std::true_type  propagate_on_container_swap;
+
+    Resource_allocator(Memory_resource* resource=new_delete_resource()) : resource_(resource){}
+    template <class U> Resource_allocator(const Resource_allocator<U>& other) : resource_(other.resource()){}
+
+    T* allocate(size_t n){
+        return static_cast<T*>(resource_->allocate(n*sizeof(T), std::alignment_of<T>::value));
+    }
+    void deallocate(T* p, size_t n){
+        resource_->deallocate(p, n*sizeof(T), std::alignment_of<T>::value);
+    }
+
+    /// default construction (e.g. vector::resize(n) without a value) is skipped
+    /// while the resource adopts existing elements, see Memory_resource::adopting()
+    template <class U> void construct(U* p){
+        if(!resource_->adopting()) ::new((void*)p) U();
+    }
+    template <class U, class... Args> void construct(U* p, Args&&... args){
+        ::new((void*)p) U(std::forward<Args>(args)...);
+    }
+
+    Memory_resource* resource() const{ return resource_; }
+
+private:
+    Memory_resource* resource_;
+};
+
+template <class T, class U>
+bool operator==(const Resource_allocator<T>& a, const Resource_allocator<U>& b){ return a.resource() == b.resource(); }
+template <class T, class U>
+bool operator!=(const Resource_allocator<T>& a, const Resource_allocator<U>& b){ return a.resource() != b.resource(); }
+
+//=============================================================================
+} // namespace OpenGP
+//=============================================================================
@@ -0,0 +1,120 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#pragma once
+#include <cassert>
+#include <utility>
+#include <vector>
+#include <OpenGP/types.h>
+
+//=============================================================================
+namespace OpenGP {
+//=============================================================================
+
+/// Binary min-heap over the elements [0,n) whose priorities can change: every
+/// element knows its slot in the heap, so update() and remove() take
+/// O(log n) instead of a search. Equal priorities pop the smaller element
+/// first, which keeps algorithms built on it deterministic.
+template <class Priority>
+class Mutable_heap{
+public:
+    typedef std::pair<Priority, Index> Item; ///< priority and element
+
+    explicit Mutable_heap(Index n=0) : slot_(n, -1){}
+
+    /// elements [0,n) may be stored, the heap is emptied
+    void reset(Index n){
+        heap_.clear();
+        slot_.assign(n, -1);
+    }
+
+    /// builds the heap from \c items (distinct elements) in O(#items)
+    void assign(const std::vector<Item>& items){
+        for(size_t k=0; k<heap_.size(); ++k) slot_[heap_[k].second] = -1;
+        heap_ = items;
+        for(Index k=0; k<(Index)heap_.size(); ++k) slot_[heap_[k].second] = k;
+        for(Index k=(Index)heap_.size()/2-1; k>=0; --k) sift_down(k);
+    }
+
+    bool empty() const { return heap_.empty(); }
+    Index size() const { return (Index) heap_.size(); }
+    bool contains(Index i) const { return slot_[i] >= 0; }
+
+    /// element with the smallest priority
+    Index top() const { assert(!empty()); return heap_[0].second; }
+    const Priority& top_priority() const { assert(!empty()); return heap_[0].first; }
+
+    /// inserts \c i or changes its priority
+    void update(Index i, const Priority& priority){
+        Index k = slot_[i];
+        if(k < 0){
+            k = (Index) heap_.size();
+            heap_.push_back(Item(priority, i));
+            slot_[i] = k;
+            sift_up(k);
+            return;
+        }
+        const Item old = heap_[k];
+        heap_[k].first = priority;
+        if(heap_[k] < old) sift_up(k); else sift_down(k);
+    }
+
+    /// removes \c i (if it is in the heap)
+    void remove(Index i){
+        const Index k = slot_[i];
+        if(k < 0) return;
+        slot_[i] = -1;
+        const Item last = heap_.back();
+        heap_.pop_back();
+        if(k == (Index)heap_.size()) return;
+        heap_[k] = last;
+        slot_[last.second] = k;
+        if(k > 0 && last < heap_[(k-1)/2]) sift_up(k); else sift_down(k);
+    }
+
+    /// removes and returns the element with the smallest priority
+    Index pop(){
+        const Index i = top();
+        remove(i);
+        return i;
+    }
+
+private:
+    void place(Index k, const Item& item){
+        heap_[k] = item;
+        slot_[item.second] = k;
+    }
+
+    void sift_up(Index k){
+        const Item item = heap_[k];
+        while(k > 0){
+            const Index parent = (k-1)/2;
+            if(!(item < heap_[parent])) break;
+            place(k, heap_[parent]);
+            k = parent;
+        }
+        place(k, item);
+    }
+
+    void sift_down(Index k){
+        const Item item = heap_[k];
+        const Index n = (Index) heap_.size();
+        for(;;){
+            Index child = 2*k+1;
+            if(child >= n) break;
+            if(child+1 < n && heap_[child+1] < heap_[child]) ++child;
+            if(!(heap_[child] < item)) break;
+            place(k, heap_[child]);
+            k = child;
+        }
+        place(k, item);
+    }
+
+    std::vector<Item>  heap_;
+    std::vector<Index> slot_; ///< of each element in heap_, -1 if it is not in the heap
+};
+
+//=============================================================================
+} // namespace OpenGP
+//=============================================================================
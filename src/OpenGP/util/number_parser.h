@@ -0,0 +1,153 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#pragma once
+#include <clocale>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#if defined(__APPLE__)
+    #include <xlocale.h>
+#elif defined(__GLIBC__)
+    #include <locale.h>
+#endif
+
+//=============================================================================
+namespace OpenGP {
+//=============================================================================
+
+/// \name Number parsing for the text mesh formats
+///
+/// A minimal std::from_chars for C++11: the numbers are parsed from [p,end)
+/// without locale, allocation or a terminating '\0', and p is advanced past
+/// them. Leading blanks (spaces, tabs) are skipped, line ends are not.
+/// Decimal floats with at most 19 significant digits and an exponent within
+/// +-22 are converted exactly (the mantissa and the power of ten are exact
+/// doubles); anything else (longer mantissas, inf, nan, hex) goes to strtod,
+/// in the "C" locale.
+//@{
+
+/// strtod in the "C" locale ('.' as the decimal point, whatever setlocale says)
+inline double strtod_c(const char* s, char** stop){
+#if defined(_MSC_VER)
+    static const _locale_t c_locale = _create_locale(LC_NUMERIC, "C");
+    return _strtod_l(s, stop, c_locale);
+#elif defined(__APPLE__) || defined(__GLIBC__)
+    static const locale_t c_locale = newlocale(LC_NUMERIC_MASK, "C", (locale_t) 0);
+    return strtod_l(s, stop, c_locale);
+#else
+    // no strtod_l: spell the decimal point the way the current locale does
+    const char point = *localeconv()->decimal_point;
+    char buffer[128];
+    size_t n = strlen(s);
+    if(point == '.' || n >= sizeof(buffer)) return strtod(s, stop);
+    for(size_t i=0; i<=n; ++i) buffer[i] = (s[i] == '.') ? point : s[i];
+    char* end;
+    const double value = strtod(buffer, &end);
+    *stop = const_cast<char*>(s) + (end - buffer);
+    return value;
+#endif
+}
+
+/// skips spaces and tabs
+inline void skip_blanks(const char*& p, const char* end){
+    while(p < end && (*p == ' ' || *p == '\t')) ++p;
+}
+
+/// parses a decimal integer, returns false (and leaves p) if there is none
+inline bool parse_integer(const char*& p, const char* end, long long& value){
+    const char* q = p;
+    skip_blanks(q, end);
+    bool negative = false;
+    if(q < end && (*q == '-' || *q == '+')) negative = (*q++ == '-');
+    if(q == end || unsigned(*q - '0') > 9) return false;
+    long long v = 0;
+    while(q < end && unsigned(*q - '0') <= 9) v = 10*v + (*q++ - '0');
+    value = negative ? -v : v;
+    p = q;
+    return true;
+}
+
+/// parses a floating point number, returns false (and leaves p) if there is none
+inline bool parse_double(const char*& p, const char* end, double& value){
+    static const double pow10[23] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+    const char* q = p;
+    skip_blanks(q, end);
+    const char* start = q;
+    bool negative = false;
+    if(q < end && (*q == '-' || *q == '+')) negative = (*q++ == '-');
+
+    ///--- fast path: mantissa and decimal exponent
+    uint64_t mantissa = 0;
+    int digits = 0, exponent = 0;
+    bool any = false;
+    while(q < end && *q == '0'){ ++q; any = true; } // leading zeros are not significant
+    for(; q < end && unsigned(*q - '0') <= 9; ++q, any = true){
+        if(digits < 19){ mantissa = 10*mantissa + (*q - '0'); ++digits; }
+        else ++exponent;
+    }
+    if(q < end && *q == '.'){
+        ++q;
+        if(digits == 0)
+            for(; q < end && *q == '0'; ++q, any = true) --exponent;
+        for(; q < end && unsigned(*q - '0') <= 9; ++q, any = true)
+            if(digits < 19){ mantissa = 10*mantissa + (*q - '0'); ++digits; --exponent; }
+    }
+    if(any){ // otherwise inf, nan, hex...
+        if(q < end && (*q == 'e' || *q == 'E')){
+            const char* e = q+1;
+            long long x;
+            if(e < end && *e != ' ' && *e != '\t' && parse_integer(e, end, x)){
+                exponent += (int) (x < -100000 ? -100000 : (x > 100000 ? 100000 : x));
+                q = e;
+            }
+        }
+        if(mantissa == 0){
+            value = negative ? -0.0 : 0.0;
+            p = q;
+            return true;
+        }
+        if(mantissa <= (uint64_t(1) << 53) && exponent >= -22 && exponent <= 22){
+            double v = double(mantissa);
+            v = (exponent < 0) ? v / pow10[-exponent] : v * pow10[exponent];
+            value = negative ? -v : v;
+            p = q;
+            return true;
+        }
+    }
+
+    ///--- slow path: strtod needs a terminated copy (numbers are short, unless malformed)
+    char buffer[128];
+    size_t n = 0;
+    for(const char* s = start; s < end && n+1 < sizeof(buffer) && *s != ' ' && *s != '\t'
+                               && *s != '\n' && *s != '\r' && *s != '/'; ++s)
+        buffer[n++] = *s;
+    buffer[n] = '\0';
+    char* stop;
+    value = strtod_c(buffer, &stop);
+    if(stop == buffer) return false;
+    p = start + (stop - buffer);
+    return true;
+}
+
+/// parses a float, see parse_double
+inline bool parse_float(const char*& p, const char* end, float& value){
+    double v;
+    if(!parse_double(p, end, v)) return false;
+    value = float(v);
+    return true;
+}
+
+/// the start of the next line (past the '\n'), or end
+inline const char* next_line(const char* p, const char* end){
+    const char* q = static_cast<const char*>(memchr(p, '\n', end - p));
+    return q ? q+1 : end;
+}
+
+//@}
+
+//=============================================================================
+} // namespace OpenGP
+//=============================================================================
@@ -0,0 +1,94 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#pragma once
+#include <OpenGP/types.h>
+#include <OpenGP/util/thread_pool.h>
+#include <algorithm>
+#include <climits>
+#include <vector>
+
+//=============================================================================
+namespace OpenGP {
+//=============================================================================
+
+/// Splits the index range [begin,end) into (at most) n_threads contiguous chunks
+/// and calls fn(chunk_begin, chunk_end) for each of them concurrently, on the
+/// threads of Thread_pool::instance().
+/// The chunk boundaries only depend on the range and on n_threads (0 = all cores),
+/// the calling thread processes chunks itself.
+template <class Function>
+void parallel_for_chunks(Index begin, Index end, Function fn, unsigned int n_threads=0){
+    if(end <= begin) return;
+    if(n_threads == 0) n_threads = default_n_threads();
+
+    /// not worth splitting tiny ranges
+    const Index min_chunk = 1024;
+    const Index n = end - begin;
+    int n_chunks = (int) std::min<Index>(n_threads, (n + min_chunk - 1) / min_chunk);
+    if(n_chunks <= 1){
+        fn(begin, end);
+        return;
+    }
+
+    const Index chunk = (n + n_chunks - 1) / n_chunks;
+    n_chunks = (int) ((n + chunk - 1) / chunk);
+    Thread_pool::instance().run(n_chunks, [&](int c){
+        const Index cbegin = begin + c*chunk;
+        fn(cbegin, std::min(end, cbegin + chunk));
+    }, n_threads);
+}
+
+/// Calls fn(i) for every i in [0,n) with (at most) n_threads threads (0 = all cores).
+/// Meant for a few large independent jobs, which parallel_for_chunks would not split.
+template <class Function>
+void parallel_for_tasks(int n, Function fn, unsigned int n_threads=0){
+    Thread_pool::instance().run(n, fn, n_threads);
+}
+
+/// grain to split n indices with: at least 1, and no more than INT_MAX chunks
+inline Index parallel_grain(Index n, Index grain){
+    return std::max(std::max<Index>(grain, 1), (n + INT_MAX - 1) / INT_MAX);
+}
+
+/// Splits [begin,end) into chunks of \c grain indices, which idle threads of
+/// Thread_pool::instance() claim one after the other (good for uneven work),
+/// and calls fn(chunk_begin, chunk_end) for each of them.
+template <class Function>
+void parallel_for_grain(Index begin, Index end, Function fn, Index grain=1024, unsigned int n_threads=0){
+    if(end <= begin) return;
+    grain = parallel_grain(end - begin, grain);
+    const int n_chunks = (int) ((end - begin + grain - 1) / grain);
+    Thread_pool::instance().run(n_chunks, [&](int c){
+        const Index cbegin = begin + c*grain;
+        fn(cbegin, std::min(end, cbegin + grain));
+    }, n_threads);
+}
+
+/// Reduction over [begin,end): every chunk of \c grain indices accumulates
+/// into its own copy of \c identity with fn(chunk_begin, chunk_end, T& value),
+/// then the chunk values are merged in chunk order with value = combine(value, chunk_value).
+/// Since the chunks do not depend on the threads, neither does the result
+/// (which matters for floating point sums).
+template <class T, class Function, class Combine>
+T parallel_reduce(Index begin, Index end, const T& identity, Function fn, Combine combine,
+                  Index grain=1024, unsigned int n_threads=0){
+    if(end <= begin) return identity;
+    grain = parallel_grain(end - begin, grain);
+    const int n_chunks = (int) ((end - begin + grain - 1) / grain);
+    struct Slot{ T value; }; ///< not std::vector<bool>, whose elements share words
+    std::vector<Slot> partial(n_chunks, Slot{identity});
+    Thread_pool::instance().run(n_chunks, [&](int c){
+        const Index cbegin = begin + c*grain;
+        fn(cbegin, std::min(end, cbegin + grain), partial[c].value);
+    }, n_threads);
+    T value = identity;
+    for(int c=0; c<n_chunks; ++c)
+        value = combine(value, partial[c].value);
+    return value;
+}
+
+//=============================================================================
+} // namespace OpenGP
+//=============================================================================
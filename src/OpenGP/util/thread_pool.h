@@ -0,0 +1,178 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//=============================================================================
+namespace OpenGP {
+//=============================================================================
+
+/// Number of threads used by parallel algorithms when they are asked for 0 threads
+inline unsigned int default_n_threads(){
+    unsigned int n = std::thread::hardware_concurrency();
+    return (n>0) ? n : 1;
+}
+
+/// Fork-join pool of persistent worker threads, shared by the whole library
+/// (see Thread_pool::instance()), so that parallel loops do not pay for
+/// creating threads.
+///
+/// run(n, fn) publishes a batch of n jobs; the calling thread and every idle
+/// worker keep claiming the next unclaimed job of any open batch until none
+/// is left, which balances uneven jobs. A job may itself call run(): the
+/// nested batch is open to all threads as well, and the waiting caller helps
+/// with other batches meanwhile, so nesting cannot deadlock. Jobs must not
+/// throw.
+class Thread_pool{
+public:
+    explicit Thread_pool(unsigned int n_workers) : stop_(false){
+        workers_.reserve(n_workers);
+        for(unsigned int i=0; i<n_workers; ++i)
+            workers_.push_back(std::thread([this]{ worker_loop(); }));
+    }
+
+    ~Thread_pool(){
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        work_cv_.notify_all();
+        for(size_t i=0; i<workers_.size(); ++i)
+            workers_[i].join();
+    }
+
+    /// the pool used by the library: default_n_threads()-1 workers plus the calling thread
+    static Thread_pool& instance(){
+        static Thread_pool pool(default_n_threads()-1);
+        return pool;
+    }
+
+    /// maximum number of threads working on a batch (the workers and the caller)
+    unsigned int n_threads() const { return (unsigned int) workers_.size() + 1; }
+
+    /// Calls fn(i) for every i in [0,n) with at most n_threads threads (0 = all
+    /// of the pool) and returns when all calls are done.
+    template <class Function>
+    void run(int n, Function fn, unsigned int n_threads=0){
+        if(n <= 0) return;
+        if(n_threads == 0 || n_threads > this->n_threads()) n_threads = this->n_threads();
+        if(n_threads == 1 || n == 1){
+            for(int i=0; i<n; ++i) fn(i);
+            return;
+        }
+
+        Batch batch(n, std::min<int>(n_threads, n) - 1, &call<Function>, &fn);
+        std::list<Batch*>::iterator it;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            batches_.push_back(&batch);
+            it = --batches_.end();
+        }
+        work_cv_.notify_all();
+        done_cv_.notify_all(); // callers waiting for their own batch can help too
+
+        batch.work();
+
+        // no new helpers can join once the batch is off the list
+        std::unique_lock<std::mutex> lock(mutex_);
+        batches_.erase(it);
+        while(batch.done != n || batch.active != 0){
+            // help with the other batches (e.g. nested in our own jobs) while waiting
+            Batch* other = join_batch();
+            if(other){
+                lock.unlock();
+                other->work();
+                lock.lock();
+                leave_batch(other);
+            } else {
+                done_cv_.wait(lock);
+            }
+        }
+    }
+
+private:
+    /// a set of jobs, lives on the stack of the thread that called run()
+    struct Batch{
+        Batch(int n_, int max_helpers_, void (*call_)(void*, int), void* fn_)
+            : n(n_), max_helpers(max_helpers_), n_helpers(0), active(0), next(0), done(0), call(call_), fn(fn_){}
+
+        /// claims and runs jobs until none is left
+        void work(){
+            for(int i=next++; i<n; i=next++){
+                call(fn, i);
+                ++done;
+            }
+        }
+
+        bool open() const { return next < n && n_helpers < max_helpers; }
+
+        const int n;
+        const int max_helpers;
+        int n_helpers;             ///< helpers that joined so far (guarded by the pool mutex)
+        int active;                ///< helpers currently in work() (guarded by the pool mutex)
+        std::atomic<int> next;     ///< next unclaimed job
+        std::atomic<int> done;     ///< finished jobs
+        void (*call)(void*, int);
+        void* fn;
+    };
+
+    template <class Function>
+    static void call(void* fn, int i){ (*static_cast<Function*>(fn))(i); }
+
+    /// first open batch, registered as helped (call with the mutex held)
+    Batch* join_batch(){
+        for(std::list<Batch*>::iterator it=batches_.begin(); it!=batches_.end(); ++it){
+            if((*it)->open()){
+                ++(*it)->n_helpers;
+                ++(*it)->active;
+                return *it;
+            }
+        }
+        return NULL;
+    }
+
+    /// a helper is done with a batch (call with the mutex held)
+    void leave_batch(Batch* batch){
+        if(--batch->active == 0)
+            done_cv_.notify_all();
+    }
+
+    void worker_loop(){
+        std::unique_lock<std::mutex> lock(mutex_);
+        for(;;){
+            Batch* batch = join_batch();
+            if(batch){
+                lock.unlock();
+                batch->work();
+                lock.lock();
+                leave_batch(batch);
+                continue;
+            }
+            if(stop_) return;
+            work_cv_.wait(lock);
+        }
+    }
+
+private:
+    Thread_pool(const Thread_pool&);
+    Thread_pool& operator=(const Thread_pool&);
+
+    std::vector<std::thread> workers_;
+    std::list<Batch*> batches_;
+    std::mutex mutex_;
+    std::condition_variable work_cv_;  ///< a batch was published
+    std::condition_variable done_cv_;  ///< a helper left a batch
+    bool stop_;
+};
+
+//=============================================================================
+} // namespace OpenGP
+//=============================================================================
@@ -0,0 +1,68 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#pragma once
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <OpenGP/types.h>
+
+//=============================================================================
+namespace OpenGP {
+//=============================================================================
+
+/// Disjoint sets over the elements [0,n) that threads may unite() and find()
+/// concurrently, without locks. A set is always represented by its smallest
+/// element: roots are only linked below smaller roots, with a compare and
+/// swap that fails (and retries) if the root got linked in the meantime.
+/// find() halves the paths it walks; those writes only ever shortcut to an
+/// ancestor, so they are safe to race.
+class Union_find{
+public:
+    explicit Union_find(Index n=0){ reset(n); }
+
+    /// every element in its own set
+    void reset(Index n){
+        parent_.reset(n ? new std::atomic<Index>[n] : NULL);
+        n_ = n;
+        for(Index i=0; i<n; ++i) parent_[i].store(i, std::memory_order_relaxed);
+    }
+
+    Index size() const { return n_; }
+
+    /// the smallest element of the set of \c i
+    Index find(Index i){
+        for(;;){
+            Index p = parent_[i].load(std::memory_order_relaxed);
+            if(p == i) return i;
+            Index gp = parent_[p].load(std::memory_order_relaxed);
+            if(gp != p) parent_[i].compare_exchange_weak(p, gp, std::memory_order_relaxed);
+            i = gp;
+        }
+    }
+
+    /// merges the sets of \c a and \c b
+    void unite(Index a, Index b){
+        for(;;){
+            a = find(a);
+            b = find(b);
+            if(a == b) return;
+            if(a < b) std::swap(a, b);
+            // link the larger root below the smaller one, if it still is a root
+            Index expected = a;
+            if(parent_[a].compare_exchange_strong(expected, b, std::memory_order_acq_rel)) return;
+        }
+    }
+
+    /// whether \c i represents its set (is its smallest element)
+    bool is_root(Index i) const { return parent_[i].load(std::memory_order_relaxed) == i; }
+
+private:
+    std::unique_ptr<std::atomic<Index>[]> parent_;
+    Index n_ = 0;
+};
+
+//=============================================================================
+} // namespace OpenGP
+//=============================================================================
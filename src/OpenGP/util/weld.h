@@ -0,0 +1,188 @@
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#pragma once
+#include <OpenGP/types.h>
+#include <OpenGP/util/parallel.h>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+//=============================================================================
+namespace OpenGP {
+//=============================================================================
+
+namespace internal {
+
+inline uint64_t weld_hash(uint64_t h){ // splitmix64 finalizer
+    h ^= h >> 30; h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27; h *= 0x94d049bb133111ebULL;
+    return h ^ (h >> 31);
+}
+
+/// hash of the bits of a point (-0 and 0 are the same)
+inline uint64_t weld_hash(const Vec3& p){
+    uint64_t h = 0;
+    for(int k=0; k<3; ++k){
+        Scalar x = (p[k] == 0) ? Scalar(0) : p[k];
+        uint64_t bits = 0;
+        memcpy(&bits, &x, sizeof(x));
+        h = weld_hash(h ^ bits);
+    }
+    return h;
+}
+
+} // namespace internal
+
+/** Merges equal points of a point soup (e.g. the corners of an STL file):
+ on return \c unique holds the distinct points, in the order of their first
+ occurrence, and index[i] is the position of points[i] in \c unique.
+ Returns the number of distinct points.
+
+ With tolerance 0 the points have to be equal (bitwise, up to the sign of
+ zero). The points are hashed in parallel, partitioned by hash into
+ buckets, and every bucket is deduplicated with its own open addressing
+ table by one thread; the result does not depend on the number of threads.
+
+ With a tolerance, the distinct points are then merged in order into the
+ first earlier representative closer than \c tolerance, found through a
+ uniform grid of cells twice that size (this pass is sequential). Unlike an
+ "epsilon" ordering of the points, which is not transitive, the outcome is
+ well defined. */
+inline Size weld_points(const std::vector<Vec3>& points, Scalar tolerance,
+                        std::vector<Index>& index, std::vector<Vec3>& unique, unsigned int n_threads=0){
+    const Index n = points.size();
+    index.resize(n);
+    unique.clear();
+    std::vector<Index> representative(n);
+
+    ///--- exact: hash in parallel, bucket by the top bits of the hash (stable)
+    std::vector<uint64_t> hash(n);
+    parallel_for_chunks(0, n, [&](Index begin, Index end){
+        for(Index i=begin; i<end; ++i) hash[i] = internal::weld_hash(points[i]);
+    }, n_threads);
+
+    const int bucket_bits = 8;
+    const Index n_buckets = Index(1) << bucket_bits;
+    std::vector<Index> offset(n_buckets+1, 0), order(n);
+    for(Index i=0; i<n; ++i) ++offset[(hash[i] >> (64-bucket_bits)) + 1];
+    for(Index b=0; b<n_buckets; ++b) offset[b+1] += offset[b];
+    {
+        std::vector<Index> next(offset.begin(), offset.end()-1);
+        for(Index i=0; i<n; ++i) order[next[hash[i] >> (64-bucket_bits)]++] = i;
+    }
+
+    ///--- deduplicate each bucket: the first of equal points represents them
+    parallel_for_grain(0, n_buckets, [&](Index begin, Index end){
+        std::vector<Index> table;
+        for(Index b=begin; b<end; ++b){
+            const Index count = offset[b+1] - offset[b];
+            Index size = 16;
+            while(size < 2*count) size *= 2;
+            table.assign(size, -1);
+            for(Index k=offset[b]; k<offset[b+1]; ++k){
+                const Index i = order[k];
+                Index slot = Index(hash[i] & uint64_t(size-1));
+                for(;;){
+                    const Index j = table[slot];
+                    if(j < 0){ table[slot] = i; representative[i] = i; break; }
+                    if(hash[j] == hash[i] && points[j] == points[i]){ representative[i] = j; break; }
+                    slot = (slot + 1) & (size-1);
+                }
+            }
+        }
+    }, 1, n_threads);
+    std::vector<uint64_t>().swap(hash);
+    std::vector<Index>().swap(order);
+
+    if(tolerance > 0){
+        ///--- with a tolerance: the distinct points are sorted into a grid of
+        ///    cells of twice that size, each one looks for an earlier
+        ///    representative in the 8 cells around the nearest cell corner
+        std::vector<Index> distinct;
+        for(Index i=0; i<n; ++i)
+            if(representative[i] == i) distinct.push_back(i);
+        const Index m = distinct.size();
+
+        const Scalar inv = Scalar(1) / (2*tolerance);
+        const Scalar tolerance2 = tolerance * tolerance;
+        auto key = [](long long x, long long y, long long z){
+            return internal::weld_hash(internal::weld_hash(internal::weld_hash(uint64_t(x)) ^ uint64_t(y)) ^ uint64_t(z));
+        };
+        std::vector<long long> cells(3*m);
+        std::vector<signed char> side(3*m); ///< toward the nearest neighboring cell
+        std::vector< std::pair<uint64_t, Index> > sorted(m);
+        parallel_for_chunks(0, m, [&](Index begin, Index end){
+            for(Index k=begin; k<end; ++k){
+                for(int d=0; d<3; ++d){
+                    const Scalar x = points[distinct[k]][d] * inv;
+                    cells[3*k+d] = (long long) std::floor(x);
+                    side[3*k+d] = (x - std::floor(x) < Scalar(0.5)) ? -1 : 1;
+                }
+                sorted[k] = std::make_pair(key(cells[3*k], cells[3*k+1], cells[3*k+2]), k);
+            }
+        }, n_threads);
+        std::sort(sorted.begin(), sorted.end());
+
+        // open addressing table: cell key -> its range in sorted
+        Index size = 16;
+        while(size < 2*m) size *= 2;
+        std::vector<Index> table(size, -1);
+        for(Index s=0; s<m; ++s){
+            if(s > 0 && sorted[s].first == sorted[s-1].first) continue;
+            Index slot = Index(sorted[s].first & uint64_t(size-1));
+            while(table[slot] >= 0) slot = (slot + 1) & (size-1);
+            table[slot] = s;
+        }
+
+        std::vector<Index> merged(m); // representative among the distinct points
+        for(Index k=0; k<m; ++k){
+            const Vec3& p = points[distinct[k]];
+            Index found = k;
+            for(int c=0; c<8; ++c){
+                const uint64_t h = key(cells[3*k]   + ((c&1) ? side[3*k]   : 0),
+                                       cells[3*k+1] + ((c&2) ? side[3*k+1] : 0),
+                                       cells[3*k+2] + ((c&4) ? side[3*k+2] : 0));
+                for(Index slot = Index(h & uint64_t(size-1)); table[slot] >= 0; slot = (slot + 1) & (size-1)){
+                    if(sorted[table[slot]].first != h) continue;
+                    for(Index s=table[slot]; s<m && sorted[s].first == h; ++s){
+                        const Index j = sorted[s].second;
+                        if(j < found && merged[j] == j && (points[distinct[j]] - p).squaredNorm() <= tolerance2)
+                            found = j;
+                    }
+                    break;
+                }
+            }
+            merged[k] = found;
+        }
+        for(Index k=0; k<m; ++k)
+            representative[distinct[k]] = distinct[merged[k]];
+        parallel_for_chunks(0, n, [&](Index begin, Index end){
+            for(Index i=begin; i<end; ++i){ // only points that are not distinct change
+                const Index r = representative[representative[i]];
+                if(r != representative[i]) representative[i] = r;
+            }
+        }, n_threads);
+    }
+
+    ///--- number the representatives in order
+    for(Index i=0; i<n; ++i){
+        if(representative[i] == i){
+            index[i] = unique.size();
+            unique.push_back(points[i]);
+        }
+    }
+    parallel_for_chunks(0, n, [&](Index begin, Index end){
+        for(Index i=begin; i<end; ++i)
+            if(representative[i] != i) index[i] = index[representative[i]];
+    }, n_threads);
+    return unique.size();
+}
+
+//=============================================================================
+} // namespace OpenGP
+//=============================================================================